@@ -76,6 +76,24 @@ Wippersnapper::~Wippersnapper() {
 void Wippersnapper::provision() {
   // init. LED for status signaling
   statusLEDInit();
+  // init. outbound message queues
+  WS._outbound = new Wippersnapper_Outbound();
+  // init. chunked transfer of large messages
+  WS._chunking = new Wippersnapper_Chunking();
+  // init. batched telemetry, channels are enabled by the filesystem
+  WS._batch = new Wippersnapper_Batch();
+  // init. queue of commands received from the broker
+  WS._commands = new Wippersnapper_Commands();
+  // init. cache of the configuration applied by the broker
+  WS._configCache = new Wippersnapper_ConfigCache();
+  // init. cache of the most recent value of each channel
+  WS._lastValue = new Wippersnapper_LastValue();
+  // init. PWM outputs
+  WS._pwm = new Wippersnapper_PWM();
+  // init. pulse capture inputs
+  WS._pulseCapture = new Wippersnapper_PulseCapture();
+  // init. logic capture
+  WS._logicCapture = new Wippersnapper_LogicCapture();
 #ifdef USE_TINYUSB
   _fileSystem = new Wippersnapper_FS();
   _fileSystem->parseSecrets();
@@ -195,10 +213,64 @@ void Wippersnapper::set_user_key() {
 bool Wippersnapper::configurePinRequest(
     wippersnapper_pin_v1_ConfigurePinRequest *pinMsg) {
   WS_DEBUG_PRINTLN("configurePinRequest");
+  int pin = atoi(pinMsg->pin_name + 1);
+  if (reconcilePinRequest(pinMsg, pin))
+    return true;
+
+  bool is_success = applyPinRequest(pinMsg, pin);
+  if (is_success)
+    WS._configCache->pinConfigured(pinMsg);
+  return is_success;
+}
+
+/****************************************************************************/
+/*!
+    @brief    Compares a pin configuration request with the pin's current
+              configuration and applies it if the pin does not need to be
+              set up again.
+    @param    pinMsg
+              Pointer to a wippersnapper_pin_v1_ConfigurePinRequest message.
+    @param    pin
+              The pin's number.
+    @returns  True if the request was handled, False if the pin must be
+              set up by applyPinRequest().
+*/
+/****************************************************************************/
+bool Wippersnapper::reconcilePinRequest(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg, int pin) {
+  // Re-sent configuration, the pin is already set up as requested
+  if (WS._configCache->pinUnchanged(pinMsg)) {
+    WS_DEBUG_PRINTLN("Pin configuration unchanged");
+    return true;
+  }
+
+  // Reconcile with the pin's current configuration
+  wippersnapper_pin_v1_ConfigurePinRequest prvPinMsg =
+      wippersnapper_pin_v1_ConfigurePinRequest_init_zero;
+  if (pinMsg->request_type ==
+          wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE &&
+      WS._configCache->pinApplied(pinMsg, &prvPinMsg) &&
+      reconfigurePin(&prvPinMsg, pinMsg, pin)) {
+    WS._configCache->pinConfigured(pinMsg);
+    return true;
+  }
+  return false;
+}
 
+/****************************************************************************/
+/*!
+    @brief    Sets up or releases a pin according to a
+                wippersnapper_pin_v1_ConfigurePinRequest message.
+    @param    pinMsg
+              Pointer to a wippersnapper_pin_v1_ConfigurePinRequest message.
+    @param    pin
+              The pin's number.
+    @returns  True if pin configured successfully, False otherwise.
+*/
+/****************************************************************************/
+bool Wippersnapper::applyPinRequest(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg, int pin) {
   bool is_success = true;
-  char *pinName = pinMsg->pin_name + 1;
-  int pin = atoi(pinName);
 
   // Decode pin mode
   if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_DIGITAL) {
@@ -206,11 +278,16 @@ bool Wippersnapper::configurePinRequest(
         wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE) {
       // Initialize GPIO pin
       WS._digitalGPIO->initDigitalPin(pinMsg->direction, pin, pinMsg->period,
-                                      pinMsg->pull);
+                                      pinMsg->pull, pinMsg->debounce_us,
+                                      pinMsg->digital_read_mode,
+                                      pinMsg->encoder_pin,
+                                      pinMsg->change_threshold);
     } else if (
         pinMsg->request_type ==
         wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE) {
-      // Delete digital GPIO pin
+      // Delete digital GPIO pin, and its PWM signal or pulse capture
+      WS._pwm->releasePWMPin(pin);
+      WS._pulseCapture->releaseCapture(pin);
       WS._digitalGPIO->deinitDigitalPin(pinMsg->direction, pin);
     } else {
       WS_DEBUG_PRINTLN("ERROR: Could not decode digital pin request type");
@@ -245,10 +322,63 @@ bool Wippersnapper::configurePinRequest(
     WS_DEBUG_PRINTLN("ERROR: Could not decode pin mode")
     is_success = false;
   }
-
   return is_success;
 }
 
+/****************************************************************************/
+/*!
+    @brief  Applies a new configuration to a pin which is already
+            configured. If only the pin's period or settle time changed,
+            the pin keeps its mode, schedule and previous value. Otherwise
+            the previous configuration is released so the pin can be set
+            up again.
+    @param  prvPinMsg
+            The configuration the pin is currently set up with.
+    @param  pinMsg
+            The requested configuration.
+    @param  pin
+            The pin's number.
+    @returns  True if the requested configuration was applied, False if
+              the pin must be set up again.
+*/
+/****************************************************************************/
+bool Wippersnapper::reconfigurePin(
+    wippersnapper_pin_v1_ConfigurePinRequest *prvPinMsg,
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg, int pin) {
+  bool periodOnly =
+      prvPinMsg->mode == pinMsg->mode &&
+      prvPinMsg->direction == pinMsg->direction &&
+      prvPinMsg->pull == pinMsg->pull &&
+      prvPinMsg->analog_read_mode == pinMsg->analog_read_mode &&
+      prvPinMsg->digital_read_mode == pinMsg->digital_read_mode &&
+      prvPinMsg->encoder_pin == pinMsg->encoder_pin &&
+      prvPinMsg->change_threshold == pinMsg->change_threshold &&
+      pinMsg->direction ==
+          wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_INPUT;
+  if (periodOnly) {
+    if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_DIGITAL &&
+        WS._digitalGPIO->setDigitalInputPeriod(pin, pinMsg->period) &&
+        WS._digitalGPIO->setDigitalInputDebounce(pin, pinMsg->debounce_us)) {
+      WS_DEBUG_PRINTLN("Digital input period changed");
+      return true;
+    }
+    if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_ANALOG &&
+        WS._analogIO->setAnalogInputPeriod(pin, pinMsg->period)) {
+      WS_DEBUG_PRINTLN("Analog input period changed");
+      return true;
+    }
+  }
+
+  // Release the previous configuration, and its PWM signal or pulse capture
+  if (prvPinMsg->mode == wippersnapper_pin_v1_Mode_MODE_DIGITAL) {
+    WS._pwm->releasePWMPin(pin);
+    WS._pulseCapture->releaseCapture(pin);
+    WS._digitalGPIO->deinitDigitalPin(prvPinMsg->direction, pin);
+  } else if (prvPinMsg->mode == wippersnapper_pin_v1_Mode_MODE_ANALOG)
+    WS._analogIO->deinitAnalogPin(prvPinMsg->direction, pin);
+  return false;
+}
+
 /*****************************************************************************/
 /*!
     @brief  Decodes a repeated ConfigurePinRequests messages.
@@ -266,62 +396,312 @@ bool cbDecodePinConfigMsg(pb_istream_t *stream, const pb_field_t *field,
   bool is_success = true;
   WS_DEBUG_PRINTLN("cbDecodePinConfigMsg");
 
-  // pb_decode the stream into a pinReqMessage
-  wippersnapper_pin_v1_ConfigurePinRequest pinReqMsg =
+  // Stage the request, the list is applied once it was fully received
+  wippersnapper_pin_v1_ConfigurePinRequest pinMsg =
       wippersnapper_pin_v1_ConfigurePinRequest_init_zero;
   if (!pb_decode(stream, wippersnapper_pin_v1_ConfigurePinRequest_fields,
-                 &pinReqMsg)) {
+                 &pinMsg)) {
     WS_DEBUG_PRINTLN("ERROR: Could not decode CreateSignalRequest")
     is_success = false;
+  } else {
+    if (WS._pinConfigStaged == NULL)
+      WS._pinConfigStaged = new Wippersnapper_PinConfig();
+    WS._pinConfigStaged->stage(&pinMsg);
   }
 
-  // Pass ConfigurePinRequest message
-  if (!WS.configurePinRequest(&pinReqMsg)) {
-    WS_DEBUG_PRINTLN("Unable to configure pin");
-    is_success = false;
+  return is_success;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Queues the staged list of pin configurations to be applied.
+    @param  complete
+            False if any request of the list failed to decode, the list
+            is then discarded so it is never partially applied.
+*/
+/**************************************************************************/
+void cbPinConfigListEnd(bool complete) {
+  Wippersnapper_PinConfig *pinConfigList = WS._pinConfigStaged;
+  WS._pinConfigStaged = NULL;
+  if (!complete) {
+    WS_DEBUG_PRINTLN("ERROR: Pin configuration list incomplete, discarding");
+    delete pinConfigList;
+    return;
+  }
+  // an empty list still completes the configuration workflow
+  if (pinConfigList == NULL)
+    pinConfigList = new Wippersnapper_PinConfig();
+  wsCommand *cmd = WS._commands->reserve(WS_CMD_PIN_CONFIG_LIST);
+  if (cmd == NULL) {
+    delete pinConfigList;
+    return;
   }
+  cmd->msg.pinConfigList = pinConfigList;
+  WS._commands->commit();
+}
 
+/**************************************************************************/
+/*!
+    @brief  Queues the staged list of I2C device initialization requests,
+            executed by a single command.
+    @param  complete
+            False if any request of the list failed to decode, the list
+            is then discarded so it is never partially applied.
+*/
+/**************************************************************************/
+void cbI2CDeviceListEnd(bool complete) {
+  if (!complete) {
+    WS_DEBUG_PRINTLN("ERROR: I2C device list incomplete, discarding");
+    Wippersnapper_Commands::discard(&WS._i2cDeviceListStaged);
+    return;
+  }
+  WS._commands->commitList(&WS._i2cDeviceListStaged);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Validates and applies a list of pin configurations received
+            from the broker, then acknowledges the whole list once.
+    @param  pinConfigList
+            The staged list, deleted once applied.
+    @returns  True if the list was applied, False if it was rejected or
+              any pin failed to apply.
+*/
+/**************************************************************************/
+bool Wippersnapper::pinConfigListRequest(
+    Wippersnapper_PinConfig *pinConfigList) {
+  WS_DEBUG_PRINT("Applying pin configuration list, pins: ");
+  WS_DEBUG_PRINTLN(pinConfigList->staged());
+  bool is_valid = pinConfigList->validate();
+  bool is_success = is_valid && pinConfigList->apply();
+  delete pinConfigList;
+
+  // an applied list is the broker's configuration, even if a pin failed
+  if (is_valid)
+    WS._configCache->endSync(WS_CACHE_REC_PIN_CONFIG);
+  if (is_success) {
+    // Publish that we have completed the configuration workflow
+    WS.publishPinConfigComplete();
+  } else if (is_valid) {
+    WS_DEBUG_PRINTLN("ERROR: Pin configuration list applied, some pins failed");
+  } else {
+    WS_DEBUG_PRINTLN("ERROR: Pin configuration list rejected, no pin changed");
+  }
+  if (!WS.pinCfgCompleted) {
+    WS_DEBUG_PRINTLN("Initial Pin Configuration Complete!");
+    WS.pinCfgCompleted = true;
+  }
   return is_success;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Decodes repeated PinEvents messages.
+    @brief  Converts a PinEvent message into a level to write to a digital
+            output.
+    @param  pinEventMsg
+            The decoded PinEvent message.
+    @param  pinWrite
+            The output and level to write.
+    @returns  True if the event writes a digital output, False otherwise.
+*/
+/**************************************************************************/
+bool decodePinWrite(wippersnapper_pin_v1_PinEvent *pinEventMsg,
+                    digitalPinWrite *pinWrite) {
+  // numeric pin event, identified by its channel, any nonzero value is high
+  if (pinEventMsg->which_numeric_value ==
+          wippersnapper_pin_v1_PinEvent_pin_value_int_tag ||
+      pinEventMsg->which_numeric_value ==
+          wippersnapper_pin_v1_PinEvent_pin_value_float_tag) {
+    if (pinEventMsg->pin_id >= WS_CHANNEL_ANALOG(0)) {
+      WS_DEBUG_PRINTLN("ERROR: Numeric PinEvent unimplemented for channel!");
+      return false;
+    }
+    // pin names are a byte wide, a larger pin must not wrap onto another
+    if (pinEventMsg->pin_id > 0xFF) {
+      WS_DEBUG_PRINTLN("ERROR: PinEvent for a pin which does not exist");
+      return false;
+    }
+    pinWrite->pinName = pinEventMsg->pin_id;
+    if (pinEventMsg->which_numeric_value ==
+        wippersnapper_pin_v1_PinEvent_pin_value_int_tag)
+      pinWrite->value = pinEventMsg->numeric_value.pin_value_int != 0;
+    else
+      pinWrite->value = pinEventMsg->numeric_value.pin_value_float != 0.0f;
+  } else if (pinEventMsg->pin_name[0] == 'D') { // digital pin event
+    pinWrite->pinName = atoi(pinEventMsg->pin_name + 1);
+    pinWrite->value = atoi(pinEventMsg->pin_value) != 0;
+  } else if (pinEventMsg->pin_name[0] == 'A') { // analog pin event
+    WS_DEBUG_PRINTLN("ERROR: Analog PinEvent unimplemented!");
+    return false;
+  } else {
+    WS_DEBUG_PRINTLN("ERROR: Unable to decode pin event name.");
+    return false;
+  }
+
+  if (!Wippersnapper_DigitalGPIO::isValidDigitalPin(pinWrite->pinName, true)) {
+    WS_DEBUG_PRINTLN("ERROR: PinEvent for a pin which is not an output");
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes repeated PinEvents messages, collecting the levels to
+            write within a single queued command.
     @param  stream
             Input stream to read from.
     @param  field
             Message descriptor, usually autogenerated.
     @param  arg
-            Stores any information the decoding callback may need.
+            The reserved WS_CMD_PIN_EVENTS command.
     @returns True if successfully decoded, False otherwise.
 */
 /**************************************************************************/
 bool cbDecodePinEventMsg(pb_istream_t *stream, const pb_field_t *field,
                          void **arg) {
-  bool is_success = true;
   WS_DEBUG_PRINTLN("cbDecodePinEventMsg");
+  digitalPinWrites *pinWrites = &((wsCommand *)*arg)->msg.pinWrites;
 
-  // Decode stream into a PinEvent
   wippersnapper_pin_v1_PinEvent pinEventMsg =
       wippersnapper_pin_v1_PinEvent_init_zero;
-  if (!pb_decode(stream, wippersnapper_pin_v1_PinEvent_fields, &pinEventMsg)) {
+  if (!pb_decode(stream, wippersnapper_pin_v1_PinEvent_fields,
+                 &pinEventMsg)) {
     WS_DEBUG_PRINTLN("ERROR: Could not decode PinEvents")
-    is_success = false;
+    return false;
   }
-
-  char *pinName = pinEventMsg.pin_name + 1;
-  if (pinEventMsg.pin_name[0] == 'D') { // digital pin event
-    WS._digitalGPIO->digitalWriteSvc(atoi(pinName),
-                                     atoi(pinEventMsg.pin_value));
-  } else if (pinEventMsg.pin_name[0] == 'A') { // analog pin event
-    // TODO
-    WS_DEBUG_PRINTLN("ERROR: Analog PinEvent unimplemented!");
-  } else {
-    WS_DEBUG_PRINTLN("ERROR: Unable to decode pin event name.");
-    is_success = false;
+  if (pinWrites->count == WS_DIGITAL_WRITE_LIST_MAX) {
+    WS_DEBUG_PRINTLN("ERROR: Too many PinEvents within a single list");
+    return false;
   }
+  if (!decodePinWrite(&pinEventMsg, &pinWrites->writes[pinWrites->count]))
+    return false;
+  pinWrites->count++;
+  return true;
+}
 
+/**************************************************************************/
+/*!
+    @brief  Writes a list of PinEvent messages received from the broker
+            to the digital outputs at once, then acknowledges the whole
+            list with a single message carrying the outputs' new levels.
+    @param  pinWrites
+            The outputs and levels to write.
+    @returns True if every pin event was executed, False otherwise.
+*/
+/**************************************************************************/
+bool Wippersnapper::pinEventsRequest(digitalPinWrites *pinWrites) {
+  // the outputs which were written are acknowledged either way
+  bool is_success = WS._digitalGPIO->digitalWritePins(pinWrites);
+#if WS_DIGITAL_WRITE_ACK
+  uint16_t channels[WS_DIGITAL_WRITE_LIST_MAX];
+  for (uint8_t i = 0; i < pinWrites->count; i++)
+    channels[i] = WS_CHANNEL_DIGITAL(pinWrites->writes[i].pinName);
+  return WS._lastValue->publishChannels(channels, pinWrites->count) &&
+         is_success;
+#else
   return is_success;
+#endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes repeated ConfigurePWMPinRequest messages.
+    @param  stream
+            Input stream to read from.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            Stores any information the decoding callback may need.
+    @returns True if successfully decoded, False otherwise.
+*/
+/**************************************************************************/
+bool cbDecodePWMConfigMsg(pb_istream_t *stream, const pb_field_t *field,
+                          void **arg) {
+  WS_DEBUG_PRINTLN("cbDecodePWMConfigMsg");
+  // Stage the request, the whole list is executed by a single command
+  return Wippersnapper_Commands::stage((wsCommandList *)*arg,
+                                       WS_CMD_PWM_CONFIG, stream);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes repeated PWMPinEvent messages.
+    @param  stream
+            Input stream to read from.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            Stores any information the decoding callback may need.
+    @returns True if successfully decoded, False otherwise.
+*/
+/**************************************************************************/
+bool cbDecodePWMEventMsg(pb_istream_t *stream, const pb_field_t *field,
+                         void **arg) {
+  WS_DEBUG_PRINTLN("cbDecodePWMEventMsg");
+  // Stage the request, the whole list is executed by a single command
+  return Wippersnapper_Commands::stage((wsCommandList *)*arg, WS_CMD_PWM_EVENT,
+                                       stream);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Configures a PWM output requested by the broker.
+    @param  pwmMsg
+            The decoded ConfigurePWMPinRequest message.
+    @returns True if the PWM output was configured, False otherwise.
+*/
+/**************************************************************************/
+bool Wippersnapper::pwmConfigRequest(
+    wippersnapper_pin_v1_ConfigurePWMPinRequest *pwmMsg) {
+  return WS._pwm->configurePWMPin(pwmMsg);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Changes the duty cycle of a PWM output.
+    @param  pwmMsg
+            The decoded PWMPinEvent message.
+    @returns True if the duty cycle was changed, False otherwise.
+*/
+/**************************************************************************/
+bool Wippersnapper::pwmEventRequest(wippersnapper_pin_v1_PWMPinEvent *pwmMsg) {
+  return WS._pwm->writeDutyCycle(atoi(pwmMsg->pin_name + 1),
+                                 pwmMsg->duty_cycle);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes repeated ConfigurePulseCaptureRequest messages.
+    @param  stream
+            Input stream to read from.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            Stores any information the decoding callback may need.
+    @returns True if successfully decoded, False otherwise.
+*/
+/**************************************************************************/
+bool cbDecodePulseCaptureConfigMsg(pb_istream_t *stream,
+                                   const pb_field_t *field, void **arg) {
+  WS_DEBUG_PRINTLN("cbDecodePulseCaptureConfigMsg");
+  // Stage the request, the whole list is executed by a single command
+  return Wippersnapper_Commands::stage((wsCommandList *)*arg,
+                                       WS_CMD_PULSE_CAPTURE_CONFIG, stream);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Configures a pulse capture input requested by the broker.
+    @param  captureMsg
+            The decoded ConfigurePulseCaptureRequest message.
+    @returns True if the pulse capture input was configured, False
+             otherwise.
+*/
+/**************************************************************************/
+bool Wippersnapper::pulseCaptureConfigRequest(
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest *captureMsg) {
+  return WS._pulseCapture->configureCapture(captureMsg);
 }
 
 /**************************************************************************/
@@ -359,26 +739,107 @@ bool cbSignalMsg(pb_istream_t *stream, const pb_field_t *field, void **arg) {
                    &msg)) {
       WS_DEBUG_PRINTLN("ERROR: Could not decode CreateSignalRequest")
       is_success = false;
-      WS.pinCfgCompleted = false;
-    }
-    // If this is the initial configuration
-    if (!WS.pinCfgCompleted) {
-      WS_DEBUG_PRINTLN("Initial Pin Configuration Complete!");
-      WS.pinCfgCompleted = true;
     }
+    cbPinConfigListEnd(is_success);
   } else if (field->tag ==
              wippersnapper_signal_v1_CreateSignalRequest_pin_events_tag) {
     WS_DEBUG_PRINTLN("Signal Msg Tag: Pin Event");
-    // array to store the decoded PinEvents data
+    // the whole list is written at once, by a single command
+    wsCommand *cmd = WS._commands->reserve(WS_CMD_PIN_EVENTS);
+    if (cmd == NULL)
+      return false;
     wippersnapper_pin_v1_PinEvents msg =
         wippersnapper_pin_v1_PinEvents_init_zero;
     // set up callback
     msg.list.funcs.decode = cbDecodePinEventMsg;
-    msg.list.arg = field->pData;
-    // decode each PinEvents sub-message
+    msg.list.arg = cmd;
+    // decode each PinEvents sub-message, a list with an invalid event is
+    // discarded so it is never partially written
     if (!pb_decode(stream, wippersnapper_pin_v1_PinEvents_fields, &msg)) {
       WS_DEBUG_PRINTLN("ERROR: Could not decode CreateSign2alRequest")
       is_success = false;
+    } else if (cmd->msg.pinWrites.count > 0) {
+      WS._commands->commit();
+    }
+  } else if (field->tag ==
+             wippersnapper_signal_v1_CreateSignalRequest_pwm_pin_config_tag) {
+    WS_DEBUG_PRINTLN("Signal Msg Tag: PWM Pin Configuration");
+    wippersnapper_pin_v1_ConfigurePWMPinRequests msg =
+        wippersnapper_pin_v1_ConfigurePWMPinRequests_init_zero;
+    wsCommandList list = {WS_CMD_PWM_CONFIG, NULL, 0, 0};
+    // set up callback
+    msg.list.funcs.decode = cbDecodePWMConfigMsg;
+    msg.list.arg = &list;
+    // decode each ConfigurePWMPinRequest sub-message
+    if (!pb_decode(stream, wippersnapper_pin_v1_ConfigurePWMPinRequests_fields,
+                   &msg)) {
+      WS_DEBUG_PRINTLN("ERROR: Could not decode ConfigurePWMPinRequests")
+      Wippersnapper_Commands::discard(&list);
+      is_success = false;
+    } else {
+      is_success = WS._commands->commitList(&list);
+    }
+  } else if (field->tag ==
+             wippersnapper_signal_v1_CreateSignalRequest_pwm_pin_event_tag) {
+    WS_DEBUG_PRINTLN("Signal Msg Tag: PWM Pin Event");
+    wippersnapper_pin_v1_PWMPinEvents msg =
+        wippersnapper_pin_v1_PWMPinEvents_init_zero;
+    wsCommandList list = {WS_CMD_PWM_EVENT, NULL, 0, 0};
+    // set up callback
+    msg.list.funcs.decode = cbDecodePWMEventMsg;
+    msg.list.arg = &list;
+    // decode each PWMPinEvent sub-message
+    if (!pb_decode(stream, wippersnapper_pin_v1_PWMPinEvents_fields, &msg)) {
+      WS_DEBUG_PRINTLN("ERROR: Could not decode PWMPinEvents")
+      Wippersnapper_Commands::discard(&list);
+      is_success = false;
+    } else {
+      is_success = WS._commands->commitList(&list);
+    }
+  } else if (field->tag ==
+             wippersnapper_signal_v1_CreateSignalRequest_pulse_capture_config_tag) {
+    WS_DEBUG_PRINTLN("Signal Msg Tag: Pulse Capture Configuration");
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequests msg =
+        wippersnapper_pin_v1_ConfigurePulseCaptureRequests_init_zero;
+    wsCommandList list = {WS_CMD_PULSE_CAPTURE_CONFIG, NULL, 0, 0};
+    // set up callback
+    msg.list.funcs.decode = cbDecodePulseCaptureConfigMsg;
+    msg.list.arg = &list;
+    // decode each ConfigurePulseCaptureRequest sub-message
+    if (!pb_decode(stream,
+                   wippersnapper_pin_v1_ConfigurePulseCaptureRequests_fields,
+                   &msg)) {
+      WS_DEBUG_PRINTLN("ERROR: Could not decode ConfigurePulseCaptureRequests")
+      Wippersnapper_Commands::discard(&list);
+      is_success = false;
+    } else {
+      is_success = WS._commands->commitList(&list);
+    }
+  } else if (field->tag ==
+             wippersnapper_signal_v1_CreateSignalRequest_read_values_tag) {
+    WS_DEBUG_PRINTLN("Signal Msg Tag: Read Values");
+    // Decode stream straight into a queued command
+    wsCommand *cmd = WS._commands->reserve(WS_CMD_READ_VALUES);
+    if (cmd == NULL ||
+        !pb_decode(stream, wippersnapper_signal_v1_ReadValuesRequest_fields,
+                   &cmd->msg.readValues)) {
+      WS_DEBUG_PRINTLN("ERROR: Could not decode ReadValuesRequest")
+      is_success = false;
+    } else {
+      WS._commands->commit();
+    }
+  } else if (field->tag ==
+             wippersnapper_signal_v1_CreateSignalRequest_logic_capture_request_tag) {
+    WS_DEBUG_PRINTLN("Signal Msg Tag: Logic Capture");
+    // Decode stream straight into a queued command
+    wsCommand *cmd = WS._commands->reserve(WS_CMD_LOGIC_CAPTURE);
+    if (cmd == NULL ||
+        !pb_decode(stream, wippersnapper_pin_v1_LogicCaptureRequest_fields,
+                   &cmd->msg.logicCapture)) {
+      WS_DEBUG_PRINTLN("ERROR: Could not decode LogicCaptureRequest")
+      is_success = false;
+    } else {
+      WS._commands->commit();
     }
   } else {
     WS_DEBUG_PRINTLN("ERROR: Unexpected signal msg tag.");
@@ -391,15 +852,20 @@ bool cbSignalMsg(pb_istream_t *stream, const pb_field_t *field, void **arg) {
 
 /**************************************************************************/
 /*!
-    @brief    Decodes a signal buffer protobuf message.
-        NOTE: Should be executed in-order after a new _buffer is recieved.
+    @brief    Decodes a signal buffer protobuf message, queueing each
+              request it carries as a command.
     @param    encodedSignalMsg
               Encoded signal message.
+    @param    buffer
+              Buffer holding the encoded signal message.
+    @param    bufferLen
+              Length of the encoded signal message, in bytes.
     @return   true if successfully decoded signal message, false otherwise.
 */
 /**************************************************************************/
 bool Wippersnapper::decodeSignalMsg(
-    wippersnapper_signal_v1_CreateSignalRequest *encodedSignalMsg) {
+    wippersnapper_signal_v1_CreateSignalRequest *encodedSignalMsg,
+    uint8_t *buffer, size_t bufferLen) {
   bool is_success = true;
   WS_DEBUG_PRINTLN("decodeSignalMsg");
 
@@ -408,7 +874,7 @@ bool Wippersnapper::decodeSignalMsg(
   encodedSignalMsg->cb_payload.funcs.decode = cbSignalMsg;
 
   // decode the CreateSignalRequest, calls cbSignalMessage and assoc. callbacks
-  pb_istream_t stream = pb_istream_from_buffer(WS._buffer, WS.bufSize);
+  pb_istream_t stream = pb_istream_from_buffer(buffer, bufferLen);
   if (!pb_decode(&stream, wippersnapper_signal_v1_CreateSignalRequest_fields,
                  encodedSignalMsg)) {
     WS_DEBUG_PRINTLN(
@@ -420,8 +886,8 @@ bool Wippersnapper::decodeSignalMsg(
 
 /**************************************************************************/
 /*!
-    @brief    Called when signal topic receives a new message. Fills
-                shared buffer with data from payload.
+    @brief    Called when signal topic receives a new message. Decodes the
+                payload into commands which run later from run().
     @param    data
                 Data from MQTT broker.
     @param    len
@@ -429,20 +895,30 @@ bool Wippersnapper::decodeSignalMsg(
 */
 /**************************************************************************/
 void cbSignalTopic(char *data, uint16_t len) {
+  WS._commands->received();
   WS_DEBUG_PRINTLN("cbSignalTopic: New Msg on Signal Topic");
   WS_DEBUG_PRINT(len);
   WS_DEBUG_PRINTLN(" bytes.");
-  // zero-out current buffer
-  memset(WS._buffer, 0, sizeof(WS._buffer));
-  // copy data to buffer
-  memcpy(WS._buffer, data, len);
-  WS.bufSize = len;
 
   // Empty struct for storing the signal message
   WS._incomingSignalMsg = wippersnapper_signal_v1_CreateSignalRequest_init_zero;
 
-  // Attempt to decode a signal message
-  if (!WS.decodeSignalMsg(&WS._incomingSignalMsg)) {
+  // Messages larger than the shared buffer arrive in chunks, decode once
+  // the final chunk is reassembled
+  if (WS._chunking->isChunk((uint8_t *)data, len)) {
+    if (!WS._chunking->receive(WS_CHUNK_RX_SIGNAL, (uint8_t *)data, len))
+      return;
+    if (!WS.decodeSignalMsg(&WS._incomingSignalMsg,
+                            WS._chunking->message(WS_CHUNK_RX_SIGNAL),
+                            WS._chunking->messageLen(WS_CHUNK_RX_SIGNAL)))
+      WS_DEBUG_PRINTLN("ERROR: Failed to decode chunked signal message");
+    WS._chunking->release(WS_CHUNK_RX_SIGNAL);
+    return;
+  }
+
+  // Decode straight from the subscription's buffer, commands are copied
+  // into the command queue as they are decoded
+  if (!WS.decodeSignalMsg(&WS._incomingSignalMsg, (uint8_t *)data, len)) {
     WS_DEBUG_PRINTLN("ERROR: Failed to decode signal message");
   }
 }
@@ -455,11 +931,25 @@ void cbSignalTopic(char *data, uint16_t len) {
 */
 /******************************************************************************************/
 void publishI2CResponse(wippersnapper_signal_v1_I2CResponse *msgi2cResponse) {
+  // The broker did not request configuration applied from the cache
+  if (WS._configCache->replaying())
+    return;
   size_t msgSz;
   pb_get_encoded_size(&msgSz, wippersnapper_signal_v1_I2CResponse_fields,
                       msgi2cResponse);
+  // Messages larger than the outgoing buffer are published in chunks
+  if (msgSz > sizeof(WS._buffer_outgoing)) {
+    WS_DEBUG_PRINT("Publishing Message: I2CResponse (chunked)...");
+    WS._outbound->flush(); // keep chunks in order with queued messages
+    WS._chunking->publish(
+        WS._topic_signal_i2c_device, wippersnapper_signal_v1_I2CResponse_fields,
+        msgi2cResponse, WS._outbound->getQoS(WS_MSG_CLASS_CONTROL));
+    WS_DEBUG_PRINTLN("Published!");
+    return;
+  }
   WS_DEBUG_PRINT("Publishing Message: I2CResponse...");
-  WS._mqtt->publish(WS._topic_signal_i2c_device, WS._buffer_outgoing, msgSz, 1);
+  WS.queuePublish(WS._topic_signal_i2c_device, WS._buffer_outgoing, msgSz,
+                  WS_MSG_CLASS_CONTROL);
   WS_DEBUG_PRINTLN("Published!");
 }
 
@@ -472,6 +962,19 @@ void publishI2CResponse(wippersnapper_signal_v1_I2CResponse *msgi2cResponse) {
 */
 /******************************************************************************************/
 bool encodeI2CResponse(wippersnapper_signal_v1_I2CResponse *msgi2cResponse) {
+#if WS_COMMAND_ECHO_LATENCY
+  // time from the request's arrival until now, 0 for unrequested events
+  msgi2cResponse->latency_us = WS._commands->latency();
+#endif
+
+  // Messages larger than the outgoing buffer are encoded while publishing
+  // them in chunks, see publishI2CResponse()
+  size_t msgSz;
+  pb_get_encoded_size(&msgSz, wippersnapper_signal_v1_I2CResponse_fields,
+                      msgi2cResponse);
+  if (msgSz > sizeof(WS._buffer_outgoing))
+    return true;
+
   memset(WS._buffer_outgoing, 0, sizeof(WS._buffer_outgoing));
   pb_ostream_t ostream =
       pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
@@ -521,58 +1024,17 @@ bool initializeI2CBus(wippersnapper_i2c_v1_I2CBusInitRequest msgInitRequest,
 bool cbDecodeI2CDeviceInitRequestList(pb_istream_t *stream,
                                       const pb_field_t *field, void **arg) {
   WS_DEBUG_PRINTLN("EXEC: cbDecodeI2CDeviceInitRequestList");
-  // Decode stream into individual msgI2CDeviceInitRequest messages
-  wippersnapper_i2c_v1_I2CDeviceInitRequest msgI2CDeviceInitRequest =
-      wippersnapper_i2c_v1_I2CDeviceInitRequest_init_zero;
-  if (!pb_decode(stream, wippersnapper_i2c_v1_I2CDeviceInitRequest_fields,
-                 &msgI2CDeviceInitRequest)) {
-    WS_DEBUG_PRINTLN("ERROR: Could not decode I2CDeviceInitRequest message.");
-    return false;
-  }
-
-  // Create response
-  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
-      wippersnapper_signal_v1_I2CResponse_init_zero;
-  msgi2cResponse.which_payload =
-      wippersnapper_signal_v1_I2CResponse_resp_i2c_device_init_tag;
-
-  // Check I2C bus
-  if (!initializeI2CBus(msgI2CDeviceInitRequest.i2c_bus_init_req, 0)) {
-    WS_DEBUG_PRINTLN("ERROR: Failed to initialize I2C Bus");
-    msgi2cResponse.payload.resp_i2c_device_init.bus_response =
-        WS._i2cPort0->getBusStatus();
-    if (!encodeI2CResponse(&msgi2cResponse)) {
-      WS_DEBUG_PRINTLN("ERROR: encoding I2C Response!");
-      return false;
-    }
-    publishI2CResponse(&msgi2cResponse);
-    return true;
-  }
-
-  WS._i2cPort0->initI2CDevice(&msgI2CDeviceInitRequest);
-
-  // Fill device's address and the initialization status
-  // TODO: The filling should be done within the method though?
-  msgi2cResponse.payload.resp_i2c_device_init.i2c_device_address =
-      msgI2CDeviceInitRequest.i2c_device_address;
-  msgi2cResponse.payload.resp_i2c_device_init.bus_response =
-      WS._i2cPort0->getBusStatus();
-
-  // Encode response
-  if (!encodeI2CResponse(&msgi2cResponse)) {
-    return false;
-  }
-
-  // Publish a response for the I2C device
-  publishI2CResponse(&msgi2cResponse);
-  return true;
+  // Stage the request, the whole list is executed by a single command and
+  // each device is initialized and acknowledged individually
+  return Wippersnapper_Commands::stage(&WS._i2cDeviceListStaged,
+                                       WS_CMD_I2C_DEVICE_INIT, stream);
 }
 
 /******************************************************************************************/
 /*!
-    @brief    Decodes an I2C signal request message and executes the
-              callback based on the message's tag. If successful,
-              publishes an I2C signal response back to the broker.
+    @brief    Decodes an I2C signal request message based on the message's
+              tag and queues it as a command. The command executes, and
+              publishes its I2C signal response, from run().
     @param    stream
               Incoming data stream from buffer.
     @param    field
@@ -586,56 +1048,19 @@ bool cbDecodeSignalRequestI2C(pb_istream_t *stream, const pb_field_t *field,
                               void **arg) {
   bool is_success = true;
   WS_DEBUG_PRINTLN("cbDecodeSignalRequestI2C");
-  // Create I2C Response
-  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
-      wippersnapper_signal_v1_I2CResponse_init_zero;
+  wsCommand *cmd;
 
   if (field->tag == wippersnapper_signal_v1_I2CRequest_req_i2c_scan_tag) {
     WS_DEBUG_PRINTLN("I2C Scan Request");
-
-    // Decode I2CBusScanRequest
-    wippersnapper_i2c_v1_I2CBusScanRequest msgScanReq =
-        wippersnapper_i2c_v1_I2CBusScanRequest_init_zero;
+    cmd = WS._commands->reserve(WS_CMD_I2C_SCAN);
+    if (cmd == NULL)
+      return false;
     if (!pb_decode(stream, wippersnapper_i2c_v1_I2CBusScanRequest_fields,
-                   &msgScanReq)) {
+                   &cmd->msg.i2cScan)) {
       WS_DEBUG_PRINTLN(
           "ERROR: Could not decode wippersnapper_i2c_v1_I2CBusScanRequest");
       return false; // fail out if we can't decode the request
     }
-
-    // Empty response message
-    wippersnapper_i2c_v1_I2CBusScanResponse scanResp =
-        wippersnapper_i2c_v1_I2CBusScanResponse_init_zero;
-
-    // Check I2C bus
-    if (!initializeI2CBus(msgScanReq.bus_init_request, 0)) {
-      WS_DEBUG_PRINTLN("ERROR: Failed to initialize I2C Bus");
-      msgi2cResponse.payload.resp_i2c_scan.bus_response =
-          WS._i2cPort0->getBusStatus();
-      if (!encodeI2CResponse(&msgi2cResponse)) {
-        WS_DEBUG_PRINTLN("ERROR: encoding I2C Response!");
-        return false;
-      }
-      publishI2CResponse(&msgi2cResponse);
-      return true;
-    }
-
-    // Scan I2C bus
-    scanResp = WS._i2cPort0->scanAddresses();
-
-    // Fill I2CResponse
-    msgi2cResponse.which_payload =
-        wippersnapper_signal_v1_I2CResponse_resp_i2c_scan_tag;
-    memcpy(msgi2cResponse.payload.resp_i2c_scan.addresses_found,
-           scanResp.addresses_found, sizeof(scanResp.addresses_found));
-    msgi2cResponse.payload.resp_i2c_scan.addresses_found_count =
-        scanResp.addresses_found_count;
-
-    msgi2cResponse.payload.resp_i2c_scan.bus_response = scanResp.bus_response;
-    // Encode I2CResponse
-    if (!encodeI2CResponse(&msgi2cResponse)) {
-      return false;
-    }
   } else if (
       field->tag ==
       wippersnapper_signal_v1_I2CRequest_req_i2c_device_init_requests_tag) {
@@ -654,132 +1079,230 @@ bool cbDecodeSignalRequestI2C(pb_istream_t *stream, const pb_field_t *field,
       WS_DEBUG_PRINTLN("ERROR: Could not decode I2CDeviceInitRequests");
       is_success = false;
     }
-    // return so we don't publish an empty message, we already published within
-    // cbDecodeI2CDeviceInitRequestList() for each device
+    // each device was staged by cbDecodeI2CDeviceInitRequestList()
+    cbI2CDeviceListEnd(is_success);
     return is_success;
   } else if (field->tag ==
              wippersnapper_signal_v1_I2CRequest_req_i2c_device_init_tag) {
     WS_DEBUG_PRINTLN("I2C Device Init Request Found!");
-
-    // Decode stream into an I2CDeviceInitRequest
-    wippersnapper_i2c_v1_I2CDeviceInitRequest msgI2CDeviceInitRequest =
-        wippersnapper_i2c_v1_I2CDeviceInitRequest_init_zero;
-    // Decode stream into struct, msgI2CDeviceInitRequest
+    cmd = WS._commands->reserve(WS_CMD_I2C_DEVICE_INIT);
+    if (cmd == NULL)
+      return false;
     if (!pb_decode(stream, wippersnapper_i2c_v1_I2CDeviceInitRequest_fields,
-                   &msgI2CDeviceInitRequest)) {
+                   &cmd->msg.i2cDeviceInit)) {
       WS_DEBUG_PRINTLN("ERROR: Could not decode I2CDeviceInitRequest message.");
       return false; // fail out if we can't decode
     }
-
-    // Create empty response
-    msgi2cResponse = wippersnapper_signal_v1_I2CResponse_init_zero;
-    msgi2cResponse.which_payload =
-        wippersnapper_signal_v1_I2CResponse_resp_i2c_device_init_tag;
-
-    // Check I2C bus
-    if (!initializeI2CBus(msgI2CDeviceInitRequest.i2c_bus_init_req, 0)) {
-      WS_DEBUG_PRINTLN("ERROR: Failed to initialize I2C Bus");
-      msgi2cResponse.payload.resp_i2c_device_init.bus_response =
-          WS._i2cPort0->getBusStatus();
-      if (!encodeI2CResponse(&msgi2cResponse)) {
-        WS_DEBUG_PRINTLN("ERROR: encoding I2C Response!");
-        return false;
-      }
-      publishI2CResponse(&msgi2cResponse);
-      return true;
-    }
-
-    // Initialize I2C device
-    WS._i2cPort0->initI2CDevice(&msgI2CDeviceInitRequest);
-
-    // Fill device's address and bus status
-    msgi2cResponse.payload.resp_i2c_device_init.i2c_device_address =
-        msgI2CDeviceInitRequest.i2c_device_address;
-    msgi2cResponse.payload.resp_i2c_device_init.bus_response =
-        WS._i2cPort0->getBusStatus();
-
-    // Encode response
-    if (!encodeI2CResponse(&msgi2cResponse)) {
-      return false;
-    }
   } else if (field->tag ==
              wippersnapper_signal_v1_I2CRequest_req_i2c_device_update_tag) {
     WS_DEBUG_PRINTLN("=> INCOMING REQUEST: I2CDeviceUpdateRequest");
-
-    // New I2CDeviceUpdateRequest message
-    wippersnapper_i2c_v1_I2CDeviceUpdateRequest msgI2CDeviceUpdateRequest =
-        wippersnapper_i2c_v1_I2CDeviceUpdateRequest_init_zero;
-
-    // Decode stream into message
+    cmd = WS._commands->reserve(WS_CMD_I2C_DEVICE_UPDATE);
+    if (cmd == NULL)
+      return false;
     if (!pb_decode(stream, wippersnapper_i2c_v1_I2CDeviceUpdateRequest_fields,
-                   &msgI2CDeviceUpdateRequest)) {
+                   &cmd->msg.i2cDeviceUpdate)) {
       WS_DEBUG_PRINTLN(
           "ERROR: Could not decode I2CDeviceUpdateRequest message.");
       return false; // fail out if we can't decode
     }
-
-    // Empty I2C response to fill out
-    msgi2cResponse = wippersnapper_signal_v1_I2CResponse_init_zero;
-    msgi2cResponse.which_payload =
-        wippersnapper_signal_v1_I2CResponse_resp_i2c_device_update_tag;
-
-    // Update I2C device's properties
-    WS._i2cPort0->updateI2CDeviceProperties(&msgI2CDeviceUpdateRequest);
-
-    // Fill address
-    msgi2cResponse.payload.resp_i2c_device_update.i2c_device_address =
-        msgI2CDeviceUpdateRequest.i2c_device_address;
-    msgi2cResponse.payload.resp_i2c_device_update.bus_response =
-        WS._i2cPort0->getBusStatus();
-
-    // Encode response
-    if (!encodeI2CResponse(&msgi2cResponse)) {
-      return false;
-    }
   } else if (field->tag ==
              wippersnapper_signal_v1_I2CRequest_req_i2c_device_deinit_tag) {
     WS_DEBUG_PRINTLN("NEW COMMAND: I2C Device Deinit");
-    // Decode stream into an I2CDeviceDeinitRequest
-    wippersnapper_i2c_v1_I2CDeviceDeinitRequest msgI2CDeviceDeinitRequest =
-        wippersnapper_i2c_v1_I2CDeviceDeinitRequest_init_zero;
-    // Decode stream into struct, msgI2CDeviceDeinitRequest
+    cmd = WS._commands->reserve(WS_CMD_I2C_DEVICE_DEINIT);
+    if (cmd == NULL)
+      return false;
     if (!pb_decode(stream, wippersnapper_i2c_v1_I2CDeviceDeinitRequest_fields,
-                   &msgI2CDeviceDeinitRequest)) {
+                   &cmd->msg.i2cDeviceDeinit)) {
       WS_DEBUG_PRINTLN(
           "ERROR: Could not decode I2CDeviceDeinitRequest message.");
       return false; // fail out if we can't decode
     }
+  } else {
+    WS_DEBUG_PRINTLN("ERROR: Undefined I2C message tag");
+    return false; // fail out, we didn't decode anything to execute
+  }
+  WS._commands->commit();
+  return is_success;
+}
+
+/******************************************************************************************/
+/*!
+    @brief    Scans an I2C bus and publishes the addresses found.
+    @param    msgScanReq
+              The decoded I2CBusScanRequest message.
+    @returns  True if the response was published, False otherwise.
+*/
+/******************************************************************************************/
+bool Wippersnapper::i2cScanRequest(
+    wippersnapper_i2c_v1_I2CBusScanRequest *msgScanReq) {
+  // Create I2C Response
+  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
+      wippersnapper_signal_v1_I2CResponse_init_zero;
+
+  // Empty response message
+  wippersnapper_i2c_v1_I2CBusScanResponse scanResp =
+      wippersnapper_i2c_v1_I2CBusScanResponse_init_zero;
 
-    // Empty I2C response to fill out
-    msgi2cResponse = wippersnapper_signal_v1_I2CResponse_init_zero;
-    msgi2cResponse.which_payload =
-        wippersnapper_signal_v1_I2CResponse_resp_i2c_device_deinit_tag;
-
-    // Deinitialize I2C device
-    WS._i2cPort0->deinitI2CDevice(&msgI2CDeviceDeinitRequest);
-    // Fill deinit response
-    msgi2cResponse.payload.resp_i2c_device_deinit.i2c_device_address =
-        msgI2CDeviceDeinitRequest.i2c_device_address;
-    msgi2cResponse.payload.resp_i2c_device_deinit.bus_response =
+  // Check I2C bus
+  if (!initializeI2CBus(msgScanReq->bus_init_request, 0)) {
+    WS_DEBUG_PRINTLN("ERROR: Failed to initialize I2C Bus");
+    msgi2cResponse.payload.resp_i2c_scan.bus_response =
         WS._i2cPort0->getBusStatus();
+    if (!encodeI2CResponse(&msgi2cResponse)) {
+      WS_DEBUG_PRINTLN("ERROR: encoding I2C Response!");
+      return false;
+    }
+    publishI2CResponse(&msgi2cResponse);
+    return true;
+  }
+
+  // Scan I2C bus
+  scanResp = WS._i2cPort0->scanAddresses();
 
-    // Encode response
+  // Fill I2CResponse
+  msgi2cResponse.which_payload =
+      wippersnapper_signal_v1_I2CResponse_resp_i2c_scan_tag;
+  memcpy(msgi2cResponse.payload.resp_i2c_scan.addresses_found,
+         scanResp.addresses_found, sizeof(scanResp.addresses_found));
+  msgi2cResponse.payload.resp_i2c_scan.addresses_found_count =
+      scanResp.addresses_found_count;
+
+  msgi2cResponse.payload.resp_i2c_scan.bus_response = scanResp.bus_response;
+  // Encode I2CResponse
+  if (!encodeI2CResponse(&msgi2cResponse)) {
+    return false;
+  }
+  // Publish the I2CResponse
+  publishI2CResponse(&msgi2cResponse);
+  return true;
+}
+
+/******************************************************************************************/
+/*!
+    @brief    Initializes an I2C device and publishes its status.
+    @param    msgDeviceInitReq
+              The decoded I2CDeviceInitRequest message.
+    @returns  True if the response was published, False otherwise.
+*/
+/******************************************************************************************/
+bool Wippersnapper::i2cDeviceInitRequest(
+    wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq) {
+  // Create response
+  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
+      wippersnapper_signal_v1_I2CResponse_init_zero;
+  msgi2cResponse.which_payload =
+      wippersnapper_signal_v1_I2CResponse_resp_i2c_device_init_tag;
+
+  // Check I2C bus
+  if (!initializeI2CBus(msgDeviceInitReq->i2c_bus_init_req, 0)) {
+    WS_DEBUG_PRINTLN("ERROR: Failed to initialize I2C Bus");
+    msgi2cResponse.payload.resp_i2c_device_init.bus_response =
+        WS._i2cPort0->getBusStatus();
     if (!encodeI2CResponse(&msgi2cResponse)) {
+      WS_DEBUG_PRINTLN("ERROR: encoding I2C Response!");
       return false;
     }
-  } else {
-    WS_DEBUG_PRINTLN("ERROR: Undefined I2C message tag");
-    return false; // fail out, we didn't encode anything to publish
+    publishI2CResponse(&msgi2cResponse);
+    return true;
+  }
+
+  // Initialize I2C device, unless it is already set up as requested
+  if (WS._configCache->i2cDeviceUnchanged(msgDeviceInitReq)) {
+    WS_DEBUG_PRINTLN("I2C device configuration unchanged");
+  } else if (WS._i2cPort0->initI2CDevice(msgDeviceInitReq)) {
+    WS._configCache->i2cDeviceInitialized(msgDeviceInitReq);
+  }
+
+  // Fill device's address and bus status
+  msgi2cResponse.payload.resp_i2c_device_init.i2c_device_address =
+      msgDeviceInitReq->i2c_device_address;
+  msgi2cResponse.payload.resp_i2c_device_init.bus_response =
+      WS._i2cPort0->getBusStatus();
+
+  // Encode response
+  if (!encodeI2CResponse(&msgi2cResponse)) {
+    return false;
+  }
+  // Publish a response for the I2C device
+  publishI2CResponse(&msgi2cResponse);
+  return true;
+}
+
+/******************************************************************************************/
+/*!
+    @brief    Updates an I2C device's properties and publishes its status.
+    @param    msgDeviceUpdateReq
+              The decoded I2CDeviceUpdateRequest message.
+    @returns  True if the response was published, False otherwise.
+*/
+/******************************************************************************************/
+bool Wippersnapper::i2cDeviceUpdateRequest(
+    wippersnapper_i2c_v1_I2CDeviceUpdateRequest *msgDeviceUpdateReq) {
+  // Empty I2C response to fill out
+  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
+      wippersnapper_signal_v1_I2CResponse_init_zero;
+  msgi2cResponse.which_payload =
+      wippersnapper_signal_v1_I2CResponse_resp_i2c_device_update_tag;
+
+  // Update I2C device's properties
+  WS._i2cPort0->updateI2CDeviceProperties(msgDeviceUpdateReq);
+  WS._configCache->i2cDeviceUpdated(msgDeviceUpdateReq);
+
+  // Fill address
+  msgi2cResponse.payload.resp_i2c_device_update.i2c_device_address =
+      msgDeviceUpdateReq->i2c_device_address;
+  msgi2cResponse.payload.resp_i2c_device_update.bus_response =
+      WS._i2cPort0->getBusStatus();
+
+  // Encode response
+  if (!encodeI2CResponse(&msgi2cResponse)) {
+    return false;
   }
   // Publish the I2CResponse
   publishI2CResponse(&msgi2cResponse);
-  return is_success;
+  return true;
+}
+
+/******************************************************************************************/
+/*!
+    @brief    Deinitializes an I2C device and publishes its status.
+    @param    msgDeviceDeinitReq
+              The decoded I2CDeviceDeinitRequest message.
+    @returns  True if the response was published, False otherwise.
+*/
+/******************************************************************************************/
+bool Wippersnapper::i2cDeviceDeinitRequest(
+    wippersnapper_i2c_v1_I2CDeviceDeinitRequest *msgDeviceDeinitReq) {
+  // Empty I2C response to fill out
+  wippersnapper_signal_v1_I2CResponse msgi2cResponse =
+      wippersnapper_signal_v1_I2CResponse_init_zero;
+  msgi2cResponse.which_payload =
+      wippersnapper_signal_v1_I2CResponse_resp_i2c_device_deinit_tag;
+
+  // Deinitialize I2C device
+  WS._i2cPort0->deinitI2CDevice(msgDeviceDeinitReq);
+  WS._configCache->i2cDeviceDeinitialized(
+      msgDeviceDeinitReq->i2c_device_address);
+  // Fill deinit response
+  msgi2cResponse.payload.resp_i2c_device_deinit.i2c_device_address =
+      msgDeviceDeinitReq->i2c_device_address;
+  msgi2cResponse.payload.resp_i2c_device_deinit.bus_response =
+      WS._i2cPort0->getBusStatus();
+
+  // Encode response
+  if (!encodeI2CResponse(&msgi2cResponse)) {
+    return false;
+  }
+  // Publish the I2CResponse
+  publishI2CResponse(&msgi2cResponse);
+  return true;
 }
 
 /**************************************************************************/
 /*!
     @brief    Called when i2c signal sub-topic receives a new message and
-              attempts to decode a signal request message.
+              attempts to decode a signal request message. Decoded
+              requests are queued and execute from run().
     @param    data
               Incoming data from MQTT broker.
     @param    len
@@ -787,14 +1310,22 @@ bool cbDecodeSignalRequestI2C(pb_istream_t *stream, const pb_field_t *field,
 */
 /**************************************************************************/
 void cbSignalI2CReq(char *data, uint16_t len) {
+  WS._commands->received();
   WS_DEBUG_PRINTLN("* NEW MESSAGE [Topic: Signal-I2C]: ");
   WS_DEBUG_PRINT(len);
   WS_DEBUG_PRINTLN(" bytes.");
-  // zero-out current buffer
-  memset(WS._buffer, 0, sizeof(WS._buffer));
-  // copy mqtt data into buffer
-  memcpy(WS._buffer, data, len);
-  WS.bufSize = len;
+
+  // Decode straight from the subscription's buffer
+  uint8_t *msgBuf = (uint8_t *)data;
+  size_t msgLen = len;
+  bool isChunked = WS._chunking->isChunk((uint8_t *)data, len);
+  if (isChunked) {
+    // wait until the final chunk of the message is reassembled
+    if (!WS._chunking->receive(WS_CHUNK_RX_I2C, (uint8_t *)data, len))
+      return;
+    msgBuf = WS._chunking->message(WS_CHUNK_RX_I2C);
+    msgLen = WS._chunking->messageLen(WS_CHUNK_RX_I2C);
+  }
 
   // Zero-out existing I2C signal msg.
   WS.msgSignalI2C = wippersnapper_signal_v1_I2CRequest_init_zero;
@@ -804,10 +1335,13 @@ void cbSignalI2CReq(char *data, uint16_t len) {
   WS.msgSignalI2C.cb_payload.funcs.decode = cbDecodeSignalRequestI2C;
 
   // Decode I2C signal request
-  pb_istream_t istream = pb_istream_from_buffer(WS._buffer, WS.bufSize);
+  pb_istream_t istream = pb_istream_from_buffer(msgBuf, msgLen);
   if (!pb_decode(&istream, wippersnapper_signal_v1_I2CRequest_fields,
                  &WS.msgSignalI2C))
     WS_DEBUG_PRINTLN("ERROR: Unable to decode I2C message");
+
+  if (isChunked)
+    WS._chunking->release(WS_CHUNK_RX_I2C);
 }
 
 /****************************************************************************/
@@ -829,8 +1363,15 @@ bool Wippersnapper::encodePinEvent(
   outgoingSignalMsg->which_payload =
       wippersnapper_signal_v1_CreateSignalRequest_pin_event_tag;
   // fill the pin_event message
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "D%d", pinName);
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_value, "%d", pinVal);
+  if (WS._numericPinValues) {
+    outgoingSignalMsg->payload.pin_event.pin_id = WS_CHANNEL_DIGITAL(pinName);
+    outgoingSignalMsg->payload.pin_event.which_numeric_value =
+        wippersnapper_pin_v1_PinEvent_pin_value_int_tag;
+    outgoingSignalMsg->payload.pin_event.numeric_value.pin_value_int = pinVal;
+  } else {
+    sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "D%d", pinName);
+    sprintf(outgoingSignalMsg->payload.pin_event.pin_value, "%d", pinVal);
+  }
 
   // Encode signal message
   pb_ostream_t stream =
@@ -844,6 +1385,28 @@ bool Wippersnapper::encodePinEvent(
   return is_success;
 }
 
+/****************************************************************************/
+/*!
+    @brief    Formats a value as a string with three decimal places,
+              without relying on the platform's printf float support.
+    @param    buf
+                Buffer to write the string into.
+    @param    bufLen
+                Length of buf, in bytes.
+    @param    value
+                Value to format.
+*/
+/****************************************************************************/
+void Wippersnapper::formatPinValue(char *buf, size_t bufLen, float value) {
+  long milli = lroundf(value * 1000.0f);
+  const char *sign = "";
+  if (milli < 0) {
+    sign = "-";
+    milli = -milli;
+  }
+  snprintf(buf, bufLen, "%s%ld.%03ld", sign, milli / 1000, milli % 1000);
+}
+
 /**************************************************************************/
 /*!
     @brief    Called when broker responds to a device's publish across
@@ -980,6 +1543,8 @@ void cbThrottleTopic(char *throttleData, uint16_t len) {
   WS_DEBUG_PRINT("Device is throttled for ");
   WS_DEBUG_PRINT(throttleDuration);
   WS_DEBUG_PRINTLN("ms and blocking command execution.");
+  // slow down sampling until the link recovers
+  WS._outbound->throttled();
   if (throttleDuration < WS_KEEPALIVE_INTERVAL_MS) {
     delay(WS_KEEPALIVE_INTERVAL_MS);
   } else {
@@ -1131,6 +1696,12 @@ bool Wippersnapper::buildWSTopics() {
       strlen("/wprsnpr/") + strlen(TOPIC_SIGNALS) + strlen("device") +
       strlen(TOPIC_I2C) + 1);
 
+  // Topic for batched telemetry from device to broker
+  WS._topic_signal_batch_device = (char *)malloc(
+      sizeof(char) * strlen(WS._username) + strlen(TOPIC_WS) +
+      strlen(_device_uid) + strlen(TOPIC_SIGNALS) + strlen("device") +
+      strlen(TOPIC_BATCH) + 1);
+
   // Create global registration topic
   if (WS._topic_description != NULL) {
     strcpy(WS._topic_description, WS._username);
@@ -1222,12 +1793,28 @@ bool Wippersnapper::buildWSTopics() {
     is_success = false;
   }
 
+  // Create device-to-broker batched telemetry topic
+  if (WS._topic_signal_batch_device != NULL) {
+    strcpy(WS._topic_signal_batch_device, WS._username);
+    strcat(WS._topic_signal_batch_device, TOPIC_WS);
+    strcat(WS._topic_signal_batch_device, _device_uid);
+    strcat(WS._topic_signal_batch_device, TOPIC_SIGNALS);
+    strcat(WS._topic_signal_batch_device, "device");
+    strcat(WS._topic_signal_batch_device, TOPIC_BATCH);
+  } else { // malloc failed
+    is_success = false;
+  }
+
   return is_success;
 }
 
 /**************************************************************************/
 /*!
-    @brief    Subscribes to device-specific MQTT control topics.
+    @brief    Subscribes to device-specific MQTT control topics. Each
+              topic takes a subscription of its own: Adafruit_MQTT only
+              delivers a message to the subscription whose topic equals
+              the message's topic, so a single wildcard subscription on
+              the device's topics would never receive a message.
 */
 /**************************************************************************/
 void Wippersnapper::subscribeWSTopics() {
@@ -1236,12 +1823,24 @@ void Wippersnapper::subscribeWSTopics() {
       new Adafruit_MQTT_Subscribe(WS._mqtt, WS._topic_signal_brkr, 1);
   WS._mqtt->subscribe(_topic_signal_brkr_sub);
   _topic_signal_brkr_sub->setCallback(cbSignalTopic);
+  // Long pin configuration lists are decoded as their chunks arrive
+  WS._chunking->setStream(
+      WS_CHUNK_RX_SIGNAL,
+      wippersnapper_signal_v1_CreateSignalRequest_pin_configs_tag,
+      wippersnapper_pin_v1_ConfigurePinRequest_size, cbDecodePinConfigMsg,
+      cbPinConfigListEnd);
 
   // Subscribe to signal's I2C sub-topic
   _topic_signal_i2c_sub =
       new Adafruit_MQTT_Subscribe(WS._mqtt, WS._topic_signal_i2c_brkr, 1);
   WS._mqtt->subscribe(_topic_signal_i2c_sub);
   _topic_signal_i2c_sub->setCallback(cbSignalI2CReq);
+  // Long I2C device lists are decoded as their chunks arrive
+  WS._chunking->setStream(
+      WS_CHUNK_RX_I2C,
+      wippersnapper_signal_v1_I2CRequest_req_i2c_device_init_requests_tag,
+      wippersnapper_i2c_v1_I2CDeviceInitRequest_size,
+      cbDecodeI2CDeviceInitRequestList, cbI2CDeviceListEnd);
 
   // Subscribe to registration status topic
   _topic_description_sub =
@@ -1250,6 +1849,22 @@ void Wippersnapper::subscribeWSTopics() {
   _topic_description_sub->setCallback(cbRegistrationStatus);
 }
 
+/**************************************************************************/
+/*!
+    @brief    Unsubscribes from the registration status topic once the
+              device has registered. Frees its subscription slot and
+              receive buffer, and saves a SUBSCRIBE round-trip each time
+              the MQTT connection is re-established.
+*/
+/**************************************************************************/
+void Wippersnapper::unsubscribeRegistrationTopic() {
+  if (_topic_description_sub == NULL)
+    return;
+  WS._mqtt->unsubscribe(_topic_description_sub);
+  delete _topic_description_sub;
+  _topic_description_sub = NULL;
+}
+
 /**************************************************************************/
 /*!
     @brief    Writes an error message to the serial and the filesystem,
@@ -1393,6 +2008,9 @@ bool Wippersnapper::registerBoard() {
   WS.feedWDT();
   pollRegistrationResp();
 
+  // Registration status is only sent by the broker while registering
+  unsubscribeRegistrationTopic();
+
   return true;
 }
 
@@ -1412,8 +2030,11 @@ ws_board_status_t Wippersnapper::getBoardStatus() { return WS._boardStatus; }
 */
 /**************************************************************************/
 void Wippersnapper::pingBroker() {
-  // ping within keepalive to keep connection open
-  if (millis() > (_prv_ping + WS_KEEPALIVE_INTERVAL_MS)) {
+  // ping within keepalive to keep connection open. The ping reads inbound
+  // packets while awaiting its response, so it is deferred, like
+  // processPackets(), until the command queue has room again
+  if (millis() > (_prv_ping + WS_KEEPALIVE_INTERVAL_MS) &&
+      WS._commands->accepting()) {
     WS_DEBUG_PRINTLN("PING!");
     WS._mqtt->ping();
     _prv_ping = millis();
@@ -1460,14 +2081,18 @@ void Wippersnapper::enableWDT(int timeoutMS) {
 /********************************************************/
 /*!
     @brief  Process all incoming packets from the
-            Adafruit IO MQTT broker. Handles network
-            connectivity.
+            Adafruit IO MQTT broker, while the command
+            queue has room for the commands they carry.
 */
 /*******************************************************/
 void Wippersnapper::processPackets() {
   // runNetFSM(); // NOTE: Removed for now, causes error with virtual _connect
   // method when caused with WS object in another file.
   WS.feedWDT();
+  // Backpressure, leave packets with the network stack until the queued
+  // commands have run
+  if (!WS._commands->accepting())
+    return;
   // Process all incoming packets from Wippersnapper MQTT Broker
   WS._mqtt->processPackets(10);
 }
@@ -1494,6 +2119,74 @@ void Wippersnapper::publish(const char *topic, uint8_t *payload, uint16_t bLen,
   WS._mqtt->publish(topic, payload, bLen, qos);
 }
 
+/********************************************************/
+/*!
+    @brief  Queues a message for publishing to the Adafruit
+            IO MQTT broker according to its traffic class.
+    @param  topic
+            The MQTT topic to publish to.
+    @param  payload
+            The payload to publish, copied into the queue.
+    @param  bLen
+            The length of the payload.
+    @param  msgClass
+            The message's traffic class.
+    @param  channel
+            The channel the message belongs to, WS_CHANNEL_*.
+            The QoS to publish with is looked up from the
+            class and channel.
+    @returns True if the message was published or queued,
+             False otherwise.
+*/
+/*******************************************************/
+bool Wippersnapper::queuePublish(const char *topic, uint8_t *payload,
+                                 uint16_t bLen, ws_msg_class_t msgClass,
+                                 uint16_t channel) {
+  return WS._outbound->enqueue(topic, payload, bLen, msgClass, channel);
+}
+
+/********************************************************/
+/*!
+    @brief  Encodes a message and queues it for publishing,
+            or publishes it as a sequence of chunks if it
+            exceeds the shared outgoing buffer.
+    @param  topic
+            The MQTT topic to publish to.
+    @param  fields
+            The message's nanopb field descriptor.
+    @param  src_struct
+            The message to encode.
+    @param  msgClass
+            The message's traffic class.
+    @param  channel
+            The channel the message belongs to, WS_CHANNEL_*.
+    @returns True if the message was published or queued,
+             False otherwise.
+*/
+/*******************************************************/
+bool Wippersnapper::queuePublish(const char *topic, const pb_msgdesc_t *fields,
+                                 const void *src_struct,
+                                 ws_msg_class_t msgClass, uint16_t channel) {
+  size_t msgSz;
+  if (!pb_get_encoded_size(&msgSz, fields, src_struct)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to size message");
+    return false;
+  }
+  if (msgSz > sizeof(WS._buffer_outgoing)) {
+    WS._outbound->flush(); // keep chunks in order with queued messages
+    return WS._chunking->publish(topic, fields, src_struct,
+                                 WS._outbound->getQoS(msgClass, channel));
+  }
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
+  if (!pb_encode(&stream, fields, src_struct)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode message");
+    return false;
+  }
+  return WS._outbound->enqueue(topic, WS._buffer_outgoing,
+                               stream.bytes_written, msgClass, channel);
+}
+
 /**************************************************************************/
 /*!
     @brief    Checks validity of WipperSnapper application credentials.
@@ -1539,6 +2232,12 @@ void Wippersnapper::connect() {
   subscribeWSTopics();
   subscribeErrorTopics();
 
+  // Apply the configuration saved by the previous boot. Pins are set up
+  // before the network, but sampling only starts from run() once the
+  // device has connected and registered: the cache removes the wait for
+  // the broker's configuration, not the time taken to connect
+  WS._configCache->load();
+
   // Connect to Network
   WS_DEBUG_PRINTLN("Running Network FSM...");
   // Run the network fsm
@@ -1555,17 +2254,18 @@ void Wippersnapper::connect() {
   runNetFSM();
   WS.feedWDT();
 
-  // Configure hardware
+  // Configure hardware, completion is published once the broker's
+  // configuration was applied. A cached configuration is already running
+  // and is reconciled with the broker's from run().
   WS.pinCfgCompleted = false;
-  while (!WS.pinCfgCompleted) {
+  while (!WS.pinCfgCompleted && !WS._configCache->warm()) {
     WS_DEBUG_PRINTLN(
         "Polling for message containing hardware configuration...");
-    WS._mqtt->processPackets(10); // poll
+    WS.processPackets(); // poll
+    WS._commands->process();
   }
-  // Publish that we have completed the configuration workflow
   WS.feedWDT();
   runNetFSM();
-  publishPinConfigComplete();
   WS_DEBUG_PRINTLN("Hardware configured successfully!");
 
   // Run application
@@ -1604,8 +2304,8 @@ void Wippersnapper::publishPinConfigComplete() {
 
   // Publish message
   WS_DEBUG_PRINTLN("Publishing to pin config complete...");
-  WS.publish(WS._topic_device_pin_config_complete, _message_buffer,
-             _message_len, 1);
+  WS.queuePublish(WS._topic_device_pin_config_complete, _message_buffer,
+                  _message_len, WS_MSG_CLASS_CONTROL);
 }
 
 /**************************************************************************/
@@ -1620,10 +2320,16 @@ ws_status_t Wippersnapper::run() {
   WS.feedWDT();
   pingBroker();
 
-  // Process all incoming packets from Wippersnapper MQTT Broker
-  WS._mqtt->processPackets(10);
+  // Process incoming packets from Wippersnapper MQTT Broker
+  WS.processPackets();
   WS.feedWDT();
 
+  // Execute commands received from the broker, within the tick's budget
+  WS._commands->process();
+
+  // Publish queued command responses before sampling new data
+  WS._outbound->process();
+
   // Process digital inputs, digitalGPIO module
   WS._digitalGPIO->processDigitalInputs();
   WS.feedWDT();
@@ -1632,10 +2338,27 @@ ws_status_t Wippersnapper::run() {
   WS._analogIO->processAnalogInputs();
   WS.feedWDT();
 
+  // Process pulse capture inputs
+  WS._pulseCapture->process();
+  WS.feedWDT();
+
+  // Publish a completed logic capture
+  WS._logicCapture->process();
+  WS.feedWDT();
+
   // Process I2C sensor events
   if (WS._isI2CPort0Init)
     WS._i2cPort0->update();
   WS.feedWDT();
 
+  // Publish batched telemetry once it has been held long enough
+  WS._batch->process();
+
+  // Save configuration changes to the filesystem once they settle
+  WS._configCache->process();
+
+  // Publish queued messages, highest priority first
+  WS._outbound->process();
+
   return WS_NET_CONNECTED; // TODO: Make this funcn void!
 }
\ No newline at end of file
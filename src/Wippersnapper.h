@@ -31,6 +31,43 @@
 #include <wippersnapper/pin/v1/pin.pb.h>                 // pin.proto
 #include <wippersnapper/signal/v1/signal.pb.h>           // signal.proto
 
+/** Defines the traffic class of a message published by the device,
+ * in order of priority */
+typedef enum {
+  WS_MSG_CLASS_CONTROL = 0,   // Command responses and acknowledgements
+  WS_MSG_CLASS_STATE = 1,     // On-change input and actuator state
+  WS_MSG_CLASS_TELEMETRY = 2, // Periodic sensor readings
+  WS_MSG_CLASS_DIAGNOSTIC = 3 // Device diagnostics
+} ws_msg_class_t;
+#define WS_MSG_CLASS_COUNT 4 ///< Total number of outbound message classes
+
+// Channel identifiers, used to look up a per-channel QoS override
+#define WS_CHANNEL_NONE 0xFFFF ///< Message does not belong to a channel
+#define WS_CHANNEL_DIGITAL(pin)                                                \
+  ((uint16_t)(pin)) ///< Channel identifier of a digital pin
+#define WS_CHANNEL_ANALOG(pin)                                                 \
+  ((uint16_t)(0x4000 | (pin))) ///< Channel identifier of an analog pin
+#define WS_CHANNEL_I2C(address)                                                \
+  ((uint16_t)(0x8000 | (address))) ///< Channel identifier of an I2C device
+#define WS_CHANNEL_IS_ANALOG(channel)                                          \
+  (((channel)&0xC000) == 0x4000) ///< True if the channel is an analog pin
+#define WS_CHANNEL_IS_I2C(channel)                                             \
+  (((channel)&0x8000) != 0) ///< True if the channel is an I2C device
+#define WS_CHANNEL_ID(channel)                                                 \
+  ((channel)&0x3FFF) ///< Pin number or I2C address of a channel
+
+// Input tables index their slots by pin number
+#if defined(ARDUINO_ARCH_SAMD)
+#define WS_PIN_INDEX_SIZE PINS_COUNT ///< Pin numbers within the pin index
+#elif defined(ARDUINO_ARCH_ESP32)
+#define WS_PIN_INDEX_SIZE SOC_GPIO_PIN_COUNT ///< Pin numbers within the index
+#elif defined(NUM_DIGITAL_PINS)
+#define WS_PIN_INDEX_SIZE NUM_DIGITAL_PINS ///< Pin numbers within the index
+#else
+#define WS_PIN_INDEX_SIZE 256 ///< Pin numbers within the pin index
+#endif
+#define WS_PIN_NO_SLOT 0xFF ///< Pin has no slot within an input table
+
 // Wippersnapper API Helpers
 #include "Wippersnapper_Boards.h"
 #include "components/statusLED/Wippersnapper_StatusLED_Colors.h"
@@ -38,7 +75,17 @@
 // Wippersnapper components
 #include "components/analogIO/Wippersnapper_AnalogIO.h"
 #include "components/digitalIO/Wippersnapper_DigitalGPIO.h"
+#include "components/digitalIO/Wippersnapper_LogicCapture.h"
 #include "components/i2c/WipperSnapper_I2C.h"
+#include "components/batch/Wippersnapper_Batch.h"
+#include "components/chunking/Wippersnapper_Chunking.h"
+#include "components/commands/Wippersnapper_Commands.h"
+#include "components/configCache/Wippersnapper_ConfigCache.h"
+#include "components/lastValue/Wippersnapper_LastValue.h"
+#include "components/pinConfig/Wippersnapper_PinConfig.h"
+#include "components/pwm/Wippersnapper_PWM.h"
+#include "components/pulseCapture/Wippersnapper_PulseCapture.h"
+#include "components/outbound/Wippersnapper_Outbound.h"
 
 // External libraries
 #include "Adafruit_MQTT.h" // MQTT Client
@@ -73,6 +120,7 @@
 #define TOPIC_INFO "/info/"       ///< Registration sub-topic
 #define TOPIC_SIGNALS "/signals/" ///< Signals sub-topic
 #define TOPIC_I2C "/i2c"          ///< I2C sub-topic
+#define TOPIC_BATCH "/batch"      ///< Batched telemetry sub-topic
 
 #define WS_DEBUG          ///< Define to enable debugging to serial terminal
 #define WS_PRINTER Serial ///< Where debug messages will be printed
@@ -159,10 +207,20 @@ typedef enum {
   512 ///< MAXIMUM expected payload size, in bytes
 
 class Wippersnapper_DigitalGPIO;
+class Wippersnapper_LogicCapture;
 class Wippersnapper_AnalogIO;
 class Wippersnapper_FS;
 class WipperSnapper_LittleFS;
 class WipperSnapper_Component_I2C;
+class Wippersnapper_Outbound;
+class Wippersnapper_Chunking;
+class Wippersnapper_Batch;
+class Wippersnapper_Commands;
+class Wippersnapper_ConfigCache;
+class Wippersnapper_LastValue;
+class Wippersnapper_PinConfig;
+class Wippersnapper_PWM;
+class Wippersnapper_PulseCapture;
 
 /**************************************************************************/
 /*!
@@ -207,11 +265,14 @@ public:
   void subscribeWSTopics();
   bool buildErrorTopics();
   void subscribeErrorTopics();
+  void unsubscribeRegistrationTopic();
 
   // Registration API
   bool registerBoard();
   bool encodePubRegistrationReq();
   void decodeRegistrationResp(char *data, uint16_t len);
+  void applyRegistration(
+      wippersnapper_description_v1_CreateDescriptionResponse *message);
   void pollRegistrationResp();
   // Configuration API
   void publishPinConfigComplete();
@@ -221,6 +282,12 @@ public:
   void processPackets();
   void publish(const char *topic, uint8_t *payload, uint16_t bLen,
                uint8_t qos = 0);
+  bool queuePublish(const char *topic, uint8_t *payload, uint16_t bLen,
+                    ws_msg_class_t msgClass,
+                    uint16_t channel = WS_CHANNEL_NONE);
+  bool queuePublish(const char *topic, const pb_msgdesc_t *fields,
+                    const void *src_struct, ws_msg_class_t msgClass,
+                    uint16_t channel = WS_CHANNEL_NONE);
 
   // Networking helpers
   void pingBroker();
@@ -237,15 +304,42 @@ public:
   // MQTT topic callbacks //
   // Decodes a signal message
   bool decodeSignalMsg(
-      wippersnapper_signal_v1_CreateSignalRequest *encodedSignalMsg);
+      wippersnapper_signal_v1_CreateSignalRequest *encodedSignalMsg,
+      uint8_t *buffer, size_t bufferLen);
 
   // Encodes a pin event message
   bool
   encodePinEvent(wippersnapper_signal_v1_CreateSignalRequest *outgoingSignalMsg,
                  uint8_t pinName, int pinVal);
+  static void formatPinValue(char *buf, size_t bufLen, float value);
 
   // Pin configure message
   bool configurePinRequest(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg);
+  bool reconcilePinRequest(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg,
+                           int pin);
+  bool applyPinRequest(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg,
+                       int pin);
+  bool pinConfigListRequest(Wippersnapper_PinConfig *pinConfigList);
+  bool reconfigurePin(wippersnapper_pin_v1_ConfigurePinRequest *prvPinMsg,
+                      wippersnapper_pin_v1_ConfigurePinRequest *pinMsg,
+                      int pin);
+  // Pin event messages
+  bool pinEventsRequest(digitalPinWrites *pinWrites);
+  // PWM messages
+  bool pwmConfigRequest(wippersnapper_pin_v1_ConfigurePWMPinRequest *pwmMsg);
+  bool pwmEventRequest(wippersnapper_pin_v1_PWMPinEvent *pwmMsg);
+  // Pulse capture messages
+  bool pulseCaptureConfigRequest(
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest *captureMsg);
+
+  // I2C request messages
+  bool i2cScanRequest(wippersnapper_i2c_v1_I2CBusScanRequest *msgScanReq);
+  bool i2cDeviceInitRequest(
+      wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq);
+  bool i2cDeviceUpdateRequest(
+      wippersnapper_i2c_v1_I2CDeviceUpdateRequest *msgDeviceUpdateReq);
+  bool i2cDeviceDeinitRequest(
+      wippersnapper_i2c_v1_I2CDeviceDeinitRequest *msgDeviceDeinitReq);
 
   // I2C
   std::vector<WipperSnapper_Component_I2C *>
@@ -259,20 +353,42 @@ public:
   bool _isI2CPort1Init =
       false; ///< True if I2C port 1 has been initialized, False otherwise.
 
-  uint8_t _buffer[WS_MQTT_MAX_PAYLOAD_SIZE]; /*!< Shared buffer to save callback
-                                                payload */
   uint8_t
       _buffer_outgoing[WS_MQTT_MAX_PAYLOAD_SIZE]; /*!< buffer which contains
                                                      outgoing payload data */
-  uint16_t bufSize; /*!< Length of data inside buffer */
 
   ws_board_status_t _boardStatus; ///< Hardware's registration status
+  bool _numericPinValues = false; ///< True if the broker accepted numeric
+                                  ///< pin values during registration
 
-  Wippersnapper_DigitalGPIO *_digitalGPIO; ///< Instance of digital gpio class
-  Wippersnapper_AnalogIO *_analogIO;       ///< Instance of analog io class
+  Wippersnapper_DigitalGPIO *_digitalGPIO =
+      NULL; ///< Instance of digital gpio class
+  Wippersnapper_AnalogIO *_analogIO = NULL; ///< Instance of analog io class
   Wippersnapper_FS *_fileSystem; ///< Instance of Filesystem (native USB)
   WipperSnapper_LittleFS
       *_littleFS; ///< Instance of LittleFS Filesystem (non-native USB)
+  Wippersnapper_Outbound *_outbound =
+      NULL; ///< Prioritized queues for messages published by the device
+  Wippersnapper_Chunking *_chunking =
+      NULL; ///< Splits and reassembles messages larger than the buffers
+  Wippersnapper_Batch *_batch =
+      NULL; ///< Compresses periodic telemetry into batched messages
+  Wippersnapper_Commands *_commands =
+      NULL; ///< Commands decoded from the broker, waiting to be executed
+  Wippersnapper_ConfigCache *_configCache =
+      NULL; ///< Configuration applied by the broker, saved for warm starts
+  Wippersnapper_LastValue *_lastValue =
+      NULL; ///< Most recent value of every configured channel
+  Wippersnapper_PinConfig *_pinConfigStaged =
+      NULL; ///< Pin configuration list being received from the broker
+  wsCommandList _i2cDeviceListStaged = {
+      WS_CMD_I2C_DEVICE_INIT, NULL, 0,
+      0}; ///< I2C device list being received from the broker
+  Wippersnapper_PWM *_pwm = NULL; ///< PWM outputs driven by hardware timers
+  Wippersnapper_PulseCapture *_pulseCapture =
+      NULL; ///< Pulse trains of timing sensors, decoded in the background
+  Wippersnapper_LogicCapture *_logicCapture =
+      NULL; ///< Timer-driven sampling of digital pins, for diagnostics
 
   uint8_t _uid[6];      /*!< Unique network iface identifier */
   char sUID[13];        /*!< Unique network iface identifier */
@@ -299,6 +415,8 @@ public:
                                    to a broker. */
   char *_topic_signal_i2c_device = NULL; /*!< Topic carries messages from a
                                      broker to a device. */
+  char *_topic_signal_batch_device =
+      NULL; /*!< Topic carries batched telemetry from a device to a broker. */
 
   wippersnapper_signal_v1_CreateSignalRequest
       _incomingSignalMsg; /*!< Incoming signal message from broker */
@@ -345,8 +463,8 @@ protected:
   char *_err_topic = NULL;         /*!< Adafruit IO MQTT error message topic. */
   char *_throttle_topic = NULL; /*!< Adafruit IO MQTT throttle message topic. */
 
-  Adafruit_MQTT_Subscribe
-      *_topic_description_sub; /*!< Subscription for registration topic. */
+  Adafruit_MQTT_Subscribe *_topic_description_sub =
+      NULL; /*!< Subscription for registration topic. */
   Adafruit_MQTT_Publish
       *_topic_signal_device_pub; /*!< Subscription for D2C signal topic. */
   Adafruit_MQTT_Subscribe
@@ -27,7 +27,8 @@
 /***********************************************************************************/
 Wippersnapper_AnalogIO::Wippersnapper_AnalogIO(int32_t totalAnalogInputPins,
                                                float aRef) {
-  _totalAnalogInputPins = totalAnalogInputPins;
+  // slots are indexed by a byte, WS_PIN_NO_SLOT marks unused pins
+  _totalAnalogInputPins = min(totalAnalogInputPins, (int32_t)WS_PIN_NO_SLOT);
 
   // Set aref
   setAref(aRef);
@@ -44,6 +45,8 @@ Wippersnapper_AnalogIO::Wippersnapper_AnalogIO(int32_t totalAnalogInputPins,
     // turn sampling off
     _analog_input_pins[pin].period = -1;
   }
+  _pinSlots = new uint8_t[WS_PIN_INDEX_SIZE];
+  memset(_pinSlots, WS_PIN_NO_SLOT, WS_PIN_INDEX_SIZE);
 }
 
 /***********************************************************************************/
@@ -55,7 +58,8 @@ Wippersnapper_AnalogIO::~Wippersnapper_AnalogIO() {
   _aRef = 0.0;
   _totalAnalogInputPins = 0;
   _hysterisis = 0;
-  delete _analog_input_pins;
+  delete[] _analog_input_pins;
+  delete[] _pinSlots;
 }
 
 /***********************************************************************************/
@@ -153,21 +157,142 @@ void Wippersnapper_AnalogIO::initAnalogInputPin(
   } else {
     pinMode(pin, INPUT); // set analog input
   }
+  WS._lastValue->track(WS_CHANNEL_ANALOG(pin));
 
   // Period is in seconds, cast it to long and convert it to milliseconds
   long periodMs = (long)period * 1000;
   WS_DEBUG_PRINT("Interval (ms):");
   WS_DEBUG_PRINTLN(periodMs);
 
-  // attempt to allocate pin within _analog_input_pins[]
-  for (int i = 0; i < _totalAnalogInputPins; i++) {
-    if (_analog_input_pins[i].period == -1L) {
-      _analog_input_pins[i].pinName = pin;
-      _analog_input_pins[i].period = periodMs;
-      _analog_input_pins[i].readMode = analogReadMode;
-      break;
-    }
+  // an input pin keeps its slot, otherwise append it to the inputs
+  int slot = findAnalogInput(pin);
+  if (slot == -1)
+    slot = addAnalogInput(pin);
+  if (slot == -1)
+    return;
+  _analog_input_pins[slot].period = periodMs;
+  _analog_input_pins[slot].readMode = analogReadMode;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Looks up the input slot of an analog pin.
+    @param  pin
+              The analog pin.
+    @returns  The pin's index within _analog_input_pins[], -1 if the pin is
+              not a configured input.
+*/
+/***********************************************************************************/
+int Wippersnapper_AnalogIO::findAnalogInput(int pin) {
+  if (pin < 0 || pin >= WS_PIN_INDEX_SIZE || _pinSlots[pin] == WS_PIN_NO_SLOT)
+    return -1;
+  return _pinSlots[pin];
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Appends an analog pin to the configured inputs.
+    @param  pin
+              The analog pin, which must not be an input.
+    @returns  The pin's index within _analog_input_pins[], -1 if every slot
+              is in use.
+*/
+/***********************************************************************************/
+int Wippersnapper_AnalogIO::addAnalogInput(int pin) {
+  if (_analogInputCount == _totalAnalogInputPins || pin < 0 ||
+      pin >= WS_PIN_INDEX_SIZE) {
+    WS_DEBUG_PRINTLN("ERROR: No free analog input slot");
+    return -1;
+  }
+  int slot = _analogInputCount++;
+  _analog_input_pins[slot].pinName = pin;
+  _analog_input_pins[slot].prvPeriod = 0L;
+  _analog_input_pins[slot].prvPinVal = 0.0;
+  _pinSlots[pin] = slot;
+  return slot;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes an input from the configured inputs, moving the last
+            input into its slot.
+    @param  slot
+              The input's index within _analog_input_pins[].
+*/
+/***********************************************************************************/
+void Wippersnapper_AnalogIO::removeAnalogInput(int slot) {
+  int last = --_analogInputCount;
+  _pinSlots[_analog_input_pins[slot].pinName] = WS_PIN_NO_SLOT;
+  if (slot != last) {
+    _analog_input_pins[slot] = _analog_input_pins[last];
+    _pinSlots[_analog_input_pins[slot].pinName] = slot;
   }
+  _analog_input_pins[last].period = -1;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Reads an analog input pin outside of its schedule, storing the
+            value within the last-value cache.
+    @param  pin
+              The analog input pin.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_AnalogIO::readAnalogInput(int pin) {
+  int slot = findAnalogInput(pin);
+  if (slot == -1)
+    return false;
+  uint16_t value = readAnalogPinRaw(pin);
+  WS._lastValue->update(
+      WS_CHANNEL_ANALOG(pin), 0,
+      _analog_input_pins[slot].readMode ==
+              wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE
+          ? getAnalogPinVoltage(value)
+          : (float)value);
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Changes the period of a configured analog input pin. The pin
+            keeps its schedule and previous value.
+    @param  pin
+              The analog input pin.
+    @param  period
+              Time between measurements, in seconds.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_AnalogIO::setAnalogInputPeriod(int pin, float period) {
+  int slot = findAnalogInput(pin);
+  if (slot == -1)
+    return false;
+  // Period is in seconds, cast it to long and convert it to milliseconds
+  _analog_input_pins[slot].period = (long)period * 1000;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if an analog pin is configured as an input.
+    @param  pin
+              The analog pin.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_AnalogIO::isAnalogInput(int pin) {
+  return findAnalogInput(pin) != -1;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of analog input slots which are not in use.
+    @returns  Number of free slots within _analog_input_pins[].
+*/
+/***********************************************************************************/
+int32_t Wippersnapper_AnalogIO::freeAnalogInputSlots() {
+  return _totalAnalogInputPins - _analogInputCount;
 }
 
 /***********************************************************************************/
@@ -178,16 +303,11 @@ void Wippersnapper_AnalogIO::initAnalogInputPin(
 */
 /***********************************************************************************/
 void Wippersnapper_AnalogIO::deinitAnalogInputPinObj(int pin) {
-  // de-allocate the pin within digital_input_pins[]
-  for (int i = 0; i < _totalAnalogInputPins; i++) {
-    if (_analog_input_pins[i].pinName == pin) {
-      _analog_input_pins[i].pinName = 0;
-      _analog_input_pins[i].period = -1;
-      _analog_input_pins[i].prvPinVal = 0.0;
-      _analog_input_pins[i].prvPeriod = 0L;
-      break;
-    }
-  }
+  WS._lastValue->untrack(WS_CHANNEL_ANALOG(pin));
+  // de-allocate the pin within _analog_input_pins[]
+  int slot = findAnalogInput(pin);
+  if (slot != -1)
+    removeAnalogInput(slot);
 }
 
 /***********************************************************************************/
@@ -275,8 +395,15 @@ bool Wippersnapper_AnalogIO::encodePinEvent(
   // fill the pin_event message
   outgoingSignalMsg->which_payload =
       wippersnapper_signal_v1_CreateSignalRequest_pin_event_tag;
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "A%d", pinName);
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_value, "%u", pinVal);
+  if (WS._numericPinValues) {
+    outgoingSignalMsg->payload.pin_event.pin_id = WS_CHANNEL_ANALOG(pinName);
+    outgoingSignalMsg->payload.pin_event.which_numeric_value =
+        wippersnapper_pin_v1_PinEvent_pin_value_int_tag;
+    outgoingSignalMsg->payload.pin_event.numeric_value.pin_value_int = pinVal;
+  } else {
+    sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "A%d", pinName);
+    sprintf(outgoingSignalMsg->payload.pin_event.pin_value, "%u", pinVal);
+  }
 
   // Encode signal message
   pb_ostream_t stream =
@@ -313,8 +440,19 @@ bool Wippersnapper_AnalogIO::encodePinEvent(
   // fill the pin_event message
   outgoingSignalMsg->which_payload =
       wippersnapper_signal_v1_CreateSignalRequest_pin_event_tag;
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "A%d", pinName);
-  sprintf(outgoingSignalMsg->payload.pin_event.pin_value, "%0.3f", pinVal);
+  if (WS._numericPinValues) {
+    outgoingSignalMsg->payload.pin_event.pin_id = WS_CHANNEL_ANALOG(pinName);
+    outgoingSignalMsg->payload.pin_event.which_numeric_value =
+        wippersnapper_pin_v1_PinEvent_pin_value_float_tag;
+    outgoingSignalMsg->payload.pin_event.numeric_value.pin_value_float =
+        pinVal;
+  } else {
+    sprintf(outgoingSignalMsg->payload.pin_event.pin_name, "A%d", pinName);
+    char *pinValue = outgoingSignalMsg->payload.pin_event.pin_value;
+    Wippersnapper::formatPinValue(
+        pinValue, sizeof(outgoingSignalMsg->payload.pin_event.pin_value),
+        pinVal);
+  }
 
   // Encode signal message
   pb_ostream_t stream =
@@ -336,22 +474,94 @@ bool Wippersnapper_AnalogIO::encodePinEvent(
 void Wippersnapper_AnalogIO::processAnalogInputs() {
   long _curTime = millis();
   // Process analog input pins
-  for (int i = 0; i < _totalAnalogInputPins; i++) {
-    if (_analog_input_pins[i].period >
-        -1L) { // validate if pin is enabled for sampling
-      // pin executes on-period
-      if (_curTime - _analog_input_pins[i].prvPeriod >
-              _analog_input_pins[i].period &&
-          _analog_input_pins[i].period != 0L) {
-        WS_DEBUG_PRINT("Executing periodic event on A");
+  for (int i = 0; i < _analogInputCount; i++) {
+    // pin executes on-period, stretched while the link is congested
+    if (_curTime - _analog_input_pins[i].prvPeriod >
+            WS._outbound->samplingPeriod(
+                WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName),
+                _analog_input_pins[i].period) &&
+        _analog_input_pins[i].period != 0L) {
+      WS_DEBUG_PRINT("Executing periodic event on A");
+      WS_DEBUG_PRINTLN(_analog_input_pins[i].pinName);
+
+      // init outgoing signal msg
+      _outgoingSignalMsg =
+          wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+
+      // Perform an analog read
+      _pinValue = readAnalogPinRaw(_analog_input_pins[i].pinName);
+      float value =
+          _analog_input_pins[i].readMode ==
+                  wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE
+              ? getAnalogPinVoltage(_pinValue)
+              : (float)_pinValue;
+      WS._lastValue->update(WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName),
+                            0, value);
+
+      // Batched channels are compressed and published together
+      if (WS._batch->add(WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName), 0,
+                         value)) {
+        _analog_input_pins[i].prvPeriod = _curTime;
+        continue;
+      }
+
+      if (_analog_input_pins[i].readMode ==
+          wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE) {
+        // convert value to voltage
+        _pinVoltage = getAnalogPinVoltage(_pinValue);
+        // Attempt to encode pin event
+        if (!encodePinEvent(&_outgoingSignalMsg,
+                            _analog_input_pins[i].pinName, _pinVoltage)) {
+          WS_DEBUG_PRINTLN(
+              "ERROR: Unable to encode pinevent (analog input, voltage");
+        }
+      } else { // raw value
+        // Attempt to encode pin event msg.
+        if (!encodePinEvent(&_outgoingSignalMsg,
+                            _analog_input_pins[i].pinName, _pinValue)) {
+          WS_DEBUG_PRINTLN(
+              "ERROR: Unable to encode pinevent (analog input, value");
+        }
+      }
+
+      // Obtain size and only write out buffer to end
+      size_t msgSz;
+      pb_get_encoded_size(&msgSz,
+                          wippersnapper_signal_v1_CreateSignalRequest_fields,
+                          &_outgoingSignalMsg);
+      WS_DEBUG_PRINT("Publishing pinEvent...");
+      WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing, msgSz,
+                      WS_MSG_CLASS_TELEMETRY,
+                      WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName));
+      WS_DEBUG_PRINTLN("Published!");
+
+      // reset the digital pin
+      _analog_input_pins[i].prvPeriod = _curTime;
+    }
+    // pin sample on-change
+    else if (_analog_input_pins[i].period == 0L) {
+      // Perform an analog read
+      _pinValue = readAnalogPinRaw(_analog_input_pins[i].pinName);
+      WS._lastValue->update(
+          WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName), 0,
+          _analog_input_pins[i].readMode ==
+                  wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE
+              ? getAnalogPinVoltage(_pinValue)
+              : (float)_pinValue);
+      // calculate bounds
+      _pinValThreshHi = _analog_input_pins[i].prvPinVal +
+                        (_analog_input_pins[i].prvPinVal * _hysterisis);
+      _pinValThreshLow = _analog_input_pins[i].prvPinVal -
+                         (_analog_input_pins[i].prvPinVal * _hysterisis);
+
+      if (_pinValue > _pinValThreshHi || _pinValue < _pinValThreshLow) {
+        WS_DEBUG_PRINT("Executing state-based event on A");
         WS_DEBUG_PRINTLN(_analog_input_pins[i].pinName);
 
         // init outgoing signal msg
         _outgoingSignalMsg =
             wippersnapper_signal_v1_CreateSignalRequest_init_zero;
 
-        // Perform an analog read
-        _pinValue = readAnalogPinRaw(_analog_input_pins[i].pinName);
         if (_analog_input_pins[i].readMode ==
             wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE) {
           // convert value to voltage
@@ -371,73 +581,25 @@ void Wippersnapper_AnalogIO::processAnalogInputs() {
           }
         }
 
-        // Obtain size and only write out buffer to end
+        // Obtain msg size and only write out buffer to end
         size_t msgSz;
-        pb_get_encoded_size(&msgSz,
-                            wippersnapper_signal_v1_CreateSignalRequest_fields,
-                            &_outgoingSignalMsg);
+        pb_get_encoded_size(
+            &msgSz, wippersnapper_signal_v1_CreateSignalRequest_fields,
+            &_outgoingSignalMsg);
+        // Publish
         WS_DEBUG_PRINT("Publishing pinEvent...");
-        WS.publish(WS._topic_signal_device, WS._buffer_outgoing, msgSz, 1);
+        WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing, msgSz,
+                        WS_MSG_CLASS_STATE,
+                        WS_CHANNEL_ANALOG(_analog_input_pins[i].pinName));
         WS_DEBUG_PRINTLN("Published!");
 
+        // set the pin value in the digital pin object for comparison on next
+        // run
+        _analog_input_pins[i].prvPinVal = _pinValue;
+
         // reset the digital pin
         _analog_input_pins[i].prvPeriod = _curTime;
       }
-      // pin sample on-change
-      else if (_analog_input_pins[i].period == 0L) {
-        // Perform an analog read
-        _pinValue = readAnalogPinRaw(_analog_input_pins[i].pinName);
-        // calculate bounds
-        _pinValThreshHi = _analog_input_pins[i].prvPinVal +
-                          (_analog_input_pins[i].prvPinVal * _hysterisis);
-        _pinValThreshLow = _analog_input_pins[i].prvPinVal -
-                           (_analog_input_pins[i].prvPinVal * _hysterisis);
-
-        if (_pinValue > _pinValThreshHi || _pinValue < _pinValThreshLow) {
-          WS_DEBUG_PRINT("Executing state-based event on A");
-          WS_DEBUG_PRINTLN(_analog_input_pins[i].pinName);
-
-          // init outgoing signal msg
-          _outgoingSignalMsg =
-              wippersnapper_signal_v1_CreateSignalRequest_init_zero;
-
-          if (_analog_input_pins[i].readMode ==
-              wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE) {
-            // convert value to voltage
-            _pinVoltage = getAnalogPinVoltage(_pinValue);
-            // Attempt to encode pin event
-            if (!encodePinEvent(&_outgoingSignalMsg,
-                                _analog_input_pins[i].pinName, _pinVoltage)) {
-              WS_DEBUG_PRINTLN(
-                  "ERROR: Unable to encode pinevent (analog input, voltage");
-            }
-          } else { // raw value
-            // Attempt to encode pin event msg.
-            if (!encodePinEvent(&_outgoingSignalMsg,
-                                _analog_input_pins[i].pinName, _pinValue)) {
-              WS_DEBUG_PRINTLN(
-                  "ERROR: Unable to encode pinevent (analog input, value");
-            }
-          }
-
-          // Obtain msg size and only write out buffer to end
-          size_t msgSz;
-          pb_get_encoded_size(
-              &msgSz, wippersnapper_signal_v1_CreateSignalRequest_fields,
-              &_outgoingSignalMsg);
-          // Publish
-          WS_DEBUG_PRINT("Publishing pinEvent...");
-          WS.publish(WS._topic_signal_device, WS._buffer_outgoing, msgSz, 1);
-          WS_DEBUG_PRINTLN("Published!");
-
-          // set the pin value in the digital pin object for comparison on next
-          // run
-          _analog_input_pins[i].prvPinVal = _pinValue;
-
-          // reset the digital pin
-          _analog_input_pins[i].prvPeriod = _curTime;
-        }
-      }
     }
   }
 }
\ No newline at end of file
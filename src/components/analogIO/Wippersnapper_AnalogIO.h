@@ -54,6 +54,10 @@ public:
   deinitAnalogPin(wippersnapper_pin_v1_ConfigurePinRequest_Direction direction,
                   int pin);
   void deinitAnalogInputPinObj(int pin);
+  bool setAnalogInputPeriod(int pin, float period);
+  bool readAnalogInput(int pin);
+  bool isAnalogInput(int pin);
+  int32_t freeAnalogInputSlots();
 
   uint16_t readAnalogPinRaw(int pin);
   float getAnalogPinVoltage(uint16_t rawValue);
@@ -71,14 +75,21 @@ public:
   encodePinEvent(wippersnapper_signal_v1_CreateSignalRequest *outgoingSignalMsg,
                  uint8_t pinName, uint16_t pinVal);
 
-  analogInputPin *_analog_input_pins; /*!< Array of analog pin objects */
+  analogInputPin *_analog_input_pins; /*!< Array of analog pin objects, the
+                                         configured inputs first */
 private:
+  int findAnalogInput(int pin);
+  int addAnalogInput(int pin);
+  void removeAnalogInput(int slot);
+
   float _aRef;           /*!< Hardware's reported voltage reference */
   int _adcResolution;    /*!< Resolution returned by the analogRead() funcn. */
   int _nativeResolution; /*!< Hardware's native ADC resolution. */
   bool scaleAnalogRead = false; /*!< True if we need to manually scale the value
                                    returned by analogRead(). */
   int32_t _totalAnalogInputPins; /*!< Total number of analog input pins */
+  int32_t _analogInputCount = 0; /*!< Configured inputs */
+  uint8_t *_pinSlots;            /*!< Slot of each pin or WS_PIN_NO_SLOT */
 
   float _hysterisis;         /*!< Hysterisis factor. */
   uint16_t _pinValThreshLow; /*!< Calculated low threshold. */
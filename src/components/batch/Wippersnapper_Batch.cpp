@@ -0,0 +1,383 @@
+/*!
+ * @file Wippersnapper_Batch.cpp
+ *
+ * Collects periodic telemetry samples into compressed time series and
+ * publishes them as a single batched message.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_Batch.h"
+
+/***********************************************************************************/
+/*!
+    @brief  nanopb encode callback, writes the time series of a batch.
+    @param  stream
+            Output stream to write to.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            The Wippersnapper_Batch instance.
+    @returns  True if the series were encoded, False otherwise.
+*/
+/***********************************************************************************/
+static bool cbEncodeSeries(pb_ostream_t *stream, const pb_field_t *field,
+                           void *const *arg) {
+  return ((Wippersnapper_Batch *)*arg)->encodeSeries(stream, field);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  nanopb encode callback, writes the compressed samples of a time
+            series as a bytes field.
+    @param  stream
+            Output stream to write to.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            The batchSeries holding the samples.
+    @returns  True if the samples were encoded, False otherwise.
+*/
+/***********************************************************************************/
+static bool cbEncodeSamples(pb_ostream_t *stream, const pb_field_t *field,
+                            void *const *arg) {
+  batchSeries *series = (batchSeries *)*arg;
+  return pb_encode_tag_for_field(stream, field) &&
+         pb_encode_string(stream, series->data, (series->bitLen + 7) / 8);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Creates an empty telemetry batch. No channels are batched
+            until enabled.
+*/
+/***********************************************************************************/
+Wippersnapper_Batch::Wippersnapper_Batch() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Destroys a telemetry batch.
+*/
+/***********************************************************************************/
+Wippersnapper_Batch::~Wippersnapper_Batch() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Enables batching of a channel's periodic telemetry.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @returns  True if the channel is batched, False if the channel table
+              is full.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Batch::enableChannel(uint16_t channel) {
+  if (isBatched(channel))
+    return true;
+  if (_channelCount == WS_BATCH_MAX_CHANNELS) {
+    WS_DEBUG_PRINTLN("ERROR: Batched channel table is full");
+    return false;
+  }
+  _channels[_channelCount++] = channel;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Enables batching of the channels listed within the optional
+            "batch" array of secrets.json, ie: ["A0", "0x44"]
+    @param  channels
+            The "batch" array of channel names.
+*/
+/***********************************************************************************/
+void Wippersnapper_Batch::configureBatch(JsonArray channels) {
+  for (JsonVariant name : channels) {
+    uint16_t channel;
+    if (!Wippersnapper_Outbound::channelFromName(name.as<const char *>(),
+                                                 &channel)) {
+      WS_DEBUG_PRINT("ERROR: Invalid batch channel name: ");
+      WS_DEBUG_PRINTLN(name.as<const char *>());
+      continue;
+    }
+    enableChannel(channel);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a channel's periodic telemetry is batched.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @returns  True if the channel is batched, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Batch::isBatched(uint16_t channel) {
+  for (int i = 0; i < _channelCount; i++) {
+    if (_channels[i] == channel)
+      return true;
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the time series of a channel and sensor type, starting
+            a new series if required.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The sensor type of the samples.
+    @returns  Pointer to the series, NULL if every series is in use.
+*/
+/***********************************************************************************/
+batchSeries *Wippersnapper_Batch::getSeries(uint16_t channel,
+                                            uint8_t sensorType) {
+  for (int i = 0; i < _seriesCount; i++) {
+    if (_series[i].channel == channel && _series[i].sensorType == sensorType)
+      return &_series[i];
+  }
+  if (_seriesCount == WS_BATCH_MAX_SERIES)
+    return NULL;
+  batchSeries *series = &_series[_seriesCount++];
+  memset(series, 0, sizeof(batchSeries));
+  series->channel = channel;
+  series->sensorType = sensorType;
+  return series;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Appends bits to a series, most significant bit first.
+    @param  series
+            The time series.
+    @param  value
+            The bits to write, right-aligned.
+    @param  numBits
+            Number of bits to write, up to 32.
+*/
+/***********************************************************************************/
+void Wippersnapper_Batch::writeBits(batchSeries *series, uint32_t value,
+                                    uint8_t numBits) {
+  while (numBits > 0) {
+    numBits--;
+    if ((value >> numBits) & 1)
+      series->data[series->bitLen / 8] |= 0x80 >> (series->bitLen % 8);
+    series->bitLen++;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes a sample's timestamp as the difference between the
+            current and previous delta. Regular sampling periods compress
+            to a single bit:
+            '0' delta unchanged, '10' + 7 bits, '110' + 9 bits,
+            '1110' + 12 bits, '1111' + 32 bits (two's complement).
+    @param  series
+            The time series.
+    @param  time
+            The sample's timestamp, in millis.
+*/
+/***********************************************************************************/
+void Wippersnapper_Batch::writeTime(batchSeries *series, uint32_t time) {
+  int32_t delta = (int32_t)(time - series->prvTime);
+  int32_t dod = delta - series->prvDelta;
+  if (dod == 0) {
+    writeBits(series, 0b0, 1);
+  } else if (dod >= -64 && dod <= 63) {
+    writeBits(series, 0b10, 2);
+    writeBits(series, (uint32_t)dod & 0x7F, 7);
+  } else if (dod >= -256 && dod <= 255) {
+    writeBits(series, 0b110, 3);
+    writeBits(series, (uint32_t)dod & 0x1FF, 9);
+  } else if (dod >= -2048 && dod <= 2047) {
+    writeBits(series, 0b1110, 4);
+    writeBits(series, (uint32_t)dod & 0xFFF, 12);
+  } else {
+    writeBits(series, 0b1111, 4);
+    writeBits(series, (uint32_t)dod, 32);
+  }
+  series->prvDelta = delta;
+  series->prvTime = time;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes a sample's value XOR'd with the previous value. Slowly
+            changing values share their sign, exponent and upper mantissa
+            bits, leaving a short window of meaningful bits:
+            '0' value unchanged, '10' + bits within the previous window,
+            '11' + 5 bits leading zeros + 5 bits (length - 1) + bits.
+    @param  series
+            The time series.
+    @param  value
+            Bits of the sample's float value.
+*/
+/***********************************************************************************/
+void Wippersnapper_Batch::writeValue(batchSeries *series, uint32_t value) {
+  uint32_t xorValue = value ^ series->prvValue;
+  series->prvValue = value;
+  if (xorValue == 0) {
+    writeBits(series, 0b0, 1);
+    return;
+  }
+
+  uint8_t leading = min(__builtin_clz(xorValue), 31);
+  uint8_t trailing = __builtin_ctz(xorValue);
+  // reuse the previous window if the meaningful bits fit within it
+  if (series->prvLeading + series->prvTrailing > 0 &&
+      leading >= series->prvLeading && trailing >= series->prvTrailing) {
+    writeBits(series, 0b10, 2);
+    writeBits(series, xorValue >> series->prvTrailing,
+              32 - series->prvLeading - series->prvTrailing);
+    return;
+  }
+
+  uint8_t length = 32 - leading - trailing;
+  writeBits(series, 0b11, 2);
+  writeBits(series, leading, 5);
+  writeBits(series, length - 1, 5);
+  writeBits(series, xorValue >> trailing, length);
+  series->prvLeading = leading;
+  series->prvTrailing = trailing;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Adds a sample to a batched channel's time series. The first
+            sample of a series is written uncompressed, as a 32-bit
+            timestamp and 32-bit float.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The sensor type of the sample, 0 for analog pins.
+    @param  value
+            The sample's value.
+    @returns  True if the sample was added to the batch, False if the
+              channel is not batched or the sample could not be stored
+              and must be published on its own.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Batch::add(uint16_t channel, uint8_t sensorType,
+                              float value) {
+  if (!isBatched(channel))
+    return false;
+
+  batchSeries *series = getSeries(channel, sensorType);
+  if (series == NULL ||
+      series->bitLen + WS_BATCH_MAX_SAMPLE_BITS > WS_BATCH_SERIES_SIZE * 8) {
+    // batch is full, publish it and start over, a batch which could not
+    // be published is kept and this sample is published on its own
+    if (!flush())
+      return false;
+    series = getSeries(channel, sensorType);
+    if (series == NULL)
+      return false;
+  }
+
+  uint32_t time = millis();
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  if (series->count == 0) {
+    writeBits(series, time, 32);
+    writeBits(series, bits, 32);
+    series->prvTime = time;
+    series->prvValue = bits;
+  } else {
+    writeTime(series, time);
+    writeValue(series, bits);
+  }
+  series->count++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Encodes every time series as a repeated TimeSeries field. Pins
+            are identified by name, ie: "A0", I2C devices by address.
+    @param  stream
+            The output stream.
+    @param  field
+            The TelemetryBatch series field.
+    @returns  True if encoded successfully, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Batch::encodeSeries(pb_ostream_t *stream,
+                                       const pb_field_t *field) {
+  for (int i = 0; i < _seriesCount; i++) {
+    wippersnapper_signal_v1_TimeSeries msg =
+        wippersnapper_signal_v1_TimeSeries_init_zero;
+    uint16_t channel = _series[i].channel;
+    if (WS_CHANNEL_IS_I2C(channel))
+      msg.i2c_device_address = WS_CHANNEL_ID(channel);
+    else
+      snprintf(msg.pin_name, sizeof(msg.pin_name), "%c%d",
+               WS_CHANNEL_IS_ANALOG(channel) ? 'A' : 'D',
+               WS_CHANNEL_ID(channel));
+    msg.sensor_type = (wippersnapper_i2c_v1_SensorType)_series[i].sensorType;
+    msg.count = _series[i].count;
+    msg.samples.funcs.encode = cbEncodeSamples;
+    msg.samples.arg = &_series[i];
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, wippersnapper_signal_v1_TimeSeries_fields,
+                              &msg))
+      return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the batch once its oldest sample has been held for
+            WS_BATCH_FLUSH_MS.
+*/
+/***********************************************************************************/
+void Wippersnapper_Batch::process() {
+  if (_seriesCount == 0) {
+    _prvFlush = millis();
+    return;
+  }
+  if (millis() - _prvFlush > WS_BATCH_FLUSH_MS)
+    flush();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes every time series as a TelemetryBatch message and
+            empties the batch. A batch which could not be published is
+            kept, and retried after another WS_BATCH_FLUSH_MS.
+    @returns  True if the batch was published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Batch::flush() {
+  _prvFlush = millis();
+  if (_seriesCount == 0)
+    return true;
+
+  wippersnapper_signal_v1_TelemetryBatch msg =
+      wippersnapper_signal_v1_TelemetryBatch_init_zero;
+  msg.series.funcs.encode = cbEncodeSeries;
+  msg.series.arg = this;
+  msg.device_time = millis();
+
+  WS_DEBUG_PRINT("Publishing telemetry batch of ");
+  WS_DEBUG_PRINT(_seriesCount);
+  WS_DEBUG_PRINTLN(" series...");
+  // Batches larger than the outgoing buffer are published in chunks
+  bool is_success =
+      WS.queuePublish(WS._topic_signal_batch_device,
+                      wippersnapper_signal_v1_TelemetryBatch_fields, &msg,
+                      WS_MSG_CLASS_TELEMETRY);
+  if (!is_success) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to publish telemetry batch");
+    return false;
+  }
+  _seriesCount = 0;
+  return true;
+}
@@ -0,0 +1,96 @@
+/*!
+ * @file Wippersnapper_Batch.h
+ *
+ * Collects periodic telemetry samples into compressed time series and
+ * publishes them as a single batched message.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_BATCH_H
+#define WIPPERSNAPPER_BATCH_H
+
+#include "Wippersnapper.h"
+#include <ArduinoJson.h>
+
+#ifndef WS_BATCH_MAX_CHANNELS
+#define WS_BATCH_MAX_CHANNELS 8 ///< Maximum number of batched channels
+#endif
+#ifndef WS_BATCH_MAX_SERIES
+#define WS_BATCH_MAX_SERIES                                                    \
+  WS_BATCH_MAX_CHANNELS ///< Maximum number of time series held within a batch
+#endif
+// every batched channel needs a series of its own
+#if WS_BATCH_MAX_SERIES < WS_BATCH_MAX_CHANNELS
+#error "WS_BATCH_MAX_SERIES must be at least WS_BATCH_MAX_CHANNELS"
+#endif
+#ifndef WS_BATCH_SERIES_SIZE
+#define WS_BATCH_SERIES_SIZE                                                   \
+  96 ///< Compressed sample storage of each time series, in bytes
+#endif
+#define WS_BATCH_FLUSH_MS                                                      \
+  60000 ///< Longest time a sample is held before publishing, in milliseconds
+#define WS_BATCH_MAX_SAMPLE_BITS                                               \
+  80 ///< Worst-case size of a single compressed sample, in bits
+
+/** Compressed samples of a single channel and sensor type */
+struct batchSeries {
+  uint16_t channel;    ///< Channel identifier, WS_CHANNEL_*
+  uint8_t sensorType;  ///< Sensor type of the samples
+  uint16_t count;      ///< Number of samples within the series
+  uint32_t prvTime;    ///< Timestamp of the previous sample, in millis
+  int32_t prvDelta;    ///< Time between the previous two samples
+  uint32_t prvValue;   ///< Bits of the previous sample's value
+  uint8_t prvLeading;  ///< Leading zeros of the previous XOR window
+  uint8_t prvTrailing; ///< Trailing zeros of the previous XOR window
+  uint16_t bitLen;     ///< Number of bits written to data
+  uint8_t data[WS_BATCH_SERIES_SIZE]; ///< Compressed samples
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that compresses periodic telemetry into per-channel time
+            series, using delta-of-delta timestamps and XOR'd float
+            values, and publishes them as a single TelemetryBatch
+            message, in chunks if it exceeds the outgoing buffer.
+*/
+/**************************************************************************/
+class Wippersnapper_Batch {
+public:
+  Wippersnapper_Batch();
+  ~Wippersnapper_Batch();
+
+  bool isBatched(uint16_t channel);
+  bool add(uint16_t channel, uint8_t sensorType, float value);
+  void process();
+  bool flush();
+
+  bool enableChannel(uint16_t channel);
+  void configureBatch(JsonArray channels);
+
+  bool encodeSeries(pb_ostream_t *stream, const pb_field_t *field);
+
+private:
+  batchSeries *getSeries(uint16_t channel, uint8_t sensorType);
+  void writeBits(batchSeries *series, uint32_t value, uint8_t numBits);
+  void writeTime(batchSeries *series, uint32_t time);
+  void writeValue(batchSeries *series, uint32_t value);
+  batchSeries _series[WS_BATCH_MAX_SERIES]; ///< Time series within the batch
+  uint8_t _seriesCount = 0;                 ///< Number of series in use
+  uint16_t _channels[WS_BATCH_MAX_CHANNELS]; ///< Channels which are batched
+  uint8_t _channelCount = 0;                 ///< Number of batched channels
+  long _prvFlush = 0; ///< When the batch was last published, in millis
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_BATCH_H
@@ -0,0 +1,356 @@
+/*!
+ * @file Wippersnapper_Chunking.cpp
+ *
+ * Splits messages larger than WS_MQTT_MAX_PAYLOAD_SIZE into a sequence
+ * of chunks and reassembles chunked messages received from the broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_Chunking.h"
+
+/***********************************************************************************/
+/*!
+    @brief  nanopb output stream callback, collects encoded bytes into
+            chunks.
+    @param  stream
+            The output stream, its state points to the chunking instance.
+    @param  buf
+            Encoded bytes.
+    @param  count
+            Number of encoded bytes.
+    @returns  True if the bytes were written, False otherwise.
+*/
+/***********************************************************************************/
+static bool cbChunkWrite(pb_ostream_t *stream, const pb_byte_t *buf,
+                         size_t count) {
+  return ((Wippersnapper_Chunking *)stream->state)->write(buf, count);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Initializes the reassembly state of each inbound topic.
+*/
+/***********************************************************************************/
+Wippersnapper_Chunking::Wippersnapper_Chunking() {
+  for (int i = 0; i < WS_CHUNK_RX_COUNT; i++) {
+    _rx[i].buf = NULL;
+    release((ws_chunk_rx_t)i);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases any partially reassembled messages.
+*/
+/***********************************************************************************/
+Wippersnapper_Chunking::~Wippersnapper_Chunking() {
+  for (int i = 0; i < WS_CHUNK_RX_COUNT; i++)
+    release((ws_chunk_rx_t)i);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes a chunk header.
+    @param  buf
+            Buffer of at least WS_CHUNK_HEADER_SIZE bytes.
+    @param  msgId
+            Identifier of the message.
+    @param  seq
+            Sequence number of the chunk.
+    @param  count
+            Total number of chunks within the message.
+    @param  len
+            Total length of the message, in bytes.
+*/
+/***********************************************************************************/
+void Wippersnapper_Chunking::writeHeader(uint8_t *buf, uint16_t msgId,
+                                         uint16_t seq, uint16_t count,
+                                         uint16_t len) {
+  buf[0] = WS_CHUNK_MARKER;
+  buf[1] = WS_CHUNK_VERSION;
+  buf[2] = msgId >> 8;
+  buf[3] = msgId & 0xFF;
+  buf[4] = seq >> 8;
+  buf[5] = seq & 0xFF;
+  buf[6] = count >> 8;
+  buf[7] = count & 0xFF;
+  buf[8] = len >> 8;
+  buf[9] = len & 0xFF;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Encodes a protobuf message and publishes it as a sequence of
+            chunks. The message is encoded directly into the shared
+            outgoing buffer one chunk at a time, so it never needs to fit
+            in memory as a whole.
+    @param  topic
+            The MQTT topic to publish to.
+    @param  fields
+            The message's nanopb field descriptor.
+    @param  src_struct
+            The message to encode.
+    @param  qos
+            The MQTT Quality of Service to publish each chunk with.
+    @returns  True if every chunk was published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Chunking::publish(const char *topic,
+                                     const pb_msgdesc_t *fields,
+                                     const void *src_struct, uint8_t qos) {
+  size_t msgSz;
+  if (!pb_get_encoded_size(&msgSz, fields, src_struct) ||
+      msgSz > WS_CHUNK_MAX_TOTAL_SIZE) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to size message for chunking");
+    return false;
+  }
+
+  _txTopic = topic;
+  _txQoS = qos;
+  _txMsgId++;
+  _txSeq = 0;
+  _txCount = (msgSz + WS_CHUNK_DATA_SIZE - 1) / WS_CHUNK_DATA_SIZE;
+  _txLen = msgSz;
+  _txFill = 0;
+  WS_DEBUG_PRINT("Publishing message as ");
+  WS_DEBUG_PRINT(_txCount);
+  WS_DEBUG_PRINTLN(" chunks");
+
+  pb_ostream_t ostream = PB_OSTREAM_SIZING;
+  ostream.callback = &cbChunkWrite;
+  ostream.state = this;
+  ostream.max_size = msgSz;
+  if (!pb_encode(&ostream, fields, src_struct)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode chunked message");
+    return false;
+  }
+  // publish the final, partially filled, chunk
+  if (_txFill > 0)
+    return publishChunk();
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Appends encoded bytes to the chunk being filled, publishing
+            each chunk once full.
+    @param  buf
+            Encoded bytes.
+    @param  count
+            Number of encoded bytes.
+    @returns  True if the bytes were written, False if a chunk failed to
+              publish.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Chunking::write(const pb_byte_t *buf, size_t count) {
+  while (count > 0) {
+    size_t n = min(count, (size_t)(WS_CHUNK_DATA_SIZE - _txFill));
+    memcpy(WS._buffer_outgoing + WS_CHUNK_HEADER_SIZE + _txFill, buf, n);
+    _txFill += n;
+    buf += n;
+    count -= n;
+    if (_txFill == WS_CHUNK_DATA_SIZE && !publishChunk())
+      return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the chunk within the shared outgoing buffer.
+    @returns  True if the chunk was published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Chunking::publishChunk() {
+  writeHeader(WS._buffer_outgoing, _txMsgId, _txSeq, _txCount, _txLen);
+  WS.feedWDT();
+  if (!WS._mqtt->publish(_txTopic, WS._buffer_outgoing,
+                         WS_CHUNK_HEADER_SIZE + _txFill, _txQoS)) {
+    WS_DEBUG_PRINT("ERROR: Unable to publish chunk ");
+    WS_DEBUG_PRINTLN(_txSeq);
+    return false;
+  }
+  _txSeq++;
+  _txFill = 0;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if an inbound payload is a chunk of a larger message.
+    @param  data
+            Payload received from the broker.
+    @param  len
+            Length of the payload, in bytes.
+    @returns  True if the payload carries a chunk header, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Chunking::isChunk(uint8_t *data, uint16_t len) {
+  return len > WS_CHUNK_HEADER_SIZE && data[0] == WS_CHUNK_MARKER &&
+         data[1] == WS_CHUNK_VERSION;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Decodes messages whose first field is a list message as their
+            chunks arrive, instead of reassembling them. Such messages are
+            not limited by WS_CHUNK_MAX_MESSAGE_SIZE, only by the 16-bit
+            total length of the chunk header, WS_CHUNK_MAX_TOTAL_SIZE.
+    @param  rx
+            The inbound topic carrying the list message.
+    @param  tag
+            Field number of the list message within the topic's message.
+    @param  maxElement
+            Largest encoded size of a single list element, in bytes.
+    @param  element
+            Decode callback, called with a stream holding one element.
+    @param  end
+            Called once the message was decoded or abandoned, may be NULL.
+*/
+/***********************************************************************************/
+void Wippersnapper_Chunking::setStream(ws_chunk_rx_t rx, uint32_t tag,
+                                       uint16_t maxElement,
+                                       ws_stream_element_cb element,
+                                       ws_stream_end_cb end) {
+  _streams[rx].configure(tag, maxElement, element, end);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Adds an inbound chunk to the message being reassembled. Chunks
+            must arrive in order, a chunk out of sequence discards the
+            message. Messages starting with the topic's list message are
+            decoded as their chunks arrive, see setStream().
+    @param  rx
+            The inbound topic the chunk was received on.
+    @param  data
+            The chunk, including its header.
+    @param  len
+            Length of the chunk, in bytes.
+    @returns  True once the final chunk of a message was received and the
+              message is available from message(), False otherwise.
+              Always False for streamed messages.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Chunking::receive(ws_chunk_rx_t rx, uint8_t *data,
+                                     uint16_t len) {
+  chunkRx *r = &_rx[rx];
+  uint16_t msgId = (data[2] << 8) | data[3];
+  uint16_t seq = (data[4] << 8) | data[5];
+  uint16_t count = (data[6] << 8) | data[7];
+  uint16_t msgLen = (data[8] << 8) | data[9];
+  uint16_t chunkLen = len - WS_CHUNK_HEADER_SIZE;
+
+  // discard a message whose remaining chunks never arrived
+  if (r->count != 0 && millis() - r->lastRx > WS_CHUNK_RX_TIMEOUT_MS) {
+    WS_DEBUG_PRINTLN("ERROR: Timed out reassembling chunked message");
+    release(rx);
+  }
+
+  if (seq == 0) {
+    release(rx);
+    if (count == 0)
+      return false;
+    if (_streams[rx].accepts(data + WS_CHUNK_HEADER_SIZE, chunkLen)) {
+      WS_DEBUG_PRINTLN("Streaming chunked list message...");
+      if (!_streams[rx].begin())
+        return false;
+      r->streaming = true;
+    } else if (msgLen > WS_CHUNK_MAX_MESSAGE_SIZE) {
+      WS_DEBUG_PRINTLN("ERROR: Chunked message too large to reassemble");
+      return false;
+    } else {
+      r->buf = (uint8_t *)malloc(msgLen);
+      if (r->buf == NULL) {
+        WS_DEBUG_PRINTLN("ERROR: Unable to allocate chunked message");
+        return false;
+      }
+    }
+    r->msgId = msgId;
+    r->count = count;
+    r->len = msgLen;
+  } else if (r->count == 0 || msgId != r->msgId || seq != r->next) {
+    WS_DEBUG_PRINTLN("ERROR: Chunk received out of sequence, discarding");
+    release(rx);
+    return false;
+  }
+
+  if (r->received + chunkLen > r->len) {
+    WS_DEBUG_PRINTLN("ERROR: Chunked message exceeds its declared length");
+    release(rx);
+    return false;
+  }
+  if (r->streaming)
+    _streams[rx].feed(data + WS_CHUNK_HEADER_SIZE, chunkLen);
+  else
+    memcpy(r->buf + r->received, data + WS_CHUNK_HEADER_SIZE, chunkLen);
+  r->received += chunkLen;
+  r->next++;
+  r->lastRx = millis();
+
+  if (r->next < r->count)
+    return false;
+  if (r->received != r->len) {
+    WS_DEBUG_PRINTLN("ERROR: Chunked message is incomplete, discarding");
+    release(rx);
+    return false;
+  }
+  if (r->streaming) {
+    _streams[rx].finish();
+    release(rx);
+    return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns a reassembled message.
+    @param  rx
+            The inbound topic the message was received on.
+    @returns  Pointer to the reassembled message, valid until release().
+*/
+/***********************************************************************************/
+uint8_t *Wippersnapper_Chunking::message(ws_chunk_rx_t rx) {
+  return _rx[rx].buf;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the length of a reassembled message.
+    @param  rx
+            The inbound topic the message was received on.
+    @returns  Length of the reassembled message, in bytes.
+*/
+/***********************************************************************************/
+uint16_t Wippersnapper_Chunking::messageLen(ws_chunk_rx_t rx) {
+  return _rx[rx].received;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Frees a reassembled, or partially reassembled, message.
+    @param  rx
+            The inbound topic the message was received on.
+*/
+/***********************************************************************************/
+void Wippersnapper_Chunking::release(ws_chunk_rx_t rx) {
+  free(_rx[rx].buf);
+  _rx[rx].buf = NULL;
+  _rx[rx].msgId = 0;
+  _rx[rx].next = 0;
+  _rx[rx].count = 0;
+  _rx[rx].len = 0;
+  _rx[rx].received = 0;
+  _rx[rx].lastRx = 0;
+  _rx[rx].streaming = false;
+  _streams[rx].reset();
+}
@@ -0,0 +1,115 @@
+/*!
+ * @file Wippersnapper_Chunking.h
+ *
+ * Splits messages larger than WS_MQTT_MAX_PAYLOAD_SIZE into a sequence
+ * of chunks and reassembles chunked messages received from the broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_CHUNKING_H
+#define WIPPERSNAPPER_CHUNKING_H
+
+#include "Wippersnapper.h"
+#include "Wippersnapper_StreamDecoder.h"
+
+// Each chunk starts with a fixed header, all fields are big-endian:
+// [0]    WS_CHUNK_MARKER, never the first byte of an encoded protobuf
+// [1]    WS_CHUNK_VERSION
+// [2:3]  Message identifier, shared by all chunks of a message
+// [4:5]  Sequence number of this chunk, starting at 0
+// [6:7]  Total number of chunks within the message
+// [8:9]  Total length of the reassembled message, in bytes
+// The 16-bit length caps every chunked message, streamed or reassembled,
+// at WS_CHUNK_MAX_TOTAL_SIZE bytes.
+#define WS_CHUNK_MARKER 0x00    ///< First byte of every chunk
+#define WS_CHUNK_VERSION 0x01   ///< Version of the chunk header
+#define WS_CHUNK_HEADER_SIZE 10 ///< Length of the chunk header, in bytes
+#define WS_CHUNK_SIZE                                                          \
+  WS_MQTT_MAX_PAYLOAD_SIZE ///< Largest chunk published, including header
+#define WS_CHUNK_DATA_SIZE                                                     \
+  (WS_CHUNK_SIZE - WS_CHUNK_HEADER_SIZE) ///< Message bytes within a chunk
+#define WS_CHUNK_MAX_TOTAL_SIZE                                                \
+  0xFFFF ///< Longest message the chunk header can describe, in bytes
+
+#ifndef WS_CHUNK_MAX_MESSAGE_SIZE
+#define WS_CHUNK_MAX_MESSAGE_SIZE                                              \
+  4096 ///< Largest chunked message which may be reassembled, in bytes
+#endif
+#define WS_CHUNK_RX_TIMEOUT_MS                                                 \
+  10000 ///< Time to wait for the next chunk before discarding a message
+
+/** Inbound topics which may carry chunked messages */
+typedef enum {
+  WS_CHUNK_RX_SIGNAL = 0, ///< Signal topic
+  WS_CHUNK_RX_I2C = 1,    ///< I2C signal topic
+  WS_CHUNK_RX_COUNT = 2   ///< Total number of inbound topics
+} ws_chunk_rx_t;
+
+/** Reassembly state of a chunked message */
+struct chunkRx {
+  uint8_t *buf;      ///< Reassembled message, allocated on the first chunk
+  uint16_t msgId;    ///< Identifier of the message being reassembled
+  uint16_t next;     ///< Sequence number of the next expected chunk
+  uint16_t count;    ///< Total number of chunks within the message
+  uint16_t len;      ///< Total length of the message, in bytes
+  uint16_t received; ///< Bytes of the message received so far
+  long lastRx;       ///< When the last chunk was received, in millis
+  bool streaming;    ///< True if the message is decoded as chunks arrive
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that publishes large messages as a sequence of chunks,
+            streaming them through the shared outgoing buffer, and
+            reassembles chunked messages received from the broker.
+*/
+/**************************************************************************/
+class Wippersnapper_Chunking {
+public:
+  Wippersnapper_Chunking();
+  ~Wippersnapper_Chunking();
+
+  // Outbound
+  bool publish(const char *topic, const pb_msgdesc_t *fields,
+               const void *src_struct, uint8_t qos);
+  bool write(const pb_byte_t *buf, size_t count);
+
+  // Inbound
+  static bool isChunk(uint8_t *data, uint16_t len);
+  bool receive(ws_chunk_rx_t rx, uint8_t *data, uint16_t len);
+  uint8_t *message(ws_chunk_rx_t rx);
+  uint16_t messageLen(ws_chunk_rx_t rx);
+  void release(ws_chunk_rx_t rx);
+  void setStream(ws_chunk_rx_t rx, uint32_t tag, uint16_t maxElement,
+                 ws_stream_element_cb element, ws_stream_end_cb end = NULL);
+
+private:
+  bool publishChunk();
+  void writeHeader(uint8_t *buf, uint16_t msgId, uint16_t seq, uint16_t count,
+                   uint16_t len);
+  chunkRx _rx[WS_CHUNK_RX_COUNT]; ///< Reassembly state of each inbound topic
+  Wippersnapper_StreamDecoder
+      _streams[WS_CHUNK_RX_COUNT]; ///< List decoder of each inbound topic
+  // Outbound chunk in progress
+  const char *_txTopic = NULL; ///< Topic the chunked message is published to
+  uint8_t _txQoS = 0;          ///< QoS the chunked message is published with
+  uint16_t _txMsgId = 0;       ///< Identifier of the chunked message
+  uint16_t _txSeq = 0;         ///< Sequence number of the chunk being filled
+  uint16_t _txCount = 0;       ///< Total number of chunks within the message
+  uint16_t _txLen = 0;         ///< Total length of the message, in bytes
+  uint16_t _txFill = 0;        ///< Bytes within the chunk being filled
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_CHUNKING_H
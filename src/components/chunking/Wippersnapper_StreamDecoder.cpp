@@ -0,0 +1,293 @@
+/*!
+ * @file Wippersnapper_StreamDecoder.cpp
+ *
+ * Incrementally decodes the elements of a repeated sub-message list as
+ * the bytes of a chunked message arrive.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_StreamDecoder.h"
+#include "Wippersnapper.h"
+
+/***********************************************************************************/
+/*!
+    @brief  Creates a stream decoder which accepts no messages until
+            configure() is called.
+*/
+/***********************************************************************************/
+Wippersnapper_StreamDecoder::Wippersnapper_StreamDecoder() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Frees the element buffer.
+*/
+/***********************************************************************************/
+Wippersnapper_StreamDecoder::~Wippersnapper_StreamDecoder() { reset(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Sets the list message decoded by this stream.
+    @param  tag
+            Field number of the list message within the top-level message.
+    @param  maxElement
+            Largest encoded size of a single element, in bytes.
+    @param  element
+            Decode callback, called with a stream holding one element.
+    @param  end
+            Called once the message was decoded or abandoned, may be NULL.
+*/
+/***********************************************************************************/
+void Wippersnapper_StreamDecoder::configure(uint32_t tag, uint16_t maxElement,
+                                            ws_stream_element_cb element,
+                                            ws_stream_end_cb end) {
+  _tag = tag;
+  _maxElement = maxElement;
+  _elementCb = element;
+  _endCb = end;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a message starts with the list message.
+    @param  data
+            The first bytes of the message.
+    @param  len
+            Number of bytes within data.
+    @returns  True if the message's first field is the configured list
+              message, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_StreamDecoder::accepts(const uint8_t *data, uint16_t len) {
+  if (_elementCb == NULL)
+    return false;
+  uint32_t key = 0;
+  for (uint8_t i = 0; i < len && i < 5; i++) {
+    key |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+    if (!(data[i] & 0x80))
+      return key == ((_tag << 3) | PB_WT_STRING);
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Prepares to decode a new message.
+    @returns  True if the element buffer was allocated, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_StreamDecoder::begin() {
+  reset();
+  _active = true;
+  _element = (uint8_t *)malloc(_maxElement);
+  if (_element == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to allocate stream element buffer");
+    _state = WS_STREAM_FAILED;
+    return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Parses the next bytes of the message, decoding each element of
+            the list as soon as its last byte arrives.
+    @param  data
+            The next bytes of the message.
+    @param  len
+            Number of bytes within data.
+*/
+/***********************************************************************************/
+void Wippersnapper_StreamDecoder::feed(const uint8_t *data, uint16_t len) {
+  for (uint16_t i = 0; i < len && _state != WS_STREAM_FAILED; i++) {
+    uint8_t b = data[i];
+    bool inList = _inList;
+    if (inList)
+      _listLeft--;
+
+    switch (_state) {
+    case WS_STREAM_KEY:
+      if (readVarint(b))
+        fieldStart();
+      break;
+    case WS_STREAM_LENGTH:
+      if (readVarint(b))
+        fieldLength();
+      break;
+    case WS_STREAM_VARINT:
+      if (!(b & 0x80))
+        _state = WS_STREAM_KEY;
+      break;
+    case WS_STREAM_SKIP:
+      if (--_left == 0)
+        _state = WS_STREAM_KEY;
+      break;
+    case WS_STREAM_ELEMENT:
+      _element[_elementLen++] = b;
+      if (_elementLen == _left) {
+        pb_istream_t stream = pb_istream_from_buffer(_element, _elementLen);
+        if (!_elementCb(&stream, NULL, NULL))
+          WS_DEBUG_PRINTLN("ERROR: Unable to decode streamed list element");
+        _elements++;
+        WS.feedWDT();
+        _state = WS_STREAM_KEY;
+      }
+      break;
+    default:
+      break;
+    }
+
+    // Leaving the list message, every field within it must be complete
+    if (inList && _listLeft == 0) {
+      if (_state != WS_STREAM_KEY || _shift != 0) {
+        WS_DEBUG_PRINTLN("ERROR: Streamed list element exceeds its list");
+        _state = WS_STREAM_FAILED;
+      }
+      _inList = false;
+    }
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Completes decoding once the final byte of the message was fed
+            and reports to the end callback whether every element of the
+            list was decoded.
+    @returns  True if the message was well-formed, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_StreamDecoder::finish() {
+  bool is_success = _state == WS_STREAM_KEY && _shift == 0 && !_inList;
+  if (is_success) {
+    WS_DEBUG_PRINT("Streamed list elements decoded: ");
+    WS_DEBUG_PRINTLN(_elements);
+  } else {
+    WS_DEBUG_PRINTLN("ERROR: Streamed message is malformed or truncated");
+  }
+  _active = false;
+  if (_endCb != NULL)
+    _endCb(is_success);
+  reset();
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Discards any partially decoded message, the end callback is
+            told the list is incomplete.
+*/
+/***********************************************************************************/
+void Wippersnapper_StreamDecoder::reset() {
+  if (_active) {
+    _active = false;
+    if (_endCb != NULL)
+      _endCb(false);
+  }
+  free(_element);
+  _element = NULL;
+  _state = WS_STREAM_KEY;
+  _inList = false;
+  _listLeft = 0;
+  _varint = 0;
+  _shift = 0;
+  _key = 0;
+  _left = 0;
+  _elementLen = 0;
+  _elements = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Adds a byte to the varint being read.
+    @param  b
+            The next byte of the message.
+    @returns  True once the varint is complete and held in _varint,
+              False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_StreamDecoder::readVarint(uint8_t b) {
+  if (_shift == 0)
+    _varint = 0;
+  if (_shift > 28) {
+    _state = WS_STREAM_FAILED;
+    return false;
+  }
+  _varint |= (uint32_t)(b & 0x7F) << _shift;
+  if (b & 0x80) {
+    _shift += 7;
+    return false;
+  }
+  _shift = 0;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Handles a complete field key.
+*/
+/***********************************************************************************/
+void Wippersnapper_StreamDecoder::fieldStart() {
+  _key = _varint;
+  switch (_key & 0x07) {
+  case PB_WT_VARINT:
+    _state = WS_STREAM_VARINT;
+    break;
+  case PB_WT_64BIT:
+    _left = 8;
+    _state = WS_STREAM_SKIP;
+    break;
+  case PB_WT_32BIT:
+    _left = 4;
+    _state = WS_STREAM_SKIP;
+    break;
+  case PB_WT_STRING:
+    _state = WS_STREAM_LENGTH;
+    break;
+  default:
+    WS_DEBUG_PRINTLN("ERROR: Unsupported wire type within streamed message");
+    _state = WS_STREAM_FAILED;
+    break;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Handles the complete length of a length-delimited field.
+            Descends into the list message, starts collecting a list
+            element or skips any other field.
+*/
+/***********************************************************************************/
+void Wippersnapper_StreamDecoder::fieldLength() {
+  uint32_t field = _key >> 3;
+  _left = _varint;
+  _state = WS_STREAM_KEY;
+
+  if (!_inList && field == _tag) {
+    _inList = _left > 0;
+    _listLeft = _left;
+  } else if (_inList && field == 1) {
+    if (_left > _maxElement) {
+      WS_DEBUG_PRINTLN("ERROR: Streamed list element is too large");
+      _state = WS_STREAM_FAILED;
+      return;
+    }
+    _elementLen = 0;
+    if (_left > 0) {
+      _state = WS_STREAM_ELEMENT;
+    } else {
+      // empty element, all fields hold their defaults
+      pb_istream_t stream = pb_istream_from_buffer(_element, 0);
+      _elementCb(&stream, NULL, NULL);
+      _elements++;
+    }
+  } else if (_left > 0) {
+    _state = WS_STREAM_SKIP;
+  }
+}
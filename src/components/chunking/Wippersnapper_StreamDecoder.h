@@ -0,0 +1,85 @@
+/*!
+ * @file Wippersnapper_StreamDecoder.h
+ *
+ * Incrementally decodes the elements of a repeated sub-message list as
+ * the bytes of a chunked message arrive.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_STREAMDECODER_H
+#define WIPPERSNAPPER_STREAMDECODER_H
+
+#include "Arduino.h"
+#include <nanopb/pb_decode.h>
+
+/** Decodes a single list element, matches a nanopb decode callback */
+typedef bool (*ws_stream_element_cb)(pb_istream_t *stream,
+                                     const pb_field_t *field, void **arg);
+/** Called once a list message ends, complete is False if any of its
+ * elements may be missing */
+typedef void (*ws_stream_end_cb)(bool complete);
+
+/** Wire-level parse state */
+typedef enum {
+  WS_STREAM_KEY,     ///< Reading a field key
+  WS_STREAM_LENGTH,  ///< Reading the length of a length-delimited field
+  WS_STREAM_VARINT,  ///< Skipping a varint field
+  WS_STREAM_SKIP,    ///< Skipping a fixed-size or unknown field
+  WS_STREAM_ELEMENT, ///< Collecting a list element
+  WS_STREAM_FAILED   ///< Malformed input, ignore the rest of the message
+} ws_stream_state_t;
+
+/**************************************************************************/
+/*!
+    @brief  Class that parses a message of the form
+            { ListMessage tag = N { repeated Element list = 1; } } one byte
+            at a time. Each element is collected into a buffer sized for
+            a single element and handed to a decode callback as soon as
+            it is complete, so lists are decoded in constant memory.
+            Lists arrive over the chunking layer, whose 16-bit total
+            length caps a message at WS_CHUNK_MAX_TOTAL_SIZE bytes.
+*/
+/**************************************************************************/
+class Wippersnapper_StreamDecoder {
+public:
+  Wippersnapper_StreamDecoder();
+  ~Wippersnapper_StreamDecoder();
+
+  void configure(uint32_t tag, uint16_t maxElement,
+                 ws_stream_element_cb element, ws_stream_end_cb end);
+  bool accepts(const uint8_t *data, uint16_t len);
+  bool begin();
+  void feed(const uint8_t *data, uint16_t len);
+  bool finish();
+  void reset();
+
+private:
+  bool readVarint(uint8_t b);
+  void fieldStart();
+  void fieldLength();
+  uint32_t _tag = 0;                        ///< Field number of the list
+  uint16_t _maxElement = 0;                 ///< Largest element, in bytes
+  ws_stream_element_cb _elementCb = NULL;   ///< Decodes each element
+  ws_stream_end_cb _endCb = NULL;           ///< Called after the last element
+  bool _active = false;                     ///< True while decoding a message
+  ws_stream_state_t _state = WS_STREAM_KEY; ///< Current parse state
+  bool _inList = false;                     ///< True while inside the list
+  uint32_t _listLeft = 0;                   ///< Bytes of the list left to parse
+  uint32_t _varint = 0;                     ///< Varint being read
+  uint8_t _shift = 0;                       ///< Shift of the next varint group
+  uint32_t _key = 0;                        ///< Key of the field being parsed
+  uint32_t _left = 0;                       ///< Bytes of the field left
+  uint8_t *_element = NULL;                 ///< Element being collected
+  uint16_t _elementLen = 0;                 ///< Bytes of the element collected
+  uint16_t _elements = 0;                   ///< Elements decoded from the list
+};
+
+#endif // WIPPERSNAPPER_STREAMDECODER_H
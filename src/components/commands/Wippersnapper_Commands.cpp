@@ -0,0 +1,464 @@
+/*!
+ * @file Wippersnapper_Commands.cpp
+ *
+ * Bounded queue of commands received from the Adafruit IO MQTT broker,
+ * executed outside of the MQTT callbacks.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_Commands.h"
+
+/** Names of each command type, as printed with the latency statistics */
+static const char *cmdTypeNames[WS_CMD_TYPE_COUNT] = {
+    "pin config list",   "pin events",        "i2c scan",
+    "i2c device init",   "i2c device update", "i2c device deinit",
+    "list",              "read values",       "pwm config",
+    "pwm event",         "pulse capture",     "logic capture"};
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the message decoded into the commands of a list.
+    @param  type
+            The command type of the list's requests.
+    @returns  The request's nanopb field descriptor, NULL if the command
+              type is never staged as a list.
+*/
+/***********************************************************************************/
+static const pb_msgdesc_t *listRequestFields(ws_cmd_type_t type) {
+  switch (type) {
+  case WS_CMD_I2C_DEVICE_INIT:
+    return wippersnapper_i2c_v1_I2CDeviceInitRequest_fields;
+  case WS_CMD_PWM_CONFIG:
+    return wippersnapper_pin_v1_ConfigurePWMPinRequest_fields;
+  case WS_CMD_PWM_EVENT:
+    return wippersnapper_pin_v1_PWMPinEvent_fields;
+  case WS_CMD_PULSE_CAPTURE_CONFIG:
+    return wippersnapper_pin_v1_ConfigurePulseCaptureRequest_fields;
+  default:
+    return NULL;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Allocates the command queue.
+*/
+/***********************************************************************************/
+Wippersnapper_Commands::Wippersnapper_Commands() {
+  _slots = new wsCommand[WS_COMMAND_QUEUE_DEPTH];
+  memset(_latency, 0, sizeof(_latency));
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases the command queue.
+*/
+/***********************************************************************************/
+Wippersnapper_Commands::~Wippersnapper_Commands() {
+  delete[] _slots;
+  _count = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Reserves the next free slot so a request can be decoded straight
+            into it. The slot is only queued once commit() is called.
+            Commands are never executed from here, inbound packets are
+            only read while accepting() so the queue rarely fills.
+    @param  type
+            Type of the command which will be decoded into the slot.
+    @returns  Pointer to the reserved command, zeroed. NULL if the queue
+              is full and the command must be dropped.
+*/
+/***********************************************************************************/
+wsCommand *Wippersnapper_Commands::reserve(ws_cmd_type_t type) {
+  if (_count == WS_COMMAND_QUEUE_DEPTH) {
+    WS_DEBUG_PRINTLN("ERROR: Command queue full, dropping command");
+    _overflow++;
+    return NULL;
+  }
+  wsCommand *cmd = &_slots[(_head + _count) % WS_COMMAND_QUEUE_DEPTH];
+  memset(cmd, 0, sizeof(wsCommand));
+  cmd->type = type;
+  cmd->rxTime = _rxTime;
+  return cmd;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Queues the command previously returned by reserve().
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::commit() {
+  _slots[(_head + _count) % WS_COMMAND_QUEUE_DEPTH].decodedTime = micros();
+  _count++;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Queues a staged list of requests as a single command. An
+            empty list is queued too, it still ends an I2C device list.
+    @param  list
+            The staged list, its requests are owned by the queue once
+            queued and discarded otherwise.
+    @returns  True if the list was queued, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::commitList(wsCommandList *list) {
+  wsCommand *cmd = reserve(WS_CMD_LIST);
+  if (cmd == NULL) {
+    discard(list);
+    return false;
+  }
+  cmd->msg.list = *list;
+  commit();
+  list->buf = NULL;
+  list->len = 0;
+  list->pos = 0;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Appends an encoded request to a staged list. Called from the
+            decode callback of a repeated field, the request is copied as
+            it is and only decoded once executed.
+    @param  list
+            The staged list.
+    @param  type
+            The command type of the request.
+    @param  stream
+            Input stream holding the request.
+    @returns  True if the request was staged, False if the list would
+              exceed WS_COMMAND_LIST_MAX_SIZE or could not be allocated.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::stage(wsCommandList *list, ws_cmd_type_t type,
+                                   pb_istream_t *stream) {
+  if (list->len > 0 && list->type != type) {
+    WS_DEBUG_PRINTLN("ERROR: Staged list mixes command types");
+    return false;
+  }
+  size_t reqLen = stream->bytes_left;
+  if (list->len + 2 + reqLen > WS_COMMAND_LIST_MAX_SIZE) {
+    WS_DEBUG_PRINTLN("ERROR: Staged list exceeds WS_COMMAND_LIST_MAX_SIZE");
+    return false;
+  }
+  uint8_t *buf = (uint8_t *)realloc(list->buf, list->len + 2 + reqLen);
+  if (buf == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to allocate staged list");
+    return false;
+  }
+  list->buf = buf;
+  list->type = type;
+  buf[list->len] = reqLen >> 8;
+  buf[list->len + 1] = reqLen & 0xFF;
+  if (!pb_read(stream, buf + list->len + 2, reqLen))
+    return false;
+  list->len += 2 + reqLen;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Frees a staged list which will not be queued.
+    @param  list
+            The staged list.
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::discard(wsCommandList *list) {
+  free(list->buf);
+  list->buf = NULL;
+  list->len = 0;
+  list->pos = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Executes queued commands, oldest first, until the queue is empty
+            or the time budget is spent. At least one command is executed
+            per call so the queue always makes progress.
+    @param  budgetMs
+            Time which may be spent executing commands, in milliseconds.
+    @returns  True if all queued commands executed successfully, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::process(uint32_t budgetMs) {
+  if (millis() - _prvStats > WS_COMMAND_STATS_INTERVAL_MS) {
+    printStats();
+    _prvStats = millis();
+  }
+
+  bool is_success = true;
+  uint32_t start = millis();
+  while (_count > 0) {
+    if (!executeNext())
+      is_success = false;
+    WS.feedWDT();
+    if (millis() - start >= budgetMs)
+      break;
+  }
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Executes every queued command, regardless of the time budget.
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::flush() {
+  while (_count > 0) {
+    executeNext();
+    WS.feedWDT();
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of commands waiting to be executed.
+    @returns  Number of queued commands.
+*/
+/***********************************************************************************/
+uint8_t Wippersnapper_Commands::queued() { return _count; }
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if inbound packets may be read. Each packet queues at
+            most one command, lists are staged into one, so reading stops
+            while fewer than WS_COMMAND_RX_HEADROOM slots are free and the
+            broker's packets wait within the network stack instead.
+    @returns  True if the queue has room for inbound commands, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::accepting() {
+  return WS_COMMAND_QUEUE_DEPTH - _count >= WS_COMMAND_RX_HEADROOM;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Marks the arrival of a message carrying commands. Must be
+            called first thing within the MQTT callbacks, every command
+            decoded from the message is timestamped with its arrival.
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::received() { _rxTime = micros(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the time elapsed since the executing command's message
+            arrived, so responses can echo the device-side latency.
+    @returns  Latency of the executing command in microseconds, 0 if no
+              command is executing.
+*/
+/***********************************************************************************/
+uint32_t Wippersnapper_Commands::latency() {
+  if (_execRxTime == 0)
+    return 0;
+  return micros() - _execRxTime;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Prints the latency statistics of each command type executed:
+            the average time spent decoding, queued and executing, the
+            largest receipt-to-actuation latency and its histogram.
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::printStats() {
+  WS_DEBUG_PRINT("Command latency (count: avg decode/queued/exec, max us), ");
+  WS_DEBUG_PRINT(_overflow);
+  WS_DEBUG_PRINTLN(" queue overflows:");
+  for (int i = 0; i < WS_CMD_TYPE_COUNT; i++) {
+    wsCmdLatency *stats = &_latency[i];
+    if (stats->count == 0)
+      continue;
+    WS_DEBUG_PRINT("\t");
+    WS_DEBUG_PRINT(cmdTypeNames[i]);
+    WS_DEBUG_PRINT(" (");
+    WS_DEBUG_PRINT(stats->count);
+    WS_DEBUG_PRINT("): ");
+    WS_DEBUG_PRINT((uint32_t)(stats->decodeUs / stats->count));
+    WS_DEBUG_PRINT("/");
+    WS_DEBUG_PRINT((uint32_t)(stats->waitUs / stats->count));
+    WS_DEBUG_PRINT("/");
+    WS_DEBUG_PRINT((uint32_t)(stats->execUs / stats->count));
+    WS_DEBUG_PRINT(", max ");
+    WS_DEBUG_PRINTLN(stats->max);
+    // bucket i holds latencies under 256us << i, the last one all others
+    WS_DEBUG_PRINT("\t  histogram (<256us, x2 per bucket):");
+    for (int b = 0; b < WS_COMMAND_LATENCY_BUCKETS; b++) {
+      WS_DEBUG_PRINT(" ");
+      WS_DEBUG_PRINT(stats->histogram[b]);
+    }
+    WS_DEBUG_PRINTLN("");
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes the oldest command from the queue and executes it. A
+            list executes one of its requests per call, and stays at the
+            head of the queue until its last request.
+    @returns  True if the command executed successfully, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::executeNext() {
+  if (_count == 0)
+    return true;
+  // execute a copy and release the slot first, execution may publish and
+  // process inbound packets, queueing new commands
+  wsCommand cmd;
+  wsCommand *head = &_slots[_head];
+  bool is_success = true;
+  bool listEnded = false;
+  ws_cmd_type_t listType = WS_CMD_LIST;
+  if (head->type == WS_CMD_LIST) {
+    listType = head->msg.list.type;
+    if (head->msg.list.pos < head->msg.list.len)
+      is_success = nextListRequest(head, &cmd);
+    else
+      cmd.type = WS_CMD_LIST; // empty list, nothing to execute
+    if (head->msg.list.pos >= head->msg.list.len) {
+      discard(&head->msg.list);
+      _head = (_head + 1) % WS_COMMAND_QUEUE_DEPTH;
+      _count--;
+      listEnded = true;
+    }
+  } else {
+    memcpy(&cmd, head, sizeof(wsCommand));
+    _head = (_head + 1) % WS_COMMAND_QUEUE_DEPTH;
+    _count--;
+  }
+
+  if (is_success && cmd.type != WS_CMD_LIST) {
+    // commands may be executed from within another command's execution
+    uint32_t prvExecRxTime = _execRxTime;
+    _execRxTime = cmd.rxTime;
+    uint32_t startTime = micros();
+    is_success = execute(&cmd);
+    uint32_t endTime = micros();
+    _execRxTime = prvExecRxTime;
+    recordLatency(cmd.type, cmd.rxTime, cmd.decodedTime, startTime, endTime);
+  }
+
+  // the I2C device list sent by the broker holds every configured device
+  if (listEnded && listType == WS_CMD_I2C_DEVICE_INIT)
+    WS._configCache->endSync(WS_CACHE_REC_I2C_DEVICE);
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Decodes the next request of a queued list.
+    @param  listCmd
+            The queued WS_CMD_LIST command, its position is advanced.
+    @param  cmd
+            The command to decode the request into.
+    @returns  True if the request was decoded, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::nextListRequest(wsCommand *listCmd,
+                                             wsCommand *cmd) {
+  wsCommandList *list = &listCmd->msg.list;
+  memset(cmd, 0, sizeof(wsCommand));
+  cmd->type = list->type;
+  cmd->rxTime = listCmd->rxTime;
+  cmd->decodedTime = listCmd->decodedTime;
+
+  uint16_t reqLen = (list->buf[list->pos] << 8) | list->buf[list->pos + 1];
+  pb_istream_t stream = pb_istream_from_buffer(list->buf + list->pos + 2,
+                                               reqLen);
+  list->pos += 2 + reqLen;
+  const pb_msgdesc_t *fields = listRequestFields(list->type);
+  if (fields == NULL || !pb_decode(&stream, fields, &cmd->msg)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to decode request of a staged list");
+    return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Executes a single command.
+    @param  cmd
+            The command to execute.
+    @returns  True if the command executed successfully, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Commands::execute(wsCommand *cmd) {
+  switch (cmd->type) {
+  case WS_CMD_PIN_CONFIG_LIST:
+    return WS.pinConfigListRequest(cmd->msg.pinConfigList);
+  case WS_CMD_PIN_EVENTS:
+    return WS.pinEventsRequest(&cmd->msg.pinWrites);
+  case WS_CMD_I2C_SCAN:
+    return WS.i2cScanRequest(&cmd->msg.i2cScan);
+  case WS_CMD_I2C_DEVICE_INIT:
+    return WS.i2cDeviceInitRequest(&cmd->msg.i2cDeviceInit);
+  case WS_CMD_I2C_DEVICE_UPDATE:
+    return WS.i2cDeviceUpdateRequest(&cmd->msg.i2cDeviceUpdate);
+  case WS_CMD_I2C_DEVICE_DEINIT:
+    return WS.i2cDeviceDeinitRequest(&cmd->msg.i2cDeviceDeinit);
+  case WS_CMD_READ_VALUES:
+    return WS._lastValue->readValuesRequest(&cmd->msg.readValues);
+  case WS_CMD_PWM_CONFIG:
+    return WS.pwmConfigRequest(&cmd->msg.pwmConfig);
+  case WS_CMD_PWM_EVENT:
+    return WS.pwmEventRequest(&cmd->msg.pwmEvent);
+  case WS_CMD_PULSE_CAPTURE_CONFIG:
+    return WS.pulseCaptureConfigRequest(&cmd->msg.pulseCaptureConfig);
+  case WS_CMD_LOGIC_CAPTURE:
+    return WS._logicCapture->captureRequest(&cmd->msg.logicCapture);
+  default:
+    WS_DEBUG_PRINTLN("ERROR: Unknown command type");
+    return false;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Adds an executed command to its type's latency statistics.
+    @param  type
+            Type of the executed command.
+    @param  rxTime
+            When the command's message arrived, in micros.
+    @param  decodedTime
+            When the command was decoded and queued, in micros.
+    @param  startTime
+            When the command's execution started, in micros.
+    @param  endTime
+            When the command was actuated, in micros.
+*/
+/***********************************************************************************/
+void Wippersnapper_Commands::recordLatency(ws_cmd_type_t type, uint32_t rxTime,
+                                           uint32_t decodedTime,
+                                           uint32_t startTime,
+                                           uint32_t endTime) {
+  if (type >= WS_CMD_TYPE_COUNT)
+    return;
+  wsCmdLatency *stats = &_latency[type];
+  uint32_t total = endTime - rxTime;
+  stats->count++;
+  stats->decodeUs += decodedTime - rxTime;
+  stats->waitUs += startTime - decodedTime;
+  stats->execUs += endTime - startTime;
+  if (total > stats->max)
+    stats->max = total;
+
+  uint8_t bucket = 0;
+  while (bucket < WS_COMMAND_LATENCY_BUCKETS - 1 &&
+         total >= (256UL << bucket))
+    bucket++;
+  if (stats->histogram[bucket] < UINT16_MAX)
+    stats->histogram[bucket]++;
+}
@@ -0,0 +1,167 @@
+/*!
+ * @file Wippersnapper_Commands.h
+ *
+ * Bounded queue of commands received from the Adafruit IO MQTT broker,
+ * executed outside of the MQTT callbacks.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_COMMANDS_H
+#define WIPPERSNAPPER_COMMANDS_H
+
+#include <stdint.h>
+
+// Wippersnapper.h holds the staged I2C device list, it needs these first
+/** Type of a queued command */
+typedef enum {
+  WS_CMD_PIN_CONFIG_LIST,      ///< Apply a list of pin configurations
+  WS_CMD_PIN_EVENTS,           ///< Write values to digital outputs at once
+  WS_CMD_I2C_SCAN,             ///< Scan an I2C bus
+  WS_CMD_I2C_DEVICE_INIT,      ///< Initialize an I2C device
+  WS_CMD_I2C_DEVICE_UPDATE,    ///< Update an I2C device's properties
+  WS_CMD_I2C_DEVICE_DEINIT,    ///< Deinitialize an I2C device
+  WS_CMD_LIST,                 ///< Execute a staged list of requests
+  WS_CMD_READ_VALUES,          ///< Publish the current value of channels
+  WS_CMD_PWM_CONFIG,           ///< Configure a PWM output
+  WS_CMD_PWM_EVENT,            ///< Change the duty cycle of a PWM output
+  WS_CMD_PULSE_CAPTURE_CONFIG, ///< Configure a pulse capture input
+  WS_CMD_LOGIC_CAPTURE,        ///< Capture the levels of digital pins
+} ws_cmd_type_t;
+#define WS_CMD_TYPE_COUNT 12 ///< Total number of command types
+
+/** Encoded requests of a list, staged so the whole list is executed by a
+ * single queued command */
+struct wsCommandList {
+  ws_cmd_type_t type; ///< Command type of every request within the list
+  uint8_t *buf;       ///< Encoded requests, each prefixed by its length
+  uint16_t len;       ///< Bytes of buf holding requests
+  uint16_t pos;       ///< Offset of the next request to execute
+};
+
+#include "Wippersnapper.h"
+
+#ifndef WS_COMMAND_QUEUE_DEPTH
+#define WS_COMMAND_QUEUE_DEPTH 6 ///< Maximum number of queued commands
+#endif
+#ifndef WS_COMMAND_RX_HEADROOM
+#define WS_COMMAND_RX_HEADROOM                                                 \
+  2 ///< Free slots required before inbound packets are read
+#endif
+#ifndef WS_COMMAND_LIST_MAX_SIZE
+#define WS_COMMAND_LIST_MAX_SIZE                                               \
+  4096 ///< Largest staged list of encoded requests, in bytes
+#endif
+#ifndef WS_COMMAND_TICK_BUDGET_MS
+#define WS_COMMAND_TICK_BUDGET_MS                                              \
+  50 ///< Time spent executing commands per call to process(), in milliseconds
+#endif
+#ifndef WS_COMMAND_ECHO_LATENCY
+#define WS_COMMAND_ECHO_LATENCY                                                \
+  0 ///< Set to 1 to echo the device-side latency within I2C responses
+#endif
+#define WS_COMMAND_LATENCY_BUCKETS                                             \
+  14 ///< Latency histogram buckets, the first holds latencies under
+     ///< 256us and each following bucket doubles the bound
+#define WS_COMMAND_STATS_INTERVAL_MS                                           \
+  300000 ///< Time between printing latency statistics, in milliseconds
+
+// forward decl.
+class Wippersnapper_PinConfig;
+
+/** A decoded command waiting to be executed */
+struct wsCommand {
+  ws_cmd_type_t type;   ///< Type of the command, selects the union member
+  uint32_t rxTime;      ///< When the carrying message arrived, in micros
+  uint32_t decodedTime; ///< When the command was decoded, in micros
+  /** Decoded request message */
+  union {
+    Wippersnapper_PinConfig
+        *pinConfigList; ///< WS_CMD_PIN_CONFIG_LIST, owned by the command
+    digitalPinWrites pinWrites;                     ///< WS_CMD_PIN_EVENTS
+    wippersnapper_i2c_v1_I2CBusScanRequest i2cScan; ///< WS_CMD_I2C_SCAN
+    wippersnapper_i2c_v1_I2CDeviceInitRequest
+        i2cDeviceInit; ///< WS_CMD_I2C_DEVICE_INIT
+    wippersnapper_i2c_v1_I2CDeviceUpdateRequest
+        i2cDeviceUpdate; ///< WS_CMD_I2C_DEVICE_UPDATE
+    wippersnapper_i2c_v1_I2CDeviceDeinitRequest
+        i2cDeviceDeinit; ///< WS_CMD_I2C_DEVICE_DEINIT
+    wippersnapper_signal_v1_ReadValuesRequest
+        readValues; ///< WS_CMD_READ_VALUES
+    wippersnapper_pin_v1_ConfigurePWMPinRequest
+        pwmConfig; ///< WS_CMD_PWM_CONFIG
+    wippersnapper_pin_v1_PWMPinEvent pwmEvent; ///< WS_CMD_PWM_EVENT
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest
+        pulseCaptureConfig; ///< WS_CMD_PULSE_CAPTURE_CONFIG
+    wippersnapper_pin_v1_LogicCaptureRequest
+        logicCapture;   ///< WS_CMD_LOGIC_CAPTURE
+    wsCommandList list; ///< WS_CMD_LIST, buf owned by the command
+  } msg;
+};
+
+/** Latency statistics of a single command type, in microseconds */
+struct wsCmdLatency {
+  uint32_t count;    ///< Number of executed commands
+  uint32_t max;      ///< Largest receipt-to-actuation latency
+  uint64_t decodeUs; ///< Sum of receipt-to-decode times
+  uint64_t waitUs;   ///< Sum of times spent queued
+  uint64_t execUs;   ///< Sum of execution times
+  uint16_t histogram[WS_COMMAND_LATENCY_BUCKETS]; ///< Receipt-to-actuation
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that holds commands decoded by the MQTT callbacks and
+            executes them from the main loop within a time budget. Lists
+            of requests are staged into a single command, inbound packets
+            are only read while the queue has room for their commands.
+*/
+/**************************************************************************/
+class Wippersnapper_Commands {
+public:
+  Wippersnapper_Commands();
+  ~Wippersnapper_Commands();
+
+  wsCommand *reserve(ws_cmd_type_t type);
+  void commit();
+  bool commitList(wsCommandList *list);
+  static bool stage(wsCommandList *list, ws_cmd_type_t type,
+                    pb_istream_t *stream);
+  static void discard(wsCommandList *list);
+  bool process(uint32_t budgetMs = WS_COMMAND_TICK_BUDGET_MS);
+  void flush();
+  uint8_t queued();
+  bool accepting();
+
+  void received();
+  uint32_t latency();
+  void printStats();
+
+private:
+  bool executeNext();
+  bool nextListRequest(wsCommand *listCmd, wsCommand *cmd);
+  bool execute(wsCommand *cmd);
+  void recordLatency(ws_cmd_type_t type, uint32_t rxTime, uint32_t decodedTime,
+                     uint32_t startTime, uint32_t endTime);
+  wsCommand *_slots;        ///< Storage for queued commands
+  uint8_t _head = 0;        ///< Index of the oldest queued command
+  uint8_t _count = 0;       ///< Number of queued commands
+  uint32_t _overflow = 0;   ///< Commands dropped because the queue was full
+  uint32_t _rxTime = 0;     ///< Arrival of the last command message, in micros
+  uint32_t _execRxTime = 0; ///< Arrival of the executing command, 0 if idle
+  uint32_t _prvStats = 0;   ///< Last time the latency statistics were printed
+  wsCmdLatency _latency[WS_CMD_TYPE_COUNT]; ///< Statistics per command type
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_COMMANDS_H
@@ -0,0 +1,756 @@
+/*!
+ * @file Wippersnapper_ConfigCache.cpp
+ *
+ * Persists the configuration applied by the broker to the filesystem so
+ * it can be applied again immediately after a reset.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_ConfigCache.h"
+
+/***********************************************************************************/
+/*!
+    @brief  nanopb output stream callback, compares encoded bytes with a
+            cached record instead of storing them.
+    @param  stream
+            The output stream, its state points to the record's data.
+    @param  buf
+            Encoded bytes.
+    @param  count
+            Number of encoded bytes.
+    @returns  True if the bytes match the record, False otherwise.
+*/
+/***********************************************************************************/
+static bool cbCompareRecord(pb_ostream_t *stream, const pb_byte_t *buf,
+                            size_t count) {
+  const uint8_t *data = (const uint8_t *)stream->state;
+  return memcmp(data + stream->bytes_written, buf, count) == 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Creates an empty configuration cache.
+*/
+/***********************************************************************************/
+Wippersnapper_ConfigCache::Wippersnapper_ConfigCache() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Frees all cached records.
+*/
+/***********************************************************************************/
+Wippersnapper_ConfigCache::~Wippersnapper_ConfigCache() { clear(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Reads the cache file saved by a previous boot and applies the
+            configuration within it.
+    @returns  True if a cached configuration was applied, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::load() {
+  size_t len = 0;
+  uint8_t *buf = NULL;
+#ifdef USE_TINYUSB
+  buf = WS._fileSystem->readBinaryFile(WS_CONFIG_CACHE_FILE, &len);
+#elif defined(USE_LITTLEFS)
+  buf = WS._littleFS->readBinaryFile(WS_CONFIG_CACHE_FILE, &len);
+#endif
+  if (buf == NULL) {
+    WS_DEBUG_PRINTLN("No configuration cache found, cold start.");
+    return false;
+  }
+
+  bool is_success = parse(buf, len);
+  free(buf);
+  if (!is_success) {
+    WS_DEBUG_PRINTLN("ERROR: Configuration cache is invalid, discarding it");
+    clear();
+    return false;
+  }
+  if (find(WS_CACHE_REC_REGISTRATION, 0) == NULL) {
+    clear();
+    return false;
+  }
+
+  WS_DEBUG_PRINT("Applying cached configuration, records: ");
+  WS_DEBUG_PRINTLN(_records.size());
+  replay();
+  _warm = true;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns if the configuration was applied from the cache.
+    @returns  True if the cached configuration was applied, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::warm() { return _warm; }
+
+/***********************************************************************************/
+/*!
+    @brief  Returns if configuration is being applied by the cache rather
+            than by the broker. Responses to the broker are not sent
+            while replaying.
+    @returns  True while replaying, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::replaying() { return _replaying; }
+
+/***********************************************************************************/
+/*!
+    @brief  Saves the cache once the configuration stopped changing for
+            WS_CONFIG_CACHE_SAVE_DELAY_MS, so a burst of configuration
+            messages is written to flash once. A failed save is retried,
+            doubling the delay each time up to
+            WS_CONFIG_CACHE_SAVE_MAX_DELAY_MS. Also ends the sync of any
+            list the broker did not send within WS_CONFIG_CACHE_SYNC_TIMEOUT_MS
+            of registering.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::process() {
+  if (_syncPending &&
+      millis() - _syncStart >= WS_CONFIG_CACHE_SYNC_TIMEOUT_MS) {
+    // the broker may send no list at all, e.g. when it holds no devices
+    for (uint8_t type = WS_CACHE_REC_PIN_CONFIG;
+         type <= WS_CACHE_REC_I2C_DEVICE; type++) {
+      if (_syncPending & (1 << type)) {
+        WS_DEBUG_PRINT("Configuration list not received, type: ");
+        WS_DEBUG_PRINTLN(type);
+        endSync((ws_cache_rec_t)type);
+      }
+    }
+  }
+
+  if (!_dirty || millis() - _changed < _saveDelay)
+    return;
+  if (save()) {
+    _dirty = false;
+    _saveDelay = WS_CONFIG_CACHE_SAVE_DELAY_MS;
+    return;
+  }
+  // keep the records dirty and back off, the filesystem may be busy or full
+  _changed = millis();
+  _saveDelay = min(_saveDelay * 2, (uint32_t)WS_CONFIG_CACHE_SAVE_MAX_DELAY_MS);
+  WS_DEBUG_PRINT("ERROR: Unable to save configuration cache, retrying in ms: ");
+  WS_DEBUG_PRINTLN(_saveDelay);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes every record to the cache file.
+    @returns  True if the file was written, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::save() {
+  size_t len = 5 + 5; // header, END record
+  for (size_t i = 0; i < _records.size(); i++)
+    len += 5 + _records[i].len;
+  uint8_t *buf = (uint8_t *)malloc(len);
+  if (buf == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to allocate configuration cache buffer");
+    return false;
+  }
+
+  memcpy(buf, "WSCC", 4);
+  buf[4] = WS_CONFIG_CACHE_VERSION;
+  size_t pos = 5;
+  // registration first, components must exist before pins are replayed
+  for (uint8_t type = WS_CACHE_REC_REGISTRATION;
+       type <= WS_CACHE_REC_I2C_DEVICE; type++) {
+    for (size_t i = 0; i < _records.size(); i++) {
+      cacheRecord *rec = &_records[i];
+      if (rec->type != type)
+        continue;
+      buf[pos++] = rec->type;
+      buf[pos++] = rec->key & 0xFF;
+      buf[pos++] = rec->key >> 8;
+      buf[pos++] = rec->len & 0xFF;
+      buf[pos++] = rec->len >> 8;
+      memcpy(buf + pos, rec->data, rec->len);
+      pos += rec->len;
+    }
+  }
+  uint32_t crc = crc32(0, buf, pos);
+  buf[pos++] = WS_CACHE_REC_END;
+  for (uint8_t i = 0; i < 4; i++)
+    buf[pos++] = (crc >> (8 * i)) & 0xFF;
+
+  bool is_success = false;
+#ifdef USE_TINYUSB
+  is_success = WS._fileSystem->writeBinaryFile(WS_CONFIG_CACHE_FILE, buf, pos);
+#elif defined(USE_LITTLEFS)
+  is_success = WS._littleFS->writeBinaryFile(WS_CONFIG_CACHE_FILE, buf, pos);
+#endif
+  free(buf);
+  if (is_success) {
+    WS_DEBUG_PRINT("Saved configuration cache, bytes: ");
+    WS_DEBUG_PRINTLN(pos);
+  }
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Records the registration response and starts reconciling the
+            cached pins and devices with the configuration the broker
+            sends next.
+    @param  msgResponse
+            The registration response received from the broker.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::registered(
+    wippersnapper_description_v1_CreateDescriptionResponse *msgResponse) {
+  put(WS_CACHE_REC_REGISTRATION, 0,
+      wippersnapper_description_v1_CreateDescriptionResponse_fields,
+      msgResponse);
+  if (_replaying)
+    return;
+  // the broker re-sends its full configuration after registering
+  for (size_t i = 0; i < _records.size(); i++)
+    _records[i].seen = false;
+  _syncPending =
+      (1 << WS_CACHE_REC_PIN_CONFIG) | (1 << WS_CACHE_REC_I2C_DEVICE);
+  _syncStart = millis();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a registration response describes other pin hardware
+            than the cached registration the cached pins were set up for.
+    @param  msgResponse
+            The registration response received from the broker.
+    @returns  True if the pin counts or reference voltage differ, False if
+              they match or no registration is cached.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::hardwareChanged(
+    wippersnapper_description_v1_CreateDescriptionResponse *msgResponse) {
+  cacheRecord *rec = find(WS_CACHE_REC_REGISTRATION, 0);
+  if (rec == NULL)
+    return false;
+  wippersnapper_description_v1_CreateDescriptionResponse cached =
+      wippersnapper_description_v1_CreateDescriptionResponse_init_zero;
+  pb_istream_t stream = pb_istream_from_buffer(rec->data, rec->len);
+  if (!pb_decode(&stream,
+                 wippersnapper_description_v1_CreateDescriptionResponse_fields,
+                 &cached))
+    return true;
+  return cached.total_gpio_pins != msgResponse->total_gpio_pins ||
+         cached.total_analog_pins != msgResponse->total_analog_pins ||
+         cached.reference_voltage != msgResponse->reference_voltage;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases every cached pin from the hardware and drops its
+            record. The broker's pin list sets the pins up again.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::invalidatePins() {
+  _replaying = true;
+  for (size_t i = _records.size(); i > 0; i--) {
+    cacheRecord *rec = &_records[i - 1];
+    if (rec->type != WS_CACHE_REC_PIN_CONFIG)
+      continue;
+    uint16_t key = rec->key;
+    removeRecord(rec);
+    erase(WS_CACHE_REC_PIN_CONFIG, key);
+    WS.feedWDT();
+  }
+  _replaying = false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a pin is already configured exactly as requested.
+    @param  pinMsg
+            The pin configuration request.
+    @returns  True if the request would not change the pin, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::pinUnchanged(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg) {
+  if (pinMsg->request_type !=
+      wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE)
+    return false;
+  return matches(WS_CACHE_REC_PIN_CONFIG, pinKey(pinMsg),
+                 wippersnapper_pin_v1_ConfigurePinRequest_fields, pinMsg);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the configuration currently applied to a pin.
+    @param  pinMsg
+            The pin configuration request.
+    @param  prvPinMsg
+            Set to the configuration the pin was set up with.
+    @returns  True if the pin was configured since boot, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::pinApplied(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg,
+    wippersnapper_pin_v1_ConfigurePinRequest *prvPinMsg) {
+  cacheRecord *rec = find(WS_CACHE_REC_PIN_CONFIG, pinKey(pinMsg));
+  if (_replaying || rec == NULL || !rec->applied)
+    return false;
+  pb_istream_t stream = pb_istream_from_buffer(rec->data, rec->len);
+  return pb_decode(&stream, wippersnapper_pin_v1_ConfigurePinRequest_fields,
+                   prvPinMsg);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Records a pin configuration which was applied.
+    @param  pinMsg
+            The applied pin configuration request.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::pinConfigured(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg) {
+  uint16_t key = pinKey(pinMsg);
+  if (key == WS_CHANNEL_NONE)
+    return;
+  if (pinMsg->request_type ==
+      wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE)
+    erase(WS_CACHE_REC_PIN_CONFIG, key);
+  else
+    put(WS_CACHE_REC_PIN_CONFIG, key,
+        wippersnapper_pin_v1_ConfigurePinRequest_fields, pinMsg);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if an I2C device is already initialized exactly as
+            requested.
+    @param  msgDeviceInitReq
+            The I2C device initialization request.
+    @returns  True if the request would not change the device, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::i2cDeviceUnchanged(
+    wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq) {
+  return matches(WS_CACHE_REC_I2C_DEVICE,
+                 msgDeviceInitReq->i2c_device_address,
+                 wippersnapper_i2c_v1_I2CDeviceInitRequest_fields,
+                 msgDeviceInitReq);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Records an I2C device which was initialized.
+    @param  msgDeviceInitReq
+            The applied I2C device initialization request.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::i2cDeviceInitialized(
+    wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq) {
+  put(WS_CACHE_REC_I2C_DEVICE, msgDeviceInitReq->i2c_device_address,
+      wippersnapper_i2c_v1_I2CDeviceInitRequest_fields, msgDeviceInitReq);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Merges updated sensor properties into a cached I2C device.
+    @param  msgDeviceUpdateReq
+            The applied I2C device update request.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::i2cDeviceUpdated(
+    wippersnapper_i2c_v1_I2CDeviceUpdateRequest *msgDeviceUpdateReq) {
+  cacheRecord *rec = find(WS_CACHE_REC_I2C_DEVICE,
+                          msgDeviceUpdateReq->i2c_device_address);
+  if (rec == NULL)
+    return;
+  wippersnapper_i2c_v1_I2CDeviceInitRequest msgDeviceInitReq =
+      wippersnapper_i2c_v1_I2CDeviceInitRequest_init_zero;
+  pb_istream_t stream = pb_istream_from_buffer(rec->data, rec->len);
+  if (!pb_decode(&stream, wippersnapper_i2c_v1_I2CDeviceInitRequest_fields,
+                 &msgDeviceInitReq))
+    return;
+  msgDeviceInitReq.i2c_device_properties_count =
+      msgDeviceUpdateReq->i2c_device_properties_count;
+  memcpy(msgDeviceInitReq.i2c_device_properties,
+         msgDeviceUpdateReq->i2c_device_properties,
+         sizeof(msgDeviceInitReq.i2c_device_properties));
+  i2cDeviceInitialized(&msgDeviceInitReq);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes an I2C device which was deinitialized.
+    @param  address
+            The I2C device's address.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::i2cDeviceDeinitialized(uint32_t address) {
+  erase(WS_CACHE_REC_I2C_DEVICE, address);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Called at the end of each list of pins or I2C devices sent by
+            the broker, reports the changes the list made. The first list
+            received after registering holds the broker's full
+            configuration, cached records it did not contain are removed
+            from the hardware and the cache.
+    @param  type
+            Type of the records within the list.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::endSync(ws_cache_rec_t type) {
+  if (_syncPending & (1 << type)) {
+    _syncPending &= ~(1 << type);
+    _replaying = true;
+    for (size_t i = _records.size(); i > 0; i--) {
+      cacheRecord *rec = &_records[i - 1];
+      if (rec->type != type || rec->seen)
+        continue;
+      uint16_t key = rec->key;
+      WS_DEBUG_PRINT("Removing configuration no longer sent by broker, key: ");
+      WS_DEBUG_PRINTLN(key);
+      removeRecord(rec);
+      // the handler erases the record, unless the hardware was never set up
+      erase(type, key);
+      WS.feedWDT();
+    }
+    _replaying = false;
+  }
+
+  cacheSyncStats *stats = &_stats[type];
+  WS_DEBUG_PRINT(type == WS_CACHE_REC_PIN_CONFIG ? "Reconciled pins, "
+                                                 : "Reconciled I2C devices, ");
+  WS_DEBUG_PRINT("added: ");
+  WS_DEBUG_PRINT(stats->added);
+  WS_DEBUG_PRINT(", changed: ");
+  WS_DEBUG_PRINT(stats->changed);
+  WS_DEBUG_PRINT(", removed: ");
+  WS_DEBUG_PRINT(stats->removed);
+  WS_DEBUG_PRINT(", unchanged: ");
+  WS_DEBUG_PRINTLN(stats->unchanged);
+  memset(stats, 0, sizeof(cacheSyncStats));
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Validates a cache file and loads its records.
+    @param  buf
+            Contents of the cache file.
+    @param  len
+            Length of buf, in bytes.
+    @returns  True if the file is valid, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::parse(const uint8_t *buf, size_t len) {
+  if (len < 10 || memcmp(buf, "WSCC", 4) != 0 ||
+      buf[4] != WS_CONFIG_CACHE_VERSION)
+    return false;
+
+  size_t pos = 5;
+  while (pos < len) {
+    if (buf[pos] == WS_CACHE_REC_END) {
+      if (pos + 5 != len)
+        return false;
+      uint32_t crc = 0;
+      for (uint8_t i = 0; i < 4; i++)
+        crc |= (uint32_t)buf[pos + 1 + i] << (8 * i);
+      return crc == crc32(0, buf, pos);
+    }
+    if (pos + 5 > len)
+      return false;
+    cacheRecord rec;
+    rec.type = buf[pos];
+    rec.key = buf[pos + 1] | (buf[pos + 2] << 8);
+    rec.len = buf[pos + 3] | (buf[pos + 4] << 8);
+    rec.applied = false;
+    rec.seen = false;
+    pos += 5;
+    if (pos + rec.len > len)
+      return false;
+    rec.data = (uint8_t *)malloc(rec.len);
+    if (rec.data == NULL)
+      return false;
+    memcpy(rec.data, buf + pos, rec.len);
+    pos += rec.len;
+    _records.push_back(rec);
+  }
+  return false; // no END record, the file is truncated
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Applies every cached record, in the order they were saved.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::replay() {
+  _replaying = true;
+  for (size_t i = 0; i < _records.size(); i++) {
+    replayRecord(&_records[i]);
+    WS.feedWDT();
+  }
+  _replaying = false;
+  // applying the records re-encodes them, the file is already up to date
+  _dirty = false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Applies a single cached record.
+    @param  rec
+            The record to apply.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::replayRecord(cacheRecord *rec) {
+  pb_istream_t stream = pb_istream_from_buffer(rec->data, rec->len);
+  bool is_success = false;
+  if (rec->type == WS_CACHE_REC_REGISTRATION) {
+    wippersnapper_description_v1_CreateDescriptionResponse msgResponse =
+        wippersnapper_description_v1_CreateDescriptionResponse_init_zero;
+    is_success = pb_decode(
+        &stream, wippersnapper_description_v1_CreateDescriptionResponse_fields,
+        &msgResponse);
+    if (is_success)
+      WS.applyRegistration(&msgResponse);
+  } else if (rec->type == WS_CACHE_REC_PIN_CONFIG) {
+    wippersnapper_pin_v1_ConfigurePinRequest pinMsg =
+        wippersnapper_pin_v1_ConfigurePinRequest_init_zero;
+    is_success = pb_decode(
+        &stream, wippersnapper_pin_v1_ConfigurePinRequest_fields, &pinMsg);
+    if (is_success)
+      WS.configurePinRequest(&pinMsg);
+  } else if (rec->type == WS_CACHE_REC_I2C_DEVICE) {
+    wippersnapper_i2c_v1_I2CDeviceInitRequest msgDeviceInitReq =
+        wippersnapper_i2c_v1_I2CDeviceInitRequest_init_zero;
+    is_success =
+        pb_decode(&stream, wippersnapper_i2c_v1_I2CDeviceInitRequest_fields,
+                  &msgDeviceInitReq);
+    if (is_success)
+      WS.i2cDeviceInitRequest(&msgDeviceInitReq);
+  }
+  if (!is_success)
+    WS_DEBUG_PRINTLN("ERROR: Unable to apply cached configuration record");
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes the pin or I2C device held by a record from the
+            hardware.
+    @param  rec
+            The record to remove.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::removeRecord(cacheRecord *rec) {
+  if (rec->type == WS_CACHE_REC_PIN_CONFIG) {
+    wippersnapper_pin_v1_ConfigurePinRequest pinMsg =
+        wippersnapper_pin_v1_ConfigurePinRequest_init_zero;
+    pb_istream_t stream = pb_istream_from_buffer(rec->data, rec->len);
+    if (!pb_decode(&stream, wippersnapper_pin_v1_ConfigurePinRequest_fields,
+                   &pinMsg))
+      return;
+    pinMsg.request_type =
+        wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE;
+    WS.configurePinRequest(&pinMsg);
+  } else if (rec->type == WS_CACHE_REC_I2C_DEVICE && WS._isI2CPort0Init) {
+    wippersnapper_i2c_v1_I2CDeviceDeinitRequest msgDeviceDeinitReq =
+        wippersnapper_i2c_v1_I2CDeviceDeinitRequest_init_zero;
+    msgDeviceDeinitReq.i2c_device_address = rec->key;
+    WS.i2cDeviceDeinitRequest(&msgDeviceDeinitReq);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Finds a record.
+    @param  type
+            Type of the record.
+    @param  key
+            Key of the record within its type.
+    @returns  Pointer to the record, NULL if it is not cached.
+*/
+/***********************************************************************************/
+cacheRecord *Wippersnapper_ConfigCache::find(uint8_t type, uint16_t key) {
+  for (size_t i = 0; i < _records.size(); i++) {
+    if (_records[i].type == type && _records[i].key == key)
+      return &_records[i];
+  }
+  return NULL;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a message was applied since boot, unchanged, and
+            marks it as sent by the broker.
+    @param  type
+            Type of the record.
+    @param  key
+            Key of the record within its type.
+    @param  fields
+            Message descriptor.
+    @param  msg
+            The message.
+    @returns  True if the same message was applied since boot, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_ConfigCache::matches(uint8_t type, uint16_t key,
+                                        const pb_msgdesc_t *fields,
+                                        const void *msg) {
+  cacheRecord *rec = find(type, key);
+  if (_replaying || rec == NULL || !rec->applied)
+    return false;
+  size_t len;
+  if (!pb_get_encoded_size(&len, fields, msg) || len != rec->len)
+    return false;
+  // compare as the message is encoded, without a copy of it
+  pb_ostream_t stream = PB_OSTREAM_SIZING;
+  stream.callback = &cbCompareRecord;
+  stream.state = rec->data;
+  stream.max_size = len;
+  if (!pb_encode(&stream, fields, msg))
+    return false;
+  rec->seen = true;
+  _stats[type].unchanged++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Adds or replaces a record, the cache is saved later if its
+            contents changed.
+    @param  type
+            Type of the record.
+    @param  key
+            Key of the record within its type.
+    @param  fields
+            Message descriptor.
+    @param  msg
+            The message to encode into the record.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::put(uint8_t type, uint16_t key,
+                                   const pb_msgdesc_t *fields,
+                                   const void *msg) {
+  size_t len;
+  if (!pb_get_encoded_size(&len, fields, msg) || len > 0xFFFF)
+    return;
+  uint8_t *data = (uint8_t *)malloc(len > 0 ? len : 1);
+  if (data == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to allocate configuration cache record");
+    return;
+  }
+  pb_ostream_t stream = pb_ostream_from_buffer(data, len);
+  if (!pb_encode(&stream, fields, msg)) {
+    free(data);
+    return;
+  }
+
+  cacheRecord *rec = find(type, key);
+  if (rec == NULL) {
+    cacheRecord added = {type, key, 0, NULL, false, false};
+    _records.push_back(added);
+    rec = &_records.back();
+  }
+  if (!_replaying && type != WS_CACHE_REC_REGISTRATION) {
+    if (!rec->applied)
+      _stats[type].added++;
+    else if (rec->len != len || memcmp(rec->data, data, len) != 0)
+      _stats[type].changed++;
+    else
+      _stats[type].unchanged++;
+  }
+  rec->applied = true;
+  rec->seen = true;
+  if (rec->data != NULL && rec->len == len &&
+      memcmp(rec->data, data, len) == 0) {
+    free(data);
+    return;
+  }
+  free(rec->data);
+  rec->data = data;
+  rec->len = len;
+  _dirty = true;
+  _changed = millis();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes a record.
+    @param  type
+            Type of the record.
+    @param  key
+            Key of the record within its type.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::erase(uint8_t type, uint16_t key) {
+  for (size_t i = 0; i < _records.size(); i++) {
+    if (_records[i].type == type && _records[i].key == key) {
+      if (_records[i].applied && type != WS_CACHE_REC_REGISTRATION)
+        _stats[type].removed++;
+      free(_records[i].data);
+      _records.erase(_records.begin() + i);
+      _dirty = true;
+      _changed = millis();
+      return;
+    }
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes every record.
+*/
+/***********************************************************************************/
+void Wippersnapper_ConfigCache::clear() {
+  for (size_t i = 0; i < _records.size(); i++)
+    free(_records[i].data);
+  _records.clear();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the record key of a pin.
+    @param  pinMsg
+            The pin configuration request.
+    @returns  The pin's channel, WS_CHANNEL_NONE if the pin name is invalid.
+*/
+/***********************************************************************************/
+uint16_t Wippersnapper_ConfigCache::pinKey(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg) {
+  uint16_t channel;
+  if (!Wippersnapper_Outbound::channelFromName(pinMsg->pin_name, &channel))
+    return WS_CHANNEL_NONE;
+  return channel;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Computes the CRC-32 (IEEE 802.3) of a buffer.
+    @param  crc
+            CRC of the preceding data, 0 to start.
+    @param  data
+            The data.
+    @param  len
+            Length of data, in bytes.
+    @returns  The updated CRC.
+*/
+/***********************************************************************************/
+uint32_t Wippersnapper_ConfigCache::crc32(uint32_t crc, const uint8_t *data,
+                                          size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
@@ -0,0 +1,147 @@
+/*!
+ * @file Wippersnapper_ConfigCache.h
+ *
+ * Persists the configuration applied by the broker to the filesystem so
+ * it can be applied again immediately after a reset.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_CONFIGCACHE_H
+#define WIPPERSNAPPER_CONFIGCACHE_H
+
+#include "Wippersnapper.h"
+#include <vector>
+
+#ifndef WS_CONFIG_CACHE_FILE
+#define WS_CONFIG_CACHE_FILE "/wipper_cache.bin" ///< Cache file path
+#endif
+#ifndef WS_CONFIG_CACHE_SAVE_DELAY_MS
+#define WS_CONFIG_CACHE_SAVE_DELAY_MS                                          \
+  5000 ///< Time without changes before the cache is saved, in milliseconds
+#endif
+#ifndef WS_CONFIG_CACHE_SAVE_MAX_DELAY_MS
+#define WS_CONFIG_CACHE_SAVE_MAX_DELAY_MS                                      \
+  300000 ///< Longest delay between retries of a failed save, in milliseconds
+#endif
+#ifndef WS_CONFIG_CACHE_SYNC_TIMEOUT_MS
+#define WS_CONFIG_CACHE_SYNC_TIMEOUT_MS                                        \
+  60000 ///< Time to wait for the broker's lists after registering, in millis
+#endif
+#define WS_CONFIG_CACHE_VERSION                                                \
+  1 ///< Cache file format version, bump when the format or a message changes
+
+// The cache file is laid out as:
+//   "WSCC" version
+//   { type key_lo key_hi len_lo len_hi <len bytes of encoded message> } ...
+//   WS_CACHE_REC_END crc32 (little-endian, of every byte before the END type)
+
+/** Type of a cached configuration record */
+typedef enum {
+  WS_CACHE_REC_REGISTRATION = 1, ///< CreateDescriptionResponse, key 0
+  WS_CACHE_REC_PIN_CONFIG = 2,   ///< ConfigurePinRequest, key WS_CHANNEL_*
+  WS_CACHE_REC_I2C_DEVICE = 3,   ///< I2CDeviceInitRequest, key address
+  WS_CACHE_REC_END = 0xFF        ///< End of the file, followed by a CRC32
+} ws_cache_rec_t;
+
+/** A single configuration message, encoded */
+struct cacheRecord {
+  uint8_t type;  ///< Record type, ws_cache_rec_t
+  uint16_t key;  ///< Identifies the pin or device within its type
+  uint16_t len;  ///< Length of data, in bytes
+  uint8_t *data; ///< Encoded message
+  bool applied;  ///< True if the message was applied since boot
+  bool seen;     ///< True if the broker sent the message since registering
+};
+
+/** Changes made by the configuration the broker sent, for one record type */
+struct cacheSyncStats {
+  uint16_t added;     ///< Pins or devices set up
+  uint16_t changed;   ///< Pins or devices whose configuration changed
+  uint16_t removed;   ///< Pins or devices released
+  uint16_t unchanged; ///< Re-sent pins or devices which were left as they are
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that records the registration response, pin
+            configurations and I2C devices applied by the broker and
+            saves them to the filesystem. After a reset the saved
+            configuration is applied before connecting, then reconciled
+            with the configuration the broker sends once registered.
+            The records are the device's current configuration, re-sent
+            configuration is compared against them so only changes are
+            applied to the hardware.
+*/
+/**************************************************************************/
+class Wippersnapper_ConfigCache {
+public:
+  Wippersnapper_ConfigCache();
+  ~Wippersnapper_ConfigCache();
+
+  bool load();
+  bool warm();
+  bool replaying();
+  void process();
+  bool save();
+
+  void registered(
+      wippersnapper_description_v1_CreateDescriptionResponse *msgResponse);
+  bool hardwareChanged(
+      wippersnapper_description_v1_CreateDescriptionResponse *msgResponse);
+  void invalidatePins();
+  bool pinUnchanged(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg);
+  bool pinApplied(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg,
+                  wippersnapper_pin_v1_ConfigurePinRequest *prvPinMsg);
+  void pinConfigured(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg);
+  bool i2cDeviceUnchanged(
+      wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq);
+  void i2cDeviceInitialized(
+      wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq);
+  void i2cDeviceUpdated(
+      wippersnapper_i2c_v1_I2CDeviceUpdateRequest *msgDeviceUpdateReq);
+  void i2cDeviceDeinitialized(uint32_t address);
+  void endSync(ws_cache_rec_t type);
+
+private:
+  bool parse(const uint8_t *buf, size_t len);
+  void replay();
+  void replayRecord(cacheRecord *rec);
+  void removeRecord(cacheRecord *rec);
+  cacheRecord *find(uint8_t type, uint16_t key);
+  bool matches(uint8_t type, uint16_t key, const pb_msgdesc_t *fields,
+               const void *msg);
+  void put(uint8_t type, uint16_t key, const pb_msgdesc_t *fields,
+           const void *msg);
+  void erase(uint8_t type, uint16_t key);
+  void clear();
+  static uint16_t pinKey(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg);
+  static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+  std::vector<cacheRecord> _records; ///< Cached configuration
+  bool _warm = false;      ///< True if the cached configuration was applied
+  bool _replaying = false; ///< True while applying changes not requested
+                           ///< by the broker
+  bool _dirty = false;     ///< True if the records differ from the file
+  uint32_t _changed = 0;   ///< millis() of the last change to the records
+  uint32_t _saveDelay =
+      WS_CONFIG_CACHE_SAVE_DELAY_MS; ///< Time to wait before saving, in millis
+  uint8_t _syncPending = 0; ///< Bit per record type, set until the broker
+                            ///< sent its first full list of that type
+  uint32_t _syncStart = 0; ///< millis() when the broker's lists were expected
+  /** Changes made since the broker's last list, per record type */
+  cacheSyncStats _stats[WS_CACHE_REC_I2C_DEVICE + 1] = {};
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_CONFIGCACHE_H
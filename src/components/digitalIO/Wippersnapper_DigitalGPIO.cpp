@@ -15,6 +15,128 @@
  */
 
 #include "Wippersnapper_DigitalGPIO.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#if SOC_PCNT_SUPPORTED
+#include "driver/pcnt.h"
+#define WS_HAS_PCNT ///< Pulses are counted by the PCNT peripheral
+#define WS_PCNT_HIGH_LIMIT                                                     \
+  32767 ///< Value at which a PCNT counter wraps to 0, negated for encoders
+#define WS_PCNT_FILTER_MAX 1023 ///< Longest PCNT glitch filter, APB cycles
+#endif
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR ///< Places interrupt handlers within IRAM on ESP32
+#endif
+#define WS_DIGITAL_IRQ_FREE 0xFF ///< Edge interrupt handler is not in use
+
+// Edges captured by the interrupt handlers. The handlers only advance
+// edgeHead and the main loop only advances edgeTail, so the ring needs no
+// lock. All handlers run on the same core and never preempt each other.
+static volatile digitalEdge edgeRing[WS_DIGITAL_EDGE_RING_SIZE];
+static volatile uint8_t edgeHead = 0;      ///< Next record written by ISRs
+static volatile uint8_t edgeTail = 0;      ///< Next record read by the loop
+static volatile uint32_t edgeOverflow = 0; ///< Edges lost to a full ring
+// Handlers flagged within irqCounting count rising edges instead
+static volatile uint8_t irqCounting = 0; ///< Bit per handler counting pulses
+static volatile uint32_t irqCounts[WS_DIGITAL_IRQ_MAX];    ///< Pulses counted
+static volatile uint32_t irqEdgeTimes[WS_DIGITAL_IRQ_MAX]; ///< Last pulse time
+static uint32_t irqDeadTimes[WS_DIGITAL_IRQ_MAX]; ///< Glitch filter, in micros
+// Handlers flagged within irqEncoding serve both phases of an encoder
+static volatile uint8_t irqEncoding = 0; ///< Bit per handler decoding phases
+static volatile uint8_t irqEncoderPins[WS_DIGITAL_IRQ_MAX]; ///< Phase B pins
+static volatile uint8_t irqEncoderStates[WS_DIGITAL_IRQ_MAX]; ///< Phases, A:B
+/** Encoder steps by previous and current phases, A leading B counts up */
+static const int8_t quadratureSteps[16] = {0,  -1, 1, 0, 1, 0, 0,  -1,
+                                           -1, 0,  0, 1, 0, 1, -1, 0};
+/** Pin served by each edge interrupt handler */
+static volatile uint8_t irqPins[WS_DIGITAL_IRQ_MAX] = {
+    WS_DIGITAL_IRQ_FREE, WS_DIGITAL_IRQ_FREE, WS_DIGITAL_IRQ_FREE,
+    WS_DIGITAL_IRQ_FREE, WS_DIGITAL_IRQ_FREE, WS_DIGITAL_IRQ_FREE,
+    WS_DIGITAL_IRQ_FREE, WS_DIGITAL_IRQ_FREE};
+
+/**************************************************************************/
+/*!
+    @brief  Records the level and time of an edge within the edge ring,
+            counts the pulse of a pulse counting input or steps the
+            position of a quadrature encoder. Called from interrupt
+            context.
+    @param  irq
+            The edge interrupt handler which fired.
+*/
+/**************************************************************************/
+static void IRAM_ATTR captureEdge(uint8_t irq) {
+  if (irqEncoding & (1 << irq)) {
+    // either phase changed, invalid transitions are glitches and count 0
+    uint8_t state = (digitalRead(irqPins[irq]) << 1) |
+                    digitalRead(irqEncoderPins[irq]);
+    irqCounts[irq] += quadratureSteps[(irqEncoderStates[irq] << 2) | state];
+    irqEncoderStates[irq] = state;
+    return;
+  }
+  if (irqCounting & (1 << irq)) {
+    uint32_t time = micros();
+    if (time - irqEdgeTimes[irq] < irqDeadTimes[irq])
+      return; // glitch within the input's settle time
+    irqCounts[irq]++;
+    irqEdgeTimes[irq] = time;
+    return;
+  }
+  uint8_t head = edgeHead;
+  uint8_t next = (head + 1) & (WS_DIGITAL_EDGE_RING_SIZE - 1);
+  if (next == edgeTail) {
+    edgeOverflow++;
+    return;
+  }
+  uint8_t pinName = irqPins[irq];
+  edgeRing[head].time = micros();
+  edgeRing[head].pinName = pinName;
+  edgeRing[head].level = digitalRead(pinName);
+  edgeHead = next; // hand the record over once it is complete
+}
+
+// attachInterrupt() handlers take no argument, one handler per pin
+static void IRAM_ATTR isrEdge0() { captureEdge(0); } ///< Edge handler 0
+static void IRAM_ATTR isrEdge1() { captureEdge(1); } ///< Edge handler 1
+static void IRAM_ATTR isrEdge2() { captureEdge(2); } ///< Edge handler 2
+static void IRAM_ATTR isrEdge3() { captureEdge(3); } ///< Edge handler 3
+static void IRAM_ATTR isrEdge4() { captureEdge(4); } ///< Edge handler 4
+static void IRAM_ATTR isrEdge5() { captureEdge(5); } ///< Edge handler 5
+static void IRAM_ATTR isrEdge6() { captureEdge(6); } ///< Edge handler 6
+static void IRAM_ATTR isrEdge7() { captureEdge(7); } ///< Edge handler 7
+/** Edge interrupt handlers, indexed by digitalInputPin.irq */
+static void (*const edgeIsrs[WS_DIGITAL_IRQ_MAX])(void) = {
+    isrEdge0, isrEdge1, isrEdge2, isrEdge3,
+    isrEdge4, isrEdge5, isrEdge6, isrEdge7};
+
+#ifdef WS_HAS_PCNT
+// Counts wrapped by each PCNT unit, added by the limit event handler
+static volatile uint32_t pcntWraps[PCNT_UNIT_MAX]; ///< Sum of wrapped counts
+static bool pcntIsrInstalled = false; ///< True once the ISR service runs
+
+/**************************************************************************/
+/*!
+    @brief  Accumulates the count of a PCNT unit as it reaches a limit and
+            resets to 0, so no pulses are lost between reads. Called from
+            interrupt context.
+    @param  arg
+            The PCNT unit.
+*/
+/**************************************************************************/
+static void IRAM_ATTR isrPcntLimit(void *arg) {
+  pcnt_unit_t unit = (pcnt_unit_t)(intptr_t)arg;
+  uint32_t status = 0;
+  pcnt_get_event_status(unit, &status);
+  if (status & PCNT_EVT_H_LIM)
+    pcntWraps[unit] += WS_PCNT_HIGH_LIMIT;
+  if (status & PCNT_EVT_L_LIM)
+    pcntWraps[unit] -= WS_PCNT_HIGH_LIMIT;
+}
+#endif
 
 /***********************************************************************************/
 /*!
@@ -25,15 +147,18 @@
 /***********************************************************************************/
 Wippersnapper_DigitalGPIO::Wippersnapper_DigitalGPIO(
     int32_t totalDigitalInputPins) {
-  _totalDigitalInputPins = totalDigitalInputPins;
+  // slots are indexed by a byte, WS_PIN_NO_SLOT marks unused pins
+  _totalDigitalInputPins = min(totalDigitalInputPins, (int32_t)WS_PIN_NO_SLOT);
   _digital_input_pins = new digitalInputPin[_totalDigitalInputPins];
   // turn input sampling off for all digital pins
   for (int i = 0; i < _totalDigitalInputPins; i++) {
-    _digital_input_pins[i].pinName = -1;
-    _digital_input_pins[i].period = -1;
-    _digital_input_pins[i].prvPeriod = 0L;
-    _digital_input_pins[i].prvPinVal = 0;
+    _digital_input_pins[i].irq = -1;
+    _digital_input_pins[i].pcntUnit = -1;
+    clearDigitalInput(&_digital_input_pins[i]);
   }
+  _pinSlots = new uint8_t[WS_PIN_INDEX_SIZE];
+  memset(_pinSlots, WS_PIN_NO_SLOT, WS_PIN_INDEX_SIZE);
+  _outputPins = new uint32_t[(WS_PIN_INDEX_SIZE + 31) / 32]();
 }
 
 /*********************************************************/
@@ -42,7 +167,95 @@ Wippersnapper_DigitalGPIO::Wippersnapper_DigitalGPIO(
 */
 /*********************************************************/
 Wippersnapper_DigitalGPIO::~Wippersnapper_DigitalGPIO() {
-  delete _digital_input_pins;
+  delete[] _digital_input_pins;
+  delete[] _pinSlots;
+  delete[] _outputPins;
+}
+
+/*********************************************************/
+/*!
+    @brief    Marks a digital input slot as free. The slot's
+                interrupt and pulse counter must already be
+                released.
+    @param    input
+                The digital input slot.
+*/
+/*********************************************************/
+void Wippersnapper_DigitalGPIO::clearDigitalInput(digitalInputPin *input) {
+  input->pinName = -1;
+  input->period = -1;
+  input->prvPeriod = 0L;
+  input->prvPinVal = 0;
+  input->debounceUs = 0;
+  input->rawPinVal = 0;
+  input->rawTime = 0;
+  input->bounces = 0;
+  input->readMode = 0;
+  input->encoderPin = 0;
+  input->changeThreshold = 0;
+  input->pcntPrv = 0;
+  input->count = 0;
+  input->prvCount = 0;
+  input->prvEdgeTime = 0;
+  _portMasksDirty = true;
+}
+
+/*********************************************************/
+/*!
+    @brief    Looks up the input slot of a pin.
+    @param    pinName
+                The pin's name.
+    @returns  The pin's index within _digital_input_pins[],
+                -1 if the pin is not a configured input.
+*/
+/*********************************************************/
+int Wippersnapper_DigitalGPIO::findDigitalInput(uint8_t pinName) {
+  if (pinName >= WS_PIN_INDEX_SIZE || _pinSlots[pinName] == WS_PIN_NO_SLOT)
+    return -1;
+  return _pinSlots[pinName];
+}
+
+/*********************************************************/
+/*!
+    @brief    Appends a pin to the configured inputs.
+    @param    pinName
+                The pin's name, which must not be an input.
+    @returns  The pin's index within _digital_input_pins[],
+                -1 if every slot is in use.
+*/
+/*********************************************************/
+int Wippersnapper_DigitalGPIO::addDigitalInput(uint8_t pinName) {
+  if (_digitalInputCount == _totalDigitalInputPins ||
+      pinName >= WS_PIN_INDEX_SIZE) {
+    WS_DEBUG_PRINTLN("ERROR: No free digital input slot");
+    return -1;
+  }
+  int slot = _digitalInputCount++;
+  _digital_input_pins[slot].pinName = pinName;
+  _pinSlots[pinName] = slot;
+  return slot;
+}
+
+/*********************************************************/
+/*!
+    @brief    Removes an input from the configured inputs,
+                moving the last input into its slot. The
+                input's interrupt and pulse counter must
+                already be released.
+    @param    slot
+                The input's index within _digital_input_pins[].
+*/
+/*********************************************************/
+void Wippersnapper_DigitalGPIO::removeDigitalInput(int slot) {
+  int last = --_digitalInputCount;
+  _pinSlots[_digital_input_pins[slot].pinName] = WS_PIN_NO_SLOT;
+  if (slot != last) {
+    _digital_input_pins[slot] = _digital_input_pins[last];
+    _pinSlots[_digital_input_pins[slot].pinName] = slot;
+    _digital_input_pins[last].irq = -1;
+    _digital_input_pins[last].pcntUnit = -1;
+  }
+  clearDigitalInput(&_digital_input_pins[last]);
 }
 
 /*******************************************************************************************************************************/
@@ -56,12 +269,28 @@ Wippersnapper_DigitalGPIO::~Wippersnapper_DigitalGPIO() {
             The pin's period, in seconds.
     @param  pull
             The pin's pull mode.
+    @param  debounceUs
+            Time an input's level must hold before it is published, in
+            microseconds, 0 to publish every change.
+    @param  readMode
+            Whether an input publishes its level, the pulses counted
+            during each period or the position of a quadrature encoder.
+    @param  encoderPin
+            Phase B of a quadrature encoder, pinName being phase A.
+    @param  changeThreshold
+            Encoder steps which publish the position before the end of
+            the period, 0 to only publish periodically.
 */
 /*******************************************************************************************************************************/
 void Wippersnapper_DigitalGPIO::initDigitalPin(
     wippersnapper_pin_v1_ConfigurePinRequest_Direction direction,
     uint8_t pinName, float period,
-    wippersnapper_pin_v1_ConfigurePinRequest_Pull pull) {
+    wippersnapper_pin_v1_ConfigurePinRequest_Pull pull, uint32_t debounceUs,
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode readMode,
+    uint8_t encoderPin, uint32_t changeThreshold) {
+  bool encoder =
+      readMode ==
+      wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE;
   if (direction ==
       wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_OUTPUT) {
 
@@ -74,16 +303,24 @@ void Wippersnapper_DigitalGPIO::initDigitalPin(
     WS_DEBUG_PRINTLN(pinName);
     pinMode(pinName, OUTPUT);
     digitalWrite(pinName, LOW); // initialize LOW
+    setDigitalOutput(pinName, true);
+    WS._lastValue->track(WS_CHANNEL_DIGITAL(pinName));
+    WS._lastValue->update(WS_CHANNEL_DIGITAL(pinName), 0, LOW);
   } else if (
       direction ==
       wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_INPUT) {
     WS_DEBUG_PRINT("Configuring digital input pin on D");
     WS_DEBUG_PRINT(pinName);
+    setDigitalOutput(pinName, false);
     if (pull == wippersnapper_pin_v1_ConfigurePinRequest_Pull_PULL_UP) {
       WS_DEBUG_PRINTLN("with internal pull-up enabled");
       pinMode(pinName, INPUT_PULLUP);
+      if (encoder)
+        pinMode(encoderPin, INPUT_PULLUP);
     } else {
       pinMode(pinName, INPUT);
+      if (encoder)
+        pinMode(encoderPin, INPUT);
       WS_DEBUG_PRINT("\n");
     }
 
@@ -92,20 +329,325 @@ void Wippersnapper_DigitalGPIO::initDigitalPin(
     WS_DEBUG_PRINT("Interval (ms):");
     WS_DEBUG_PRINTLN(periodMs);
 
-    // attempt to allocate a pinName within _digital_input_pins[]
-    for (int i = 0; i < _totalDigitalInputPins; i++) {
-      if (_digital_input_pins[i].period == -1L) {
-        _digital_input_pins[i].pinName = pinName;
-        _digital_input_pins[i].period = periodMs;
-        break;
-      }
-    }
+    // an input pin keeps its slot, otherwise append it to the inputs
+    int slot = findDigitalInput(pinName);
+    if (slot == -1)
+      slot = addDigitalInput(pinName);
+    if (slot == -1)
+      return;
+    _digital_input_pins[slot].period = periodMs;
+    _digital_input_pins[slot].debounceUs = debounceUs;
+    _digital_input_pins[slot].readMode = readMode;
+    _digital_input_pins[slot].encoderPin = encoderPin;
+    _digital_input_pins[slot].changeThreshold = changeThreshold;
+    updateInputMode(slot);
+    WS._lastValue->track(WS_CHANNEL_DIGITAL(pinName));
 
   } else {
     WS_DEBUG_PRINTLN("ERROR: Invalid digital pin direction!");
   }
 }
 
+/********************************************************************************************************************************/
+/*!
+    @brief    Changes the period of a configured digital input pin. The pin
+              keeps its schedule and previous value.
+    @param    pinName
+              The pin's name.
+    @param    period
+              Time between measurements, in seconds.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::setDigitalInputPeriod(uint8_t pinName,
+                                                      float period) {
+  int slot = findDigitalInput(pinName);
+  if (slot == -1)
+    return false;
+  // Period is in seconds, cast it to long and convert it to milliseconds
+  _digital_input_pins[slot].period = (long)period * 1000;
+  updateInputMode(slot);
+  return true;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Changes the settle time of a configured digital input pin.
+    @param    pinName
+              The pin's name.
+    @param    debounceUs
+              Time the pin's level must hold before it is published, in
+              microseconds, 0 to publish every change.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::setDigitalInputDebounce(uint8_t pinName,
+                                                        uint32_t debounceUs) {
+  int slot = findDigitalInput(pinName);
+  if (slot == -1)
+    return false;
+  _digital_input_pins[slot].debounceUs = debounceUs;
+  setPulseFilter(&_digital_input_pins[slot]);
+  return true;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Configures a list of digital pins in a single pass. On SAMD,
+              the direction, pull and initial level of every pin on a
+              port are written with one register write per port. Other
+              platforms route each pin through pinMode().
+    @param    pinMsgs
+              Validated pin configuration requests, all CREATE requests
+              for digital pins which are not configured.
+    @param    count
+              Number of requests within pinMsgs.
+    @param    configured
+              Set to count entries, each True if the pin at the same
+              index of pinMsgs was configured.
+    @returns  True if every pin was configured, False if any input had
+              no free slot and was left untouched.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::initDigitalPins(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsgs[], size_t count,
+    std::vector<bool> &configured) {
+#ifdef ARDUINO_ARCH_SAMD
+  // per port group, pins set to output LOW, to input and inputs pulled up
+  uint32_t outputs[WS_PORT_GROUPS] = {0};
+  uint32_t inputs[WS_PORT_GROUPS] = {0};
+  uint32_t pullups[WS_PORT_GROUPS] = {0};
+#endif
+  std::vector<int32_t> inputSlots;
+  size_t failed = 0;
+  configured.assign(count, false);
+
+  for (size_t i = 0; i < count; i++) {
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg = pinMsgs[i];
+    uint8_t pinName = atoi(pinMsg->pin_name + 1);
+    bool output =
+        pinMsg->direction ==
+        wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_OUTPUT;
+    bool pullup =
+        pinMsg->pull == wippersnapper_pin_v1_ConfigurePinRequest_Pull_PULL_UP;
+    bool encoder =
+        pinMsg->digital_read_mode ==
+        wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE;
+
+    // take an input slot before touching the pin, a pin without one is
+    // left as it is. An input pin keeps its slot.
+    int slot = -1;
+    if (!output) {
+      slot = findDigitalInput(pinName);
+      if (slot == -1)
+        slot = addDigitalInput(pinName);
+      if (slot == -1) {
+        WS_DEBUG_PRINT("ERROR: Unable to configure digital input on D");
+        WS_DEBUG_PRINTLN(pinName);
+        failed++;
+        continue;
+      }
+    }
+    configured[i] = true;
+    setDigitalOutput(pinName, output);
+
+#ifdef STATUS_LED_PIN
+    // deinit status led, use it as a dio component instead
+    if (output && pinName == STATUS_LED_PIN)
+      WS.statusLEDDeinit();
+#endif
+
+#ifdef ARDUINO_ARCH_SAMD
+    EPortType port = g_APinDescription[pinName].ulPort;
+    uint32_t bit = g_APinDescription[pinName].ulPin;
+    // input buffer is enabled for outputs too, so their level can be read
+    PORT->Group[port].PINCFG[bit].reg =
+        (uint8_t)(PORT_PINCFG_INEN | (!output && pullup ? PORT_PINCFG_PULLEN
+                                                        : 0));
+    if (output)
+      outputs[port] |= (1ul << bit);
+    else
+      inputs[port] |= (1ul << bit);
+    if (!output && pullup)
+      pullups[port] |= (1ul << bit);
+    if (encoder) {
+      // phase B is an input alongside phase A, with the same pull
+      uint8_t pinB = pinMsg->encoder_pin;
+      port = g_APinDescription[pinB].ulPort;
+      bit = g_APinDescription[pinB].ulPin;
+      PORT->Group[port].PINCFG[bit].reg =
+          (uint8_t)(PORT_PINCFG_INEN | (pullup ? PORT_PINCFG_PULLEN : 0));
+      inputs[port] |= (1ul << bit);
+      if (pullup)
+        pullups[port] |= (1ul << bit);
+    }
+#else
+    if (output) {
+      pinMode(pinName, OUTPUT);
+      digitalWrite(pinName, LOW); // initialize LOW
+    } else {
+      pinMode(pinName, pullup ? INPUT_PULLUP : INPUT);
+      if (encoder)
+        pinMode(pinMsg->encoder_pin, pullup ? INPUT_PULLUP : INPUT);
+    }
+#endif
+
+    WS._lastValue->track(WS_CHANNEL_DIGITAL(pinName));
+    if (output) {
+      WS._lastValue->update(WS_CHANNEL_DIGITAL(pinName), 0, LOW);
+      continue;
+    }
+    // Period is in seconds, cast it to long and convert it to milliseconds
+    _digital_input_pins[slot].period = (long)pinMsg->period * 1000;
+    _digital_input_pins[slot].prvPeriod = 0L;
+    _digital_input_pins[slot].prvPinVal = 0;
+    _digital_input_pins[slot].debounceUs = pinMsg->debounce_us;
+    _digital_input_pins[slot].readMode = pinMsg->digital_read_mode;
+    _digital_input_pins[slot].encoderPin = pinMsg->encoder_pin;
+    _digital_input_pins[slot].changeThreshold = pinMsg->change_threshold;
+    inputSlots.push_back(slot);
+  }
+
+#ifdef ARDUINO_ARCH_SAMD
+  for (uint8_t port = 0; port < WS_PORT_GROUPS; port++) {
+    // only touch the port groups the board has pins on
+    if ((outputs[port] | inputs[port]) == 0)
+      continue;
+    // level before direction, so outputs never glitch high
+    PORT->Group[port].OUTCLR.reg = outputs[port];
+    PORT->Group[port].DIRSET.reg = outputs[port];
+    PORT->Group[port].OUTCLR.reg = inputs[port] & ~pullups[port];
+    PORT->Group[port].OUTSET.reg = pullups[port];
+    PORT->Group[port].DIRCLR.reg = inputs[port];
+  }
+#endif
+  // edge interrupts are attached once the pins are inputs
+  for (size_t i = 0; i < inputSlots.size(); i++)
+    updateInputMode(inputSlots[i]);
+  WS_DEBUG_PRINT("Configured digital pins: ");
+  WS_DEBUG_PRINTLN(count - failed);
+  return failed == 0;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if a digital pin is configured as an input.
+    @param    pinName
+              The pin's name.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::isDigitalInput(uint8_t pinName) {
+  return findDigitalInput(pinName) != -1;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if a digital pin is phase B of a quadrature encoder.
+    @param    pinName
+              The pin's name.
+    @returns  True if an encoder reads the pin as its phase B, False
+              otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::isEncoderPin(uint8_t pinName) {
+  for (int i = 0; i < _digitalInputCount; i++) {
+    if (isEncoder(&_digital_input_pins[i]) &&
+        _digital_input_pins[i].encoderPin == pinName)
+      return true;
+  }
+  return false;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Returns the number of digital input slots which are not in use.
+    @returns  Number of free slots within _digital_input_pins[].
+*/
+/********************************************************************************************************************************/
+int32_t Wippersnapper_DigitalGPIO::freeDigitalInputSlots() {
+  return _totalDigitalInputPins - _digitalInputCount;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if the board has a digital pin.
+    @param    pinName
+              The pin's name.
+    @param    output
+              True if the pin must be able to drive an output.
+    @returns  True if the pin exists and supports the direction, False
+              otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::isValidDigitalPin(uint8_t pinName,
+                                                  bool output) {
+#if defined(ARDUINO_ARCH_SAMD)
+  (void)output;
+  return pinName < PINS_COUNT &&
+         g_APinDescription[pinName].ulPinType != PIO_NOT_A_PIN &&
+         g_APinDescription[pinName].ulPort < WS_PORT_GROUPS;
+#elif defined(ARDUINO_ARCH_ESP32)
+  return GPIO_IS_VALID_GPIO(pinName) &&
+         (!output || GPIO_IS_VALID_OUTPUT_GPIO(pinName));
+#elif defined(NUM_DIGITAL_PINS)
+  (void)output;
+  return pinName < NUM_DIGITAL_PINS;
+#else
+  (void)output;
+  return true;
+#endif
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if two pins share an external interrupt line. SAMD
+              pins on the same EXTINT line share a single handler,
+              attaching one pin's interrupt replaces the other's.
+    @param    pinA
+              The first pin's name.
+    @param    pinB
+              The second pin's name.
+    @returns  True if the pins differ and use the same interrupt line,
+              False otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::sharesExtInt(uint8_t pinA, uint8_t pinB) {
+#if defined(ARDUINO_ARCH_SAMD)
+  int extIntA = g_APinDescription[pinA].ulExtInt;
+  return pinA != pinB && extIntA != NOT_AN_INTERRUPT &&
+         extIntA == (int)g_APinDescription[pinB].ulExtInt;
+#else
+  (void)pinA;
+  (void)pinB;
+  return false;
+#endif
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if the external interrupt line of a pin is already
+              used by another pin's edge interrupt. Pulse captures own
+              their line from their configuration on, since they attach
+              to it every period.
+    @param    pinName
+              The pin's name.
+    @returns  True if another input or capture owns the line, False if
+              it is free or the pin has none.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::isExtIntOwned(uint8_t pinName) {
+  for (int irq = 0; irq < WS_DIGITAL_IRQ_MAX; irq++) {
+    if (irqPins[irq] == WS_DIGITAL_IRQ_FREE)
+      continue;
+    if (sharesExtInt(pinName, irqPins[irq]) ||
+        ((irqEncoding & (1 << irq)) &&
+         sharesExtInt(pinName, irqEncoderPins[irq])))
+      return true;
+  }
+  return WS._pulseCapture->usesExtInt(pinName);
+}
+
 /********************************************************************************************************************************/
 /*!
     @brief    Deinitializes a previously configured digital pin.
@@ -123,18 +665,19 @@ void Wippersnapper_DigitalGPIO::deinitDigitalPin(
   if (direction ==
       wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_INPUT) {
     // de-allocate the pin within digital_input_pins[]
-    for (int i = 0; i < _totalDigitalInputPins; i++) {
-      if (_digital_input_pins[i].pinName == pinName) {
-        _digital_input_pins[i].pinName = -1;
-        _digital_input_pins[i].period = -1;
-        _digital_input_pins[i].prvPeriod = 0L;
-        _digital_input_pins[i].prvPinVal = 0;
-        break;
-      }
+    int slot = findDigitalInput(pinName);
+    if (slot != -1) {
+      // an encoder's phase B is released along with phase A
+      if (isEncoder(&_digital_input_pins[slot]))
+        pinMode(_digital_input_pins[slot].encoderPin, INPUT);
+      _digital_input_pins[slot].period = -1;
+      // release the pin's edge interrupt and pulse counter
+      updateInputMode(slot);
+      removeDigitalInput(slot);
     }
   }
-  char cstr[16];
-  itoa(pinName, cstr, 10);
+  setDigitalOutput(pinName, false);
+  WS._lastValue->untrack(WS_CHANNEL_DIGITAL(pinName));
   pinMode(pinName, INPUT); // hi-z
 
 // if prv. in-use by DIO, release pin back to application
@@ -174,92 +717,943 @@ void Wippersnapper_DigitalGPIO::digitalWriteSvc(uint8_t pinName, int pinValue) {
   WS_DEBUG_PRINT(" to ");
   WS_DEBUG_PRINTLN(pinValue);
   digitalWrite(pinName, pinValue);
+  WS._lastValue->update(WS_CHANNEL_DIGITAL(pinName), 0, pinValue);
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Writes a list of levels to digital outputs at once. The levels
+            are gathered into set and clear masks per GPIO port, then
+            written back to back with interrupts disabled, so every
+            output of a port changes in the same instant. Platforms
+            without port registers write each pin in turn. Pins which
+            are not configured digital outputs are removed from the list
+            and left untouched.
+    @param  pinWrites
+                The outputs and their levels.
+    @returns  True if every pin was written, False if any was removed.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::digitalWritePins(digitalPinWrites *pinWrites) {
+  // OUTSET on a SAMD input switches its pull-up, only write outputs
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < pinWrites->count; i++) {
+    if (!isDigitalOutput(pinWrites->writes[i].pinName)) {
+      WS_DEBUG_PRINT("ERROR: Not a digital output, ignoring event for D");
+      WS_DEBUG_PRINTLN(pinWrites->writes[i].pinName);
+      continue;
+    }
+    pinWrites->writes[count++] = pinWrites->writes[i];
+  }
+  bool is_success = count == pinWrites->count;
+  pinWrites->count = count;
+  WS_DEBUG_PRINT("Digital Pin Events: Writing pins: ");
+  WS_DEBUG_PRINTLN(pinWrites->count);
+#ifdef WS_INPUT_PORTS
+  uint32_t set[WS_INPUT_PORTS] = {0};
+  uint32_t clear[WS_INPUT_PORTS] = {0};
+  for (uint8_t i = 0; i < pinWrites->count; i++) {
+    uint8_t port, bit;
+    inputPortBit(pinWrites->writes[i].pinName, &port, &bit);
+    if (pinWrites->writes[i].value)
+      set[port] |= (1UL << bit);
+    else
+      clear[port] |= (1UL << bit);
+  }
+  noInterrupts();
+#if defined(ARDUINO_ARCH_SAMD)
+  for (uint8_t port = 0; port < WS_INPUT_PORTS; port++) {
+    if (set[port] != 0)
+      PORT->Group[port].OUTSET.reg = set[port];
+    if (clear[port] != 0)
+      PORT->Group[port].OUTCLR.reg = clear[port];
+  }
+#else
+  REG_WRITE(GPIO_OUT_W1TS_REG, set[0]);
+  REG_WRITE(GPIO_OUT_W1TC_REG, clear[0]);
+#ifdef GPIO_OUT1_W1TS_REG
+  REG_WRITE(GPIO_OUT1_W1TS_REG, set[1]);
+  REG_WRITE(GPIO_OUT1_W1TC_REG, clear[1]);
+#endif
+#endif
+  interrupts();
+#else
+  for (uint8_t i = 0; i < pinWrites->count; i++)
+    digitalWrite(pinWrites->writes[i].pinName, pinWrites->writes[i].value);
+#endif
+  for (uint8_t i = 0; i < pinWrites->count; i++)
+    WS._lastValue->update(WS_CHANNEL_DIGITAL(pinWrites->writes[i].pinName), 0,
+                          pinWrites->writes[i].value);
+  return is_success;
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Checks if a digital pin is configured as an output.
+    @param    pinName
+              The pin's name.
+    @returns  True if the pin is a configured output, False otherwise.
+*/
+/********************************************************************************************************************************/
+bool Wippersnapper_DigitalGPIO::isDigitalOutput(uint8_t pinName) {
+  return pinName < WS_PIN_INDEX_SIZE &&
+         (_outputPins[pinName / 32] & (1UL << (pinName % 32)));
+}
+
+/********************************************************************************************************************************/
+/*!
+    @brief    Records whether a digital pin is configured as an output.
+    @param    pinName
+              The pin's name.
+    @param    output
+              True if the pin is now an output, False otherwise.
+*/
+/********************************************************************************************************************************/
+void Wippersnapper_DigitalGPIO::setDigitalOutput(uint8_t pinName, bool output) {
+  if (pinName >= WS_PIN_INDEX_SIZE)
+    return;
+  if (output)
+    _outputPins[pinName / 32] |= (1UL << (pinName % 32));
+  else
+    _outputPins[pinName / 32] &= ~(1UL << (pinName % 32));
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Reads a digital input pin outside of its schedule, storing the
+            value within the last-value cache. Pulse counting inputs keep
+            the rate of their last period, encoders store their position.
+    @param  pinName
+                The pin's name.
+    @returns  True if the pin is a configured input, False otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::readDigitalInput(uint8_t pinName) {
+  int slot = findDigitalInput(pinName);
+  if (slot == -1)
+    return false;
+  if (isEncoder(&_digital_input_pins[slot])) {
+    WS._lastValue->update(
+        WS_CHANNEL_DIGITAL(pinName), 0,
+        (int32_t)readPulseCount(&_digital_input_pins[slot], NULL));
+    return true;
+  }
+  // a pulse rate is only known at the end of the input's period
+  if (_digital_input_pins[slot].period == 0L ||
+      _digital_input_pins[slot].readMode !=
+          wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_PULSE_COUNT)
+    WS._lastValue->update(WS_CHANNEL_DIGITAL(pinName), 0,
+                          digitalReadSvc(pinName));
+  return true;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Checks if an input decodes a quadrature encoder.
+    @param  input
+                The input.
+    @returns  True if the input is an enabled quadrature encoder.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::isEncoder(digitalInputPin *input) {
+  return input->period >= 0L &&
+         input->readMode ==
+             wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Attaches an edge interrupt to an on-change input, a pulse
+            counter to a pulse counting input or quadrature encoder, or
+            releases those an input no longer uses. On-change inputs
+            fall back to polling when the pin has no interrupt, another
+            pin uses its interrupt line or every edge handler is in use.
+            Pulses and encoder steps are counted by the ESP32's PCNT
+            peripheral while it has a free unit, by edge interrupts
+            otherwise.
+    @param  slot
+                The input's index within _digital_input_pins[].
+*/
+/*******************************************************************************/
+void Wippersnapper_DigitalGPIO::updateInputMode(int slot) {
+  digitalInputPin *input = &_digital_input_pins[slot];
+  _portMasksDirty = true;
+  // pulses are counted over a period, without one the level is published
+  bool encoder = isEncoder(input);
+  bool counting =
+      encoder ||
+      (input->period > 0L &&
+       input->readMode ==
+           wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_PULSE_COUNT);
+  bool onChange = input->period == 0L && !encoder;
+  if (input->irq != -1 &&
+      (!(onChange || counting) ||
+       counting != ((irqCounting & (1 << input->irq)) != 0) ||
+       encoder != ((irqEncoding & (1 << input->irq)) != 0))) {
+    detachInterrupt(digitalPinToInterrupt(input->pinName));
+    if (irqEncoding & (1 << input->irq))
+      detachInterrupt(digitalPinToInterrupt(irqEncoderPins[input->irq]));
+    irqCounting &= ~(1 << input->irq);
+    irqEncoding &= ~(1 << input->irq);
+    irqPins[input->irq] = WS_DIGITAL_IRQ_FREE;
+    input->irq = -1;
+  }
+  if (!counting)
+    releasePulseCounter(input);
+  if (!(onChange || counting) || input->irq != -1 || input->pcntUnit != -1)
+    return;
+  if (counting && attachPulseCounter(input))
+    return;
+  if (digitalPinToInterrupt(input->pinName) == NOT_AN_INTERRUPT ||
+      (encoder &&
+       (digitalPinToInterrupt(input->encoderPin) == NOT_AN_INTERRUPT ||
+        sharesExtInt(input->pinName, input->encoderPin)))) {
+    if (counting) {
+      WS_DEBUG_PRINTLN("ERROR: Pin has no interrupt, unable to count pulses");
+    }
+    return;
+  }
+  // attaching to a line another pin uses would take over its handler
+  if (isExtIntOwned(input->pinName) ||
+      (encoder && isExtIntOwned(input->encoderPin))) {
+    if (counting) {
+      WS_DEBUG_PRINTLN("ERROR: Interrupt line in use, unable to count pulses");
+    } else {
+      WS_DEBUG_PRINTLN("Interrupt line in use, polling the pin instead");
+    }
+    return;
+  }
+
+  for (int8_t irq = 0; irq < WS_DIGITAL_IRQ_MAX; irq++) {
+    if (irqPins[irq] != WS_DIGITAL_IRQ_FREE)
+      continue;
+    irqPins[irq] = input->pinName;
+    input->irq = irq;
+    if (encoder) {
+      // both phases share a handler, which steps on every change
+      irqCounts[irq] = 0;
+      irqEncoderPins[irq] = input->encoderPin;
+      irqEncoderStates[irq] =
+          (digitalRead(input->pinName) << 1) | digitalRead(input->encoderPin);
+      irqCounting |= (1 << irq);
+      irqEncoding |= (1 << irq);
+      input->count = 0;
+      input->prvCount = 0;
+      input->prvPeriod = millis();
+      attachInterrupt(digitalPinToInterrupt(input->pinName), edgeIsrs[irq],
+                      CHANGE);
+      attachInterrupt(digitalPinToInterrupt(input->encoderPin), edgeIsrs[irq],
+                      CHANGE);
+      WS_DEBUG_PRINT("Decoding quadrature encoder on D");
+      WS_DEBUG_PRINT(input->pinName);
+      WS_DEBUG_PRINTLN(" by interrupt");
+      return;
+    }
+    if (counting) {
+      irqCounts[irq] = 0;
+      irqEdgeTimes[irq] = 0;
+      irqCounting |= (1 << irq);
+      setPulseFilter(input);
+      input->count = 0;
+      input->prvCount = 0;
+      input->prvEdgeTime = 0;
+      input->prvPeriod = millis();
+      attachInterrupt(digitalPinToInterrupt(input->pinName), edgeIsrs[irq],
+                      RISING);
+      WS_DEBUG_PRINT("Counting pulses of D");
+      WS_DEBUG_PRINT(input->pinName);
+      WS_DEBUG_PRINTLN(" by interrupt");
+      return;
+    }
+    attachInterrupt(digitalPinToInterrupt(input->pinName), edgeIsrs[irq],
+                    CHANGE);
+    _edgeResync = true; // poll the pin once to pick up its current level
+    WS_DEBUG_PRINT("Capturing edges of D");
+    WS_DEBUG_PRINT(input->pinName);
+    WS_DEBUG_PRINTLN(" by interrupt");
+    return;
+  }
+  if (counting) {
+    WS_DEBUG_PRINTLN("ERROR: No free edge interrupt, unable to count pulses");
+  } else {
+    WS_DEBUG_PRINTLN("No free edge interrupt, polling the pin instead");
+  }
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Counts the pulses of an input with a free unit of the ESP32's
+            PCNT peripheral, counting rising edges. Quadrature encoders
+            use both channels of the unit, each counting the edges of
+            one phase in the direction given by the other phase, so
+            every edge of either phase is a step.
+    @param  input
+                The pulse counting input or quadrature encoder.
+    @returns  True if a counter unit was attached, False if the board has
+              no PCNT peripheral or every unit is in use.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::attachPulseCounter(digitalInputPin *input) {
+#ifdef WS_HAS_PCNT
+  for (int unit = 0; unit < PCNT_UNIT_MAX; unit++) {
+    bool used = false;
+    for (int i = 0; i < _digitalInputCount; i++)
+      used |= _digital_input_pins[i].pcntUnit == unit;
+    if (used)
+      continue;
+
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = input->pinName;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.counter_h_lim = WS_PCNT_HIGH_LIMIT;
+    config.counter_l_lim = 0;
+    config.unit = (pcnt_unit_t)unit;
+    config.channel = PCNT_CHANNEL_0;
+    bool configured;
+    if (isEncoder(input)) {
+      // A leading B counts up, phase B reverses the count while it is high
+      config.ctrl_gpio_num = input->encoderPin;
+      config.hctrl_mode = PCNT_MODE_REVERSE;
+      config.neg_mode = PCNT_COUNT_DEC;
+      config.counter_l_lim = -WS_PCNT_HIGH_LIMIT;
+      configured = pcnt_unit_config(&config) == ESP_OK;
+      // channel 1 counts phase B, phase A reverses the count while it is high
+      config.pulse_gpio_num = input->encoderPin;
+      config.ctrl_gpio_num = input->pinName;
+      config.pos_mode = PCNT_COUNT_DEC;
+      config.neg_mode = PCNT_COUNT_INC;
+      config.channel = PCNT_CHANNEL_1;
+      configured = configured && pcnt_unit_config(&config) == ESP_OK;
+    } else {
+      configured = pcnt_unit_config(&config) == ESP_OK;
+    }
+    if (!configured) {
+      WS_DEBUG_PRINTLN("ERROR: Unable to configure pulse counter");
+      return false;
+    }
+    // the limit events add each wrapped count to pcntWraps[]
+    if (!pcntIsrInstalled) {
+      esp_err_t err = pcnt_isr_service_install(0);
+      pcntIsrInstalled = err == ESP_OK || err == ESP_ERR_INVALID_STATE;
+    }
+    if (!pcntIsrInstalled ||
+        pcnt_isr_handler_add((pcnt_unit_t)unit, isrPcntLimit,
+                             (void *)(intptr_t)unit) != ESP_OK) {
+      WS_DEBUG_PRINTLN("ERROR: Unable to attach pulse counter interrupt");
+      return false;
+    }
+    input->pcntUnit = unit;
+    setPulseFilter(input);
+    pcnt_counter_pause((pcnt_unit_t)unit);
+    pcnt_counter_clear((pcnt_unit_t)unit);
+    pcntWraps[unit] = 0;
+    pcnt_event_enable((pcnt_unit_t)unit, PCNT_EVT_H_LIM);
+    if (isEncoder(input))
+      pcnt_event_enable((pcnt_unit_t)unit, PCNT_EVT_L_LIM);
+    pcnt_counter_resume((pcnt_unit_t)unit);
+    input->pcntPrv = 0;
+    input->count = 0;
+    input->prvCount = 0;
+    input->prvEdgeTime = 0;
+    input->prvPeriod = millis();
+    WS_DEBUG_PRINT("Counting pulses of D");
+    WS_DEBUG_PRINT(input->pinName);
+    WS_DEBUG_PRINT(" with PCNT unit ");
+    WS_DEBUG_PRINTLN(unit);
+    return true;
+  }
+#endif
+  (void)input;
+  return false;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Releases the PCNT unit counting an input's pulses, if any.
+    @param  input
+                The input.
+*/
+/*******************************************************************************/
+void Wippersnapper_DigitalGPIO::releasePulseCounter(digitalInputPin *input) {
+  if (input->pcntUnit == -1)
+    return;
+#ifdef WS_HAS_PCNT
+  pcnt_counter_pause((pcnt_unit_t)input->pcntUnit);
+  pcnt_event_disable((pcnt_unit_t)input->pcntUnit, PCNT_EVT_H_LIM);
+  pcnt_event_disable((pcnt_unit_t)input->pcntUnit, PCNT_EVT_L_LIM);
+  pcnt_isr_handler_remove((pcnt_unit_t)input->pcntUnit);
+  pcnt_set_pin((pcnt_unit_t)input->pcntUnit, PCNT_CHANNEL_0, PCNT_PIN_NOT_USED,
+               PCNT_PIN_NOT_USED);
+  pcnt_set_pin((pcnt_unit_t)input->pcntUnit, PCNT_CHANNEL_1, PCNT_PIN_NOT_USED,
+               PCNT_PIN_NOT_USED);
+#endif
+  input->pcntUnit = -1;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Applies an input's settle time to its pulse counter. Pulses
+            closer than the settle time are ignored as glitches. The PCNT
+            filter is limited to about 12us.
+    @param  input
+                The pulse counting input.
+*/
+/*******************************************************************************/
+void Wippersnapper_DigitalGPIO::setPulseFilter(digitalInputPin *input) {
+  if (input->irq != -1)
+    irqDeadTimes[input->irq] = input->debounceUs;
+#ifdef WS_HAS_PCNT
+  if (input->pcntUnit == -1)
+    return;
+  pcnt_unit_t unit = (pcnt_unit_t)input->pcntUnit;
+  if (input->debounceUs == 0) {
+    pcnt_filter_disable(unit);
+    return;
+  }
+  // the filter is set in APB clock cycles, 80 per microsecond
+  uint32_t cycles = input->debounceUs * 80;
+  pcnt_set_filter_value(unit, cycles < WS_PCNT_FILTER_MAX ? cycles
+                                                          : WS_PCNT_FILTER_MAX);
+  pcnt_filter_enable(unit);
+#endif
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Returns the pulses counted by an input since it was configured,
+            or the position of a quadrature encoder. PCNT counters reset
+            to 0 at WS_PCNT_HIGH_LIMIT pulses, the limit event handler
+            accumulates each wrap so reads may be any time apart.
+    @param  input
+                The pulse counting input or quadrature encoder.
+    @param  edgeTime
+                Set to the time of the last pulse in micros, 0 if unknown.
+                May be NULL.
+    @returns  Number of pulses counted, wrapping around.
+*/
+/*******************************************************************************/
+uint32_t Wippersnapper_DigitalGPIO::readPulseCount(digitalInputPin *input,
+                                                   uint32_t *edgeTime) {
+  uint32_t time = 0;
+#ifdef WS_HAS_PCNT
+  if (input->pcntUnit != -1) {
+    pcnt_unit_t unit = (pcnt_unit_t)input->pcntUnit;
+    int16_t value;
+    uint32_t wraps;
+    bool read;
+    // read again if the counter wrapped between the two reads
+    do {
+      wraps = pcntWraps[unit];
+      read = pcnt_get_counter_value(unit, &value) == ESP_OK;
+    } while (read && wraps != pcntWraps[unit]);
+    if (read) {
+      uint32_t position = wraps + (uint32_t)(int32_t)value;
+      input->count += position - input->pcntPrv;
+      input->pcntPrv = position;
+    }
+  }
+#endif
+  if (input->irq != -1) {
+    noInterrupts();
+    input->count = irqCounts[input->irq];
+    time = irqEdgeTimes[input->irq];
+    interrupts();
+  }
+  if (edgeTime != NULL)
+    *edgeTime = time;
+  return input->count;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Publishes the pulses a counting input saw during its period:
+            the total count, the average rate over the period and, when
+            pulses are timestamped by interrupt, the frequency measured
+            between the last pulse of the previous period and the last
+            pulse of this one.
+    @param  input
+                The pulse counting input.
+    @param  curTime
+                The current time, in millis.
+    @returns  True if the pulse count was encoded, False otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::publishPulseCount(digitalInputPin *input,
+                                                  long curTime) {
+  uint32_t edgeTime;
+  uint32_t count = readPulseCount(input, &edgeTime);
+  uint32_t pulses = count - input->prvCount;
+
+  wippersnapper_signal_v1_CreateSignalRequest msg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+  msg.which_payload =
+      wippersnapper_signal_v1_CreateSignalRequest_pin_count_event_tag;
+  wippersnapper_pin_v1_PinCountEvent *event = &msg.payload.pin_count_event;
+  event->pin_id = WS_CHANNEL_DIGITAL(input->pinName);
+  event->count = count;
+  event->rate = pulses * 1000.0 / (curTime - input->prvPeriod);
+  if (pulses > 0 && edgeTime != 0 && input->prvEdgeTime != 0)
+    event->frequency = pulses * 1000000.0 / (edgeTime - input->prvEdgeTime);
+  input->prvCount = count;
+  if (pulses > 0)
+    input->prvEdgeTime = edgeTime;
+  WS._lastValue->update(WS_CHANNEL_DIGITAL(input->pinName), 0, event->rate);
+
+  WS_DEBUG_PRINT("Encoding pulse count...");
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
+  if (!pb_encode(&stream, wippersnapper_signal_v1_CreateSignalRequest_fields,
+                 &msg)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode pulse count");
+    return false;
+  }
+  WS_DEBUG_PRINTLN("Encoded!");
+  WS_DEBUG_PRINT("Publishing pulse count...");
+  WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing,
+                  stream.bytes_written, WS_MSG_CLASS_TELEMETRY,
+                  WS_CHANNEL_DIGITAL(input->pinName));
+  WS_DEBUG_PRINTLN("Published!");
+  return true;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Publishes the position of a quadrature encoder and its velocity
+            since the position was last published.
+    @param  input
+                The quadrature encoder.
+    @param  curTime
+                The current time, in millis.
+    @param  msgClass
+                The message's class, telemetry at the end of a period and
+                state once the encoder moved past its change threshold.
+    @returns  True if the encoder event was encoded, False otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::publishEncoder(digitalInputPin *input,
+                                               long curTime,
+                                               ws_msg_class_t msgClass) {
+  uint32_t position = readPulseCount(input, NULL);
+  long elapsed = curTime - input->prvPeriod;
+
+  wippersnapper_signal_v1_CreateSignalRequest msg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+  msg.which_payload =
+      wippersnapper_signal_v1_CreateSignalRequest_pin_encoder_event_tag;
+  wippersnapper_pin_v1_PinEncoderEvent *event = &msg.payload.pin_encoder_event;
+  event->pin_id = WS_CHANNEL_DIGITAL(input->pinName);
+  event->position = (int32_t)position;
+  if (elapsed <= 0)
+    elapsed = 1; // moved again within the same millisecond
+  event->velocity = (int32_t)(position - input->prvCount) * 1000.0 / elapsed;
+  input->prvCount = position;
+  WS._lastValue->update(WS_CHANNEL_DIGITAL(input->pinName), 0,
+                        event->position);
+
+  WS_DEBUG_PRINT("Encoding encoder position...");
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
+  if (!pb_encode(&stream, wippersnapper_signal_v1_CreateSignalRequest_fields,
+                 &msg)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode encoder position");
+    return false;
+  }
+  WS_DEBUG_PRINTLN("Encoded!");
+  WS_DEBUG_PRINT("Publishing encoder position...");
+  WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing,
+                  stream.bytes_written, msgClass,
+                  WS_CHANNEL_DIGITAL(input->pinName));
+  WS_DEBUG_PRINTLN("Published!");
+  return true;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Publishes the value of a digital input.
+    @param  pinName
+                The pin's name.
+    @param  pinVal
+                The pin's value.
+    @param  msgClass
+                The message's class, telemetry for periodic reads and
+                state for changes.
+    @returns  True if the pin event was encoded, False otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::publishPinEvent(uint8_t pinName, int pinVal,
+                                                ws_msg_class_t msgClass) {
+  // Create new signal message
+  wippersnapper_signal_v1_CreateSignalRequest _outgoingSignalMsg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+
+  WS_DEBUG_PRINT("Encoding pinEvent...");
+  // Create and encode a pinEvent message
+  if (!WS.encodePinEvent(&_outgoingSignalMsg, pinName, pinVal)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode pinEvent");
+    return false;
+  }
+  WS_DEBUG_PRINTLN("Encoded!");
+
+  // Obtain size and only write out buffer to end
+  size_t msgSz;
+  pb_get_encoded_size(&msgSz,
+                      wippersnapper_signal_v1_CreateSignalRequest_fields,
+                      &_outgoingSignalMsg);
+  WS_DEBUG_PRINT("Publishing pinEvent...");
+  WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing, msgSz,
+                  msgClass, WS_CHANNEL_DIGITAL(pinName));
+  WS_DEBUG_PRINTLN("Published!");
+  return true;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Drains the edges captured by interrupt, oldest first, and
+            publishes every change of level. Edges of pins which were
+            deinitialized since are dropped.
+    @returns  True if the levels of interrupt-driven inputs must be polled,
+              because edges were lost to a full ring or an interrupt was
+              attached since the last call.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::processDigitalEdges() {
+  uint32_t curTime = micros();
+  while (edgeTail != edgeHead) {
+    uint8_t tail = edgeTail;
+    uint32_t edgeTime = edgeRing[tail].time;
+    uint8_t pinName = edgeRing[tail].pinName;
+    int pinVal = edgeRing[tail].level;
+    edgeTail = (tail + 1) & (WS_DIGITAL_EDGE_RING_SIZE - 1);
+
+    int slot = findDigitalInput(pinName);
+    if (slot == -1)
+      continue;
+    digitalInputPin *input = &_digital_input_pins[slot];
+    if (input->irq == -1 || !debounce(input, pinVal, edgeTime))
+      continue;
+    WS._lastValue->update(WS_CHANNEL_DIGITAL(pinName), 0, input->prvPinVal);
+    WS_DEBUG_PRINT("Executing edge event on D");
+    WS_DEBUG_PRINT(pinName);
+    WS_DEBUG_PRINT(", captured (us ago): ");
+    WS_DEBUG_PRINTLN(curTime - edgeTime);
+    publishPinEvent(pinName, input->prvPinVal, WS_MSG_CLASS_STATE);
+    input->prvPeriod = millis();
+  }
+
+  bool resync = _edgeResync;
+  _edgeResync = false;
+  uint32_t overflow = edgeOverflow;
+  if (overflow != _prvEdgeOverflow) {
+    WS_DEBUG_PRINT("ERROR: Edges lost, ring full: ");
+    WS_DEBUG_PRINTLN(overflow - _prvEdgeOverflow);
+    _prvEdgeOverflow = overflow;
+    resync = true;
+  }
+  return resync;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Feeds a sample of an on-change input to its debouncer. A level
+            is stable once it held for the input's settle time, levels
+            which revert earlier are counted as bounces and never
+            published. Without a settle time every change is stable.
+    @param  input
+                The on-change input.
+    @param  pinVal
+                The level sampled.
+    @param  time
+                When the level was sampled, in micros.
+    @returns  True if the input's stable level, prvPinVal, changed and
+              must be published.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::debounce(digitalInputPin *input, int pinVal,
+                                         uint32_t time) {
+  bool changed = false;
+  // a pending level which held until this sample has settled
+  if (input->rawPinVal != input->prvPinVal &&
+      time - input->rawTime >= input->debounceUs) {
+    input->prvPinVal = input->rawPinVal;
+    changed = true;
+  }
+  if (pinVal != input->rawPinVal) {
+    if (input->rawPinVal != input->prvPinVal) {
+      input->bounces++;
+      WS_DEBUG_PRINT("Bounce suppressed on D");
+      WS_DEBUG_PRINT(input->pinName);
+      WS_DEBUG_PRINT(", total: ");
+      WS_DEBUG_PRINTLN(input->bounces);
+    }
+    input->rawPinVal = pinVal;
+    input->rawTime = time;
+  }
+  if (input->debounceUs == 0 && input->rawPinVal != input->prvPinVal) {
+    input->prvPinVal = input->rawPinVal;
+    changed = true;
+  }
+  return changed;
 }
 
 /**********************************************************/
 /*!
     @brief    Iterates thru digital inputs, checks if they
-                should send data to the broker.
+                should send data to the broker. On-change
+                inputs with an edge interrupt are only polled
+                when their edges must be resynchronized, the
+                others are sampled a whole input register at a
+                time where the board allows it.
 */
 /**********************************************************/
 void Wippersnapper_DigitalGPIO::processDigitalInputs() {
+  bool resync = processDigitalEdges();
   long curTime = millis();
+#ifdef WS_INPUT_PORTS
+  if (!scanInputPorts(curTime))
+    return;
+#endif
   // Process digital digital pins
-  for (int i = 0; i < _totalDigitalInputPins; i++) {
-    if (_digital_input_pins[i].period >
-        -1L) { // validate if digital pin is enabled
-      // Check if digital pin executes on a time period
-      if (curTime - _digital_input_pins[i].prvPeriod >
-              _digital_input_pins[i].period &&
-          _digital_input_pins[i].period != 0L) {
-        WS_DEBUG_PRINT("Executing periodic event on D");
-        WS_DEBUG_PRINTLN(_digital_input_pins[i].pinName);
-        // read the pin
-        int pinVal = digitalReadSvc(_digital_input_pins[i].pinName);
-
-        // Create new signal message
-        wippersnapper_signal_v1_CreateSignalRequest _outgoingSignalMsg =
-            wippersnapper_signal_v1_CreateSignalRequest_init_zero;
-
-        WS_DEBUG_PRINT("Encoding...")
-        // Create and encode a pinEvent message
-        if (!WS.encodePinEvent(&_outgoingSignalMsg,
-                               _digital_input_pins[i].pinName, pinVal)) {
-          WS_DEBUG_PRINTLN("ERROR: Unable to encode pinEvent");
-          break;
-        }
-        WS_DEBUG_PRINTLN("Encoded!")
-
-        // Obtain size and only write out buffer to end
-        size_t msgSz;
-        pb_get_encoded_size(&msgSz,
-                            wippersnapper_signal_v1_CreateSignalRequest_fields,
-                            &_outgoingSignalMsg);
-
-        WS_DEBUG_PRINT("Publishing pinEvent...");
-        WS.publish(WS._topic_signal_device, WS._buffer_outgoing, msgSz, 1);
-        WS_DEBUG_PRINTLN("Published!");
-
-        // reset the digital pin
-        _digital_input_pins[i].prvPeriod = curTime;
-      } else if (_digital_input_pins[i].period == 0L) {
-        // read pin
-        int pinVal = digitalReadSvc(_digital_input_pins[i].pinName);
-        // only send on-change
-        if (pinVal != _digital_input_pins[i].prvPinVal) {
-          WS_DEBUG_PRINT("Executing state-based event on D");
-          WS_DEBUG_PRINTLN(_digital_input_pins[i].pinName);
-
-          // Create new signal message
-          wippersnapper_signal_v1_CreateSignalRequest _outgoingSignalMsg =
-              wippersnapper_signal_v1_CreateSignalRequest_init_zero;
-
-          WS_DEBUG_PRINT("Encoding pinEvent...");
-          // Create and encode a pinEvent message
-          if (!WS.encodePinEvent(&_outgoingSignalMsg,
-                                 _digital_input_pins[i].pinName, pinVal)) {
-            WS_DEBUG_PRINTLN("ERROR: Unable to encode pinEvent");
-            break;
-          }
-          WS_DEBUG_PRINTLN("Encoded!");
-
-          // Obtain size and only write out buffer to end
-          size_t msgSz;
-          pb_get_encoded_size(
-              &msgSz, wippersnapper_signal_v1_CreateSignalRequest_fields,
-              &_outgoingSignalMsg);
-          WS_DEBUG_PRINT("Publishing pinEvent...");
-          WS.publish(WS._topic_signal_device, WS._buffer_outgoing, msgSz, 1);
-          WS_DEBUG_PRINTLN("Published!");
-
-          // set the pin value in the digital pin object for comparison on next
-          // run
-          _digital_input_pins[i].prvPinVal = pinVal;
-
-          // reset the digital pin
-          _digital_input_pins[i].prvPeriod = curTime;
-        }
-      }
+  for (int i = 0; i < _digitalInputCount; i++) {
+    // keep up with the pin's PCNT counter, it wraps around quickly
+    if (_digital_input_pins[i].pcntUnit != -1)
+      readPulseCount(&_digital_input_pins[i], NULL);
+    // encoders publish at the end of their period or once they moved
+    if (isEncoder(&_digital_input_pins[i])) {
+      digitalInputPin *input = &_digital_input_pins[i];
+      int32_t steps = readPulseCount(input, NULL) - input->prvCount;
+      bool moved = input->changeThreshold != 0 &&
+                   (uint32_t)(steps < 0 ? -steps : steps) >=
+                       input->changeThreshold;
+      if (!moved && (input->period == 0L ||
+                     curTime - input->prvPeriod <= input->period))
+        continue;
+      WS_DEBUG_PRINT("Executing encoder event on D");
+      WS_DEBUG_PRINTLN(input->pinName);
+      if (!publishEncoder(input, curTime,
+                          moved ? WS_MSG_CLASS_STATE : WS_MSG_CLASS_TELEMETRY))
+        break;
+      input->prvPeriod = curTime;
+      continue;
+    }
+    // Check if digital pin executes on a time period
+    if (curTime - _digital_input_pins[i].prvPeriod >
+            _digital_input_pins[i].period &&
+        _digital_input_pins[i].period != 0L &&
+        _digital_input_pins[i].readMode ==
+            wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_PULSE_COUNT) {
+      WS_DEBUG_PRINT("Executing pulse count event on D");
+      WS_DEBUG_PRINTLN(_digital_input_pins[i].pinName);
+      if (!publishPulseCount(&_digital_input_pins[i], curTime))
+        break;
+      _digital_input_pins[i].prvPeriod = curTime;
+    } else if (curTime - _digital_input_pins[i].prvPeriod >
+                   _digital_input_pins[i].period &&
+               _digital_input_pins[i].period != 0L) {
+      WS_DEBUG_PRINT("Executing periodic event on D");
+      WS_DEBUG_PRINTLN(_digital_input_pins[i].pinName);
+      // read the pin
+      int pinVal = digitalReadSvc(_digital_input_pins[i].pinName);
+      WS._lastValue->update(
+          WS_CHANNEL_DIGITAL(_digital_input_pins[i].pinName), 0, pinVal);
+
+      if (!publishPinEvent(_digital_input_pins[i].pinName, pinVal,
+                           WS_MSG_CLASS_TELEMETRY))
+        break;
+
+      // reset the digital pin
+      _digital_input_pins[i].prvPeriod = curTime;
+    } else if (_digital_input_pins[i].period == 0L) {
+      digitalInputPin *input = &_digital_input_pins[i];
+#ifdef WS_INPUT_PORTS
+      // polled inputs were sampled by scanInputPorts()
+      if (input->irq == -1)
+        continue;
+#endif
+      // inputs with an edge interrupt are only read to resynchronize,
+      // otherwise their last captured level may still have to settle
+      int pinVal = input->rawPinVal;
+      if (input->irq == -1 || resync)
+        pinVal = digitalReadSvc(input->pinName);
+      else if (pinVal == input->prvPinVal)
+        continue;
+      if (!sampleInput(input, pinVal, curTime))
+        break;
     }
   }
-}
\ No newline at end of file
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Feeds a sample of an on-change input to its debouncer, caches
+            its stable level and publishes it once it changed.
+    @param  input
+                The on-change input.
+    @param  pinVal
+                The level sampled.
+    @param  curTime
+                The current time, in millis.
+    @returns  False if the pin event could not be encoded, True otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::sampleInput(digitalInputPin *input,
+                                            int pinVal, long curTime) {
+  // only send stable changes
+  bool changed = debounce(input, pinVal, micros());
+  WS._lastValue->update(WS_CHANNEL_DIGITAL(input->pinName), 0,
+                        input->prvPinVal);
+  if (!changed)
+    return true;
+  WS_DEBUG_PRINT("Executing state-based event on D");
+  WS_DEBUG_PRINTLN(input->pinName);
+  if (!publishPinEvent(input->pinName, input->prvPinVal, WS_MSG_CLASS_STATE))
+    return false;
+  // reset the digital pin
+  input->prvPeriod = curTime;
+  return true;
+}
+
+#ifdef WS_INPUT_PORTS
+/*******************************************************************************/
+/*!
+    @brief  Locates a pin within the board's input registers.
+    @param  pinName
+                The pin's name.
+    @param  port
+                Index of the pin's input register.
+    @param  bit
+                The pin's bit within its input register.
+*/
+/*******************************************************************************/
+void Wippersnapper_DigitalGPIO::inputPortBit(uint8_t pinName, uint8_t *port,
+                                             uint8_t *bit) {
+#if defined(ARDUINO_ARCH_SAMD)
+  *port = g_APinDescription[pinName].ulPort;
+  *bit = g_APinDescription[pinName].ulPin;
+#else
+  *port = pinName >> 5;
+  *bit = pinName & 31;
+#endif
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Reads the levels of every pin of an input register at once.
+            May be called from interrupt context.
+    @param  port
+                Index of the input register.
+    @returns  The register's value, a bit per pin.
+*/
+/*******************************************************************************/
+uint32_t IRAM_ATTR Wippersnapper_DigitalGPIO::readInputPort(uint8_t port) {
+#if defined(ARDUINO_ARCH_SAMD)
+  return PORT->Group[port].IN.reg;
+#else
+  if (port == 0)
+    return REG_READ(GPIO_IN_REG);
+#ifdef GPIO_IN1_REG
+  return REG_READ(GPIO_IN1_REG); // GPIO 32-39 sit in the low bits
+#else
+  return 0;
+#endif
+#endif
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Finds the polled on-change input at a bit of an input register.
+    @param  port
+                Index of the input register.
+    @param  bit
+                The pin's bit within its input register.
+    @returns  The input, NULL if it was deinitialized since the masks were
+              built.
+*/
+/*******************************************************************************/
+digitalInputPin *Wippersnapper_DigitalGPIO::findPortInput(uint8_t port,
+                                                          uint8_t bit) {
+  for (int i = 0; i < _digitalInputCount; i++) {
+    digitalInputPin *input = &_digital_input_pins[i];
+    if (input->period != 0L || input->irq != -1 || isEncoder(input))
+      continue;
+    uint8_t inputPort, inputBit;
+    inputPortBit(input->pinName, &inputPort, &inputBit);
+    if (inputPort == port && inputBit == bit)
+      return input;
+  }
+  return NULL;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Rebuilds the masks of polled on-change inputs, per input
+            register, after inputs were configured or released. Each
+            input's last sampled level and whether that level is still
+            settling are carried over.
+*/
+/*******************************************************************************/
+void Wippersnapper_DigitalGPIO::buildPortMasks() {
+  for (uint8_t port = 0; port < WS_INPUT_PORTS; port++) {
+    _portMasks[port] = 0;
+    _portLevels[port] = 0;
+    _portSettling[port] = 0;
+  }
+  for (int i = 0; i < _digitalInputCount; i++) {
+    digitalInputPin *input = &_digital_input_pins[i];
+    if (input->period != 0L || input->irq != -1 || isEncoder(input))
+      continue;
+    uint8_t port, bit;
+    inputPortBit(input->pinName, &port, &bit);
+    if (port >= WS_INPUT_PORTS)
+      continue;
+    _portMasks[port] |= (1UL << bit);
+    if (input->rawPinVal)
+      _portLevels[port] |= (1UL << bit);
+    if (input->rawPinVal != input->prvPinVal)
+      _portSettling[port] |= (1UL << bit);
+  }
+  _portMasksDirty = false;
+}
+
+/*******************************************************************************/
+/*!
+    @brief  Samples every polled on-change input with a single read of
+            each input register in use. Only the inputs whose level
+            differs from the previous scan, or is still settling, are fed
+            to their debouncer, so the cost of a scan grows with the
+            number of registers rather than the number of inputs.
+    @param  curTime
+                The current time, in millis.
+    @returns  False if a pin event could not be encoded, True otherwise.
+*/
+/*******************************************************************************/
+bool Wippersnapper_DigitalGPIO::scanInputPorts(long curTime) {
+  if (_portMasksDirty)
+    buildPortMasks();
+  for (uint8_t port = 0; port < WS_INPUT_PORTS; port++) {
+    if (_portMasks[port] == 0)
+      continue;
+    uint32_t levels = readInputPort(port) & _portMasks[port];
+    uint32_t pending = (levels ^ _portLevels[port]) | _portSettling[port];
+    _portLevels[port] = levels;
+    // walk the changed and settling bits, lowest first
+    while (pending != 0) {
+      uint8_t bit = __builtin_ctz(pending);
+      pending &= pending - 1;
+      digitalInputPin *input = findPortInput(port, bit);
+      if (input == NULL)
+        continue;
+      if (!sampleInput(input, (levels >> bit) & 1, curTime))
+        return false;
+      if (input->rawPinVal != input->prvPinVal)
+        _portSettling[port] |= (1UL << bit);
+      else
+        _portSettling[port] &= ~(1UL << bit);
+    }
+  }
+  return true;
+}
+#endif
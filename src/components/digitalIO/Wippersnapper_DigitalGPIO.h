@@ -16,14 +16,73 @@
 #ifndef WIPPERSNAPPER_DIGITALGPIO_H
 #define WIPPERSNAPPER_DIGITALGPIO_H
 
+#include <stdint.h>
+
+// Queued commands hold a list of writes, Wippersnapper.h needs it first
+#define WS_DIGITAL_WRITE_LIST_MAX                                              \
+  16 ///< Most outputs written by a single list of pin events
+
+/** A level to write to a digital output */
+struct digitalPinWrite {
+  uint8_t pinName; ///< Pin name
+  uint8_t value;   ///< Level to write, LOW or HIGH
+};
+
+/** Levels written to several digital outputs at once */
+struct digitalPinWrites {
+  uint8_t count;                                     ///< Levels to write
+  digitalPinWrite writes[WS_DIGITAL_WRITE_LIST_MAX]; ///< Pins and levels
+};
+
 #include "Wippersnapper.h"
 
+#ifndef WS_DIGITAL_EDGE_RING_SIZE
+#define WS_DIGITAL_EDGE_RING_SIZE                                              \
+  32 ///< Edges buffered between calls to processDigitalInputs(), must be a
+     ///< power of two
+#endif
+#define WS_DIGITAL_IRQ_MAX 8 ///< Maximum number of interrupt-driven inputs
+#ifndef WS_DIGITAL_WRITE_ACK
+#define WS_DIGITAL_WRITE_ACK                                                   \
+  1 ///< Publish the new levels of the outputs once a list is written
+#endif
+
+// Polled on-change inputs are scanned a whole input register at a time
+#if defined(ARDUINO_ARCH_SAMD)
+#define WS_PORT_GROUPS 4 ///< Most PORT groups on a SAMD21/SAMD51 (A-D)
+#define WS_INPUT_PORTS WS_PORT_GROUPS ///< Input registers, one per PORT group
+#elif defined(ARDUINO_ARCH_ESP32)
+#define WS_INPUT_PORTS 2 ///< Input registers, GPIO 0-31 and GPIO 32-39
+#endif
+
 /** Holds data about a digital input pin */
 struct digitalInputPin {
+  uint8_t pinName;          ///< Pin name, phase A of a quadrature encoder
+  long period;              ///< Timer interval, in millis, -1 if disabled.
+  long prvPeriod;           ///< When timer was previously serviced, in millis
+  int prvPinVal;            ///< Previous pin value
+  int8_t irq;               ///< Edge interrupt handler, -1 if the pin is polled
+  uint32_t debounceUs;      ///< Time a level must hold to publish, 0 if off
+  int rawPinVal;            ///< Last level seen, possibly still bouncing
+  uint32_t rawTime;         ///< When rawPinVal was first seen, in micros
+  uint32_t bounces;         ///< Level changes suppressed as bounces
+  uint8_t readMode;         ///< Level, pulses or encoder, a DigitalReadMode
+  uint8_t encoderPin;       ///< Phase B of a quadrature encoder
+  uint32_t changeThreshold; ///< Encoder steps which trigger a publish, 0 if off
+  int8_t pcntUnit;          ///< ESP32 pulse counter unit, -1 if not in use
+  uint32_t pcntPrv;         ///< Pulse counter with its wraps, when last read
+  uint32_t count;           ///< Pulses counted since configured, or encoder
+                            ///< position, wraps around
+  uint32_t prvCount;        ///< Pulses counted or position when last published
+  uint32_t prvEdgeTime;     ///< Time of the last pulse when last published, in
+                            ///< micros, 0 if unknown
+};
+
+/** An edge of an on-change digital input, captured by its interrupt */
+struct digitalEdge {
+  uint32_t time;   ///< When the edge occurred, in micros
   uint8_t pinName; ///< Pin name
-  long period;     ///< Timer interval, in millis, -1 if disabled.
-  long prvPeriod;  ///< When timer was previously serviced, in millis
-  int prvPinVal;   ///< Previous pin value
+  uint8_t level;   ///< Pin level read after the edge
 };
 
 // forward decl.
@@ -43,19 +102,73 @@ public:
   void
   initDigitalPin(wippersnapper_pin_v1_ConfigurePinRequest_Direction direction,
                  uint8_t pinName, float period,
-                 wippersnapper_pin_v1_ConfigurePinRequest_Pull pull);
+                 wippersnapper_pin_v1_ConfigurePinRequest_Pull pull,
+                 uint32_t debounceUs,
+                 wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode
+                     readMode,
+                 uint8_t encoderPin, uint32_t changeThreshold);
   void
   deinitDigitalPin(wippersnapper_pin_v1_ConfigurePinRequest_Direction direction,
                    uint8_t pinName);
+  bool setDigitalInputPeriod(uint8_t pinName, float period);
+  bool setDigitalInputDebounce(uint8_t pinName, uint32_t debounceUs);
+  bool initDigitalPins(wippersnapper_pin_v1_ConfigurePinRequest *pinMsgs[],
+                       size_t count, std::vector<bool> &configured);
+  bool isDigitalInput(uint8_t pinName);
+  bool isDigitalOutput(uint8_t pinName);
+  bool isEncoderPin(uint8_t pinName);
+  int32_t freeDigitalInputSlots();
+  static bool isValidDigitalPin(uint8_t pinName, bool output);
+  static bool sharesExtInt(uint8_t pinA, uint8_t pinB);
+  static bool isExtIntOwned(uint8_t pinName);
 
   int digitalReadSvc(int pinName);
   void digitalWriteSvc(uint8_t pinName, int pinValue);
+  bool digitalWritePins(digitalPinWrites *pinWrites);
+  bool readDigitalInput(uint8_t pinName);
   void processDigitalInputs();
+#ifdef WS_INPUT_PORTS
+  static void inputPortBit(uint8_t pinName, uint8_t *port, uint8_t *bit);
+  static uint32_t readInputPort(uint8_t port);
+#endif
 
-  digitalInputPin *_digital_input_pins; /*!< Array of gpio pin objects */
+  digitalInputPin *_digital_input_pins; /*!< Array of gpio pin objects, the
+                                           configured inputs first */
 private:
+  void clearDigitalInput(digitalInputPin *input);
+  int findDigitalInput(uint8_t pinName);
+  int addDigitalInput(uint8_t pinName);
+  void removeDigitalInput(int slot);
+  void setDigitalOutput(uint8_t pinName, bool output);
+  void updateInputMode(int slot);
+  bool isEncoder(digitalInputPin *input);
+  bool attachPulseCounter(digitalInputPin *input);
+  void releasePulseCounter(digitalInputPin *input);
+  void setPulseFilter(digitalInputPin *input);
+  uint32_t readPulseCount(digitalInputPin *input, uint32_t *edgeTime);
+  bool publishPulseCount(digitalInputPin *input, long curTime);
+  bool publishEncoder(digitalInputPin *input, long curTime,
+                      ws_msg_class_t msgClass);
+  bool processDigitalEdges();
+  bool debounce(digitalInputPin *input, int pinVal, uint32_t time);
+  bool sampleInput(digitalInputPin *input, int pinVal, long curTime);
+#ifdef WS_INPUT_PORTS
+  digitalInputPin *findPortInput(uint8_t port, uint8_t bit);
+  void buildPortMasks();
+  bool scanInputPorts(long curTime);
+  uint32_t _portMasks[WS_INPUT_PORTS];    /*!< Polled on-change inputs */
+  uint32_t _portLevels[WS_INPUT_PORTS];   /*!< Their levels when last read */
+  uint32_t _portSettling[WS_INPUT_PORTS]; /*!< Inputs whose level settles */
+#endif
+  bool _portMasksDirty = true; /*!< Inputs changed since the masks were built */
+  bool publishPinEvent(uint8_t pinName, int pinVal, ws_msg_class_t msgClass);
+  uint32_t _prvEdgeOverflow = 0; /*!< Edges lost when last checked */
+  bool _edgeResync = false;      /*!< Poll interrupt-driven inputs once */
   int32_t
       _totalDigitalInputPins; /*!< Total number of digital-input capable pins */
+  int32_t _digitalInputCount = 0; /*!< Configured inputs */
+  uint8_t *_pinSlots;             /*!< Slot of each pin or WS_PIN_NO_SLOT */
+  uint32_t *_outputPins;          /*!< Bit per pin, set for outputs */
 };
 extern Wippersnapper WS;
 
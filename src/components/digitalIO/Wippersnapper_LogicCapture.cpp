@@ -0,0 +1,551 @@
+/*!
+ * @file Wippersnapper_LogicCapture.cpp
+ *
+ * Samples a set of digital pins at a fixed rate over a triggered window,
+ * for remote troubleshooting of intermittent signals.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_LogicCapture.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/gpio_periph.h"
+#include "soc/io_mux_reg.h"
+#include "soc/soc.h"
+#define WS_HAS_LOGIC_TIMER ///< Samples are taken by a hardware timer
+#ifndef WS_LOGIC_CAPTURE_TIMER
+#define WS_LOGIC_CAPTURE_TIMER 1 ///< Hardware timer driving the samples
+#endif
+#define WS_LOGIC_TIMER_DIVIDER 8 ///< Divisor of the APB clock, ticks at 10MHz
+#define WS_LOGIC_TIMER_HZ                                                      \
+  (APB_CLK_FREQ / WS_LOGIC_TIMER_DIVIDER) ///< Timer tick rate, in Hz
+#elif defined(ARDUINO_ARCH_SAMD)
+#define WS_HAS_LOGIC_TIMER ///< Samples are taken by a hardware timer
+// TC3 has no handler within the core, tone() and Servo use TC4/TC5 or
+// TC0/TC1, analogWrite() may use it for a few pins
+#define WS_LOGIC_TC TC3               ///< Timer driving the samples
+#define WS_LOGIC_TC_IRQ TC3_IRQn      ///< The timer's interrupt
+#define WS_LOGIC_TIMER_HZ 48000000UL  ///< Timer tick rate, the 48MHz GCLK
+#ifdef __SAMD51__
+#define WS_LOGIC_TC_SYNC(tc)                                                   \
+  while ((tc)->COUNT16.SYNCBUSY.reg) ///< Waits for register writes to land
+#else
+#define WS_LOGIC_TC_SYNC(tc)                                                   \
+  while ((tc)->COUNT16.STATUS.bit.SYNCBUSY) ///< Waits for register writes
+#endif
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR ///< Places interrupt handlers within IRAM on ESP32
+#endif
+
+// Capture state shared with the timer interrupt. The loop only changes it
+// while the timer is stopped, or once the interrupt set WS_LOGIC_DONE.
+static uint8_t *logicRing = NULL;    ///< Ring of samples, a bit per pin
+static uint32_t logicSize = 0;       ///< Samples within the ring
+static volatile uint32_t logicHead = 0;      ///< Next sample written
+static volatile uint32_t logicCount = 0;     ///< Samples taken since armed
+static volatile uint32_t logicRemaining = 0; ///< Samples left after trigger
+static volatile uint32_t logicTriggerCount = 0;     ///< logicCount at trigger
+static volatile uint8_t logicState = WS_LOGIC_IDLE; ///< ws_logic_state_t
+static uint8_t logicTrigger = 0;     ///< A LogicCaptureRequest_Trigger
+static uint8_t logicTriggerMask = 0; ///< Bit of the trigger pin
+static uint8_t logicPrvLevels = 0;   ///< Levels of the previous sample
+static uint8_t logicPinCount = 0;    ///< Pins sampled
+static uint8_t logicPorts[WS_LOGIC_CAPTURE_MAX_PINS]; ///< Input register
+static uint8_t logicBits[WS_LOGIC_CAPTURE_MAX_PINS];  ///< Bit within it
+static uint8_t logicPortsUsed = 0; ///< Bit per input register read
+
+/**************************************************************************/
+/*!
+    @brief  Samples the pins into the ring, and ends the window once the
+            trigger fired and the samples after it were taken. Called
+            from the timer interrupt.
+*/
+/**************************************************************************/
+static inline void IRAM_ATTR logicSample() {
+#ifdef WS_INPUT_PORTS
+  uint8_t state = logicState;
+  if (state != WS_LOGIC_ARMED && state != WS_LOGIC_TRIGGERED)
+    return;
+  uint32_t ports[WS_INPUT_PORTS] = {0};
+  for (uint8_t port = 0; port < WS_INPUT_PORTS; port++) {
+    if (logicPortsUsed & (1 << port))
+      ports[port] = Wippersnapper_DigitalGPIO::readInputPort(port);
+  }
+  uint8_t levels = 0;
+  for (uint8_t i = 0; i < logicPinCount; i++)
+    levels |= ((ports[logicPorts[i]] >> logicBits[i]) & 1) << i;
+
+  uint32_t head = logicHead;
+  logicRing[head] = levels;
+  logicHead = head + 1 == logicSize ? 0 : head + 1;
+  uint32_t count = logicCount;
+  logicCount = count + 1;
+  if (state == WS_LOGIC_ARMED) {
+    uint8_t changed = (levels ^ logicPrvLevels) & logicTriggerMask;
+    logicPrvLevels = levels;
+    if (logicTrigger !=
+        wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_IMMEDIATE) {
+      // the first sample has no previous level, so no edge
+      if (count == 0 || !changed)
+        return;
+      if (logicTrigger ==
+              wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_RISING &&
+          !(levels & logicTriggerMask))
+        return;
+      if (logicTrigger ==
+              wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_FALLING &&
+          (levels & logicTriggerMask))
+        return;
+    }
+    logicTriggerCount = count;
+    logicState = WS_LOGIC_TRIGGERED;
+  }
+  if (--logicRemaining == 0)
+    logicState = WS_LOGIC_DONE;
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+static hw_timer_t *logicTimer = NULL; ///< Timer driving the samples
+
+/**************************************************************************/
+/*!
+    @brief  Timer interrupt handler, takes a sample.
+*/
+/**************************************************************************/
+static void IRAM_ATTR isrLogicTimer() { logicSample(); }
+#elif defined(ARDUINO_ARCH_SAMD)
+/**************************************************************************/
+/*!
+    @brief  TC3 interrupt handler, takes a sample.
+*/
+/**************************************************************************/
+void TC3_Handler() {
+  WS_LOGIC_TC->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+  logicSample();
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  nanopb encode callback, writes the run-length encoded samples
+            as a bytes field.
+    @param  stream
+            Output stream to write to.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            The Wippersnapper_LogicCapture instance.
+    @returns  True if the samples were encoded, False otherwise.
+*/
+/**************************************************************************/
+static bool cbEncodeRuns(pb_ostream_t *stream, const pb_field_t *field,
+                         void *const *arg) {
+  Wippersnapper_LogicCapture *capture = (Wippersnapper_LogicCapture *)*arg;
+  // bytes fields are length-prefixed, size the runs first
+  pb_ostream_t sizing = PB_OSTREAM_SIZING;
+  if (!capture->encodeRuns(&sizing))
+    return false;
+  return pb_encode_tag_for_field(stream, field) &&
+         pb_encode_varint(stream, sizing.bytes_written) &&
+         capture->encodeRuns(stream);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Creates the logic capture component, idle.
+*/
+/***********************************************************************************/
+Wippersnapper_LogicCapture::Wippersnapper_LogicCapture() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops any capture in progress.
+*/
+/***********************************************************************************/
+Wippersnapper_LogicCapture::~Wippersnapper_LogicCapture() { releaseCapture(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Arms a logic capture requested by the broker. The pins are
+            sampled in the background, process() publishes the window
+            once it is complete or the trigger timed out.
+    @param  msg
+            The decoded LogicCaptureRequest message. A window of 0
+            samples selects WS_LOGIC_CAPTURE_MAX_SAMPLES, a timeout of 0
+            selects WS_LOGIC_CAPTURE_TIMEOUT_MS.
+    @returns  True if the capture was armed, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::captureRequest(
+    wippersnapper_pin_v1_LogicCaptureRequest *msg) {
+#if defined(WS_HAS_LOGIC_TIMER) && defined(WS_INPUT_PORTS)
+  if (logicState != WS_LOGIC_IDLE) {
+    WS_DEBUG_PRINTLN("ERROR: A logic capture is already in progress");
+    return false;
+  }
+  uint32_t samples = msg->samples > 0 ? msg->samples
+                                      : WS_LOGIC_CAPTURE_MAX_SAMPLES;
+  if (msg->pins_count == 0 || msg->pins_count > WS_LOGIC_CAPTURE_MAX_PINS ||
+      msg->sample_rate_hz < WS_LOGIC_CAPTURE_MIN_RATE_HZ ||
+      msg->sample_rate_hz > WS_LOGIC_CAPTURE_MAX_RATE_HZ ||
+      samples > WS_LOGIC_CAPTURE_MAX_SAMPLES ||
+      msg->pre_trigger_samples >= samples ||
+      msg->trigger ==
+          wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_UNSPECIFIED ||
+      msg->trigger > _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_MAX) {
+    WS_DEBUG_PRINTLN("ERROR: Invalid logic capture request");
+    return false;
+  }
+  _pinCount = 0;
+  logicTriggerMask = 0;
+  logicPortsUsed = 0;
+  for (pb_size_t i = 0; i < msg->pins_count; i++) {
+    uint32_t pin = msg->pins[i];
+    if (pin > 0xFF ||
+        !Wippersnapper_DigitalGPIO::isValidDigitalPin(pin, false)) {
+      WS_DEBUG_PRINTLN("ERROR: Logic capture requested on an invalid pin");
+      return false;
+    }
+    for (uint8_t j = 0; j < _pinCount; j++) {
+      if (_pins[j] == pin) {
+        WS_DEBUG_PRINTLN("ERROR: Logic capture pin listed twice");
+        return false;
+      }
+    }
+    _pins[_pinCount] = pin;
+    Wippersnapper_DigitalGPIO::inputPortBit(pin, &logicPorts[_pinCount],
+                                            &logicBits[_pinCount]);
+    logicPortsUsed |= 1 << logicPorts[_pinCount];
+    if (pin == msg->trigger_pin)
+      logicTriggerMask = 1 << _pinCount;
+    _pinCount++;
+  }
+  if (logicTriggerMask == 0 &&
+      msg->trigger !=
+          wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_IMMEDIATE) {
+    WS_DEBUG_PRINTLN("ERROR: Logic capture trigger pin is not sampled");
+    return false;
+  }
+
+  logicRing = (uint8_t *)malloc(samples);
+  if (logicRing == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Not enough memory for the logic capture");
+    return false;
+  }
+  // the pins keep their configuration, only their input buffers are
+  // enabled so outputs and unconfigured pins read back their levels, the
+  // buffers enabled here are disabled again once the capture ends
+  _inputsEnabled = 0;
+  for (uint8_t i = 0; i < _pinCount; i++) {
+#if defined(ARDUINO_ARCH_SAMD)
+    volatile uint8_t *pincfg =
+        &PORT->Group[logicPorts[i]].PINCFG[logicBits[i]].reg;
+    if (!(*pincfg & PORT_PINCFG_INEN))
+      _inputsEnabled |= 1 << i;
+    *pincfg |= PORT_PINCFG_INEN;
+#else
+    if (!(READ_PERI_REG(GPIO_PIN_MUX_REG[_pins[i]]) & FUN_IE))
+      _inputsEnabled |= 1 << i;
+    PIN_INPUT_ENABLE(GPIO_PIN_MUX_REG[_pins[i]]);
+#endif
+  }
+  _samples = samples;
+  _preTrigger = msg->pre_trigger_samples;
+  _timeoutMs =
+      msg->timeout_ms > 0 ? msg->timeout_ms : WS_LOGIC_CAPTURE_TIMEOUT_MS;
+  _windowMs = ((uint64_t)samples * 1000 + msg->sample_rate_hz - 1) /
+              msg->sample_rate_hz;
+  logicSize = samples;
+  logicHead = 0;
+  logicCount = 0;
+  logicRemaining = samples - _preTrigger; // includes the trigger's sample
+  logicTrigger = msg->trigger;
+  logicPrvLevels = 0;
+  logicPinCount = _pinCount;
+  logicState = WS_LOGIC_ARMED;
+  if (!startTimer(msg->sample_rate_hz)) {
+    releaseCapture();
+    return false;
+  }
+  _state = WS_LOGIC_ARMED;
+  _startTime = millis();
+  WS_DEBUG_PRINT("Logic capture armed, sampling ");
+  WS_DEBUG_PRINT(_pinCount);
+  WS_DEBUG_PRINT(" pins at ");
+  WS_DEBUG_PRINT(_rateHz);
+  WS_DEBUG_PRINTLN("Hz");
+  return true;
+#else
+  (void)msg;
+  WS_DEBUG_PRINTLN("ERROR: Logic capture is not supported by this board");
+  return false;
+#endif
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the window of a completed capture, or the samples
+            taken so far if the trigger, or the window after it, timed
+            out. Returns immediately while the capture is in progress.
+*/
+/***********************************************************************************/
+void Wippersnapper_LogicCapture::process() {
+  uint8_t state = logicState;
+  if (state == WS_LOGIC_IDLE)
+    return;
+  if (state != _state) {
+    _state = state;
+    _startTime = millis();
+  }
+  // once triggered the window must end within its length, plus slack
+  uint32_t timeoutMs = state == WS_LOGIC_ARMED
+                           ? _timeoutMs
+                           : _windowMs + WS_LOGIC_CAPTURE_SLACK_MS;
+  if (state != WS_LOGIC_DONE && millis() - _startTime <= timeoutMs)
+    return;
+  stopTimer();
+  // re-read, the trigger may have fired before the timer stopped
+  state = logicState;
+  bool triggered = state != WS_LOGIC_ARMED;
+  if (!triggered) {
+    WS_DEBUG_PRINTLN("Logic capture trigger timed out");
+  } else if (state != WS_LOGIC_DONE) {
+    WS_DEBUG_PRINTLN("Logic capture window timed out");
+  }
+  if (!publishCapture(triggered))
+    WS_DEBUG_PRINTLN("ERROR: Unable to publish the logic capture");
+  releaseCapture();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes the published samples as runs, each a byte of levels,
+            bit n for pins[n], followed by the run's length in samples as
+            a varint.
+    @param  stream
+            Output stream to write to, may be a sizing stream.
+    @returns  True if the runs were written, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::encodeRuns(pb_ostream_t *stream) {
+  uint32_t idx = _encodeFirst;
+  uint32_t left = _encodeCount;
+  while (left > 0) {
+    uint8_t levels = logicRing[idx];
+    uint32_t run = 0;
+    while (left > 0 && logicRing[idx] == levels) {
+      run++;
+      left--;
+      idx = idx + 1 == logicSize ? 0 : idx + 1;
+    }
+    if (!pb_write(stream, &levels, 1) || !pb_encode_varint(stream, run))
+      return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Starts the timer which takes the samples.
+    @param  rateHz
+            Requested sample rate, in Hz.
+    @returns  True if the timer started, False if it is in use.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::startTimer(uint32_t rateHz) {
+#ifdef WS_HAS_LOGIC_TIMER
+  uint32_t ticks = WS_LOGIC_TIMER_HZ / rateHz;
+  _rateHz = WS_LOGIC_TIMER_HZ / ticks;
+#endif
+#if defined(ARDUINO_ARCH_ESP32)
+  logicTimer =
+      timerBegin(WS_LOGIC_CAPTURE_TIMER, WS_LOGIC_TIMER_DIVIDER, true);
+  if (logicTimer == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: Logic capture timer is in use");
+    return false;
+  }
+  timerAttachInterrupt(logicTimer, isrLogicTimer, false);
+  timerAlarmWrite(logicTimer, ticks, true);
+  timerAlarmEnable(logicTimer);
+  _timerRunning = true;
+  return true;
+#elif defined(ARDUINO_ARCH_SAMD)
+  Tc *tc = WS_LOGIC_TC;
+  if (tc->COUNT16.CTRLA.bit.ENABLE) {
+    WS_DEBUG_PRINTLN("ERROR: Logic capture timer is in use by analogWrite()");
+    return false;
+  }
+#ifdef __SAMD51__
+  GCLK->PCHCTRL[TC3_GCLK_ID].reg =
+      GCLK_PCHCTRL_GEN_GCLK1_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_TC3;
+#else
+  GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 |
+                                 GCLK_CLKCTRL_ID_TCC2_TC3);
+  while (GCLK->STATUS.bit.SYNCBUSY)
+    ;
+  PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+#endif
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  WS_LOGIC_TC_SYNC(tc);
+  // match frequency mode, the counter restarts on reaching CC0
+#ifdef __SAMD51__
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV1;
+  tc->COUNT16.WAVE.reg = TC_WAVE_WAVEGEN_MFRQ;
+#else
+  tc->COUNT16.CTRLA.reg =
+      TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV1;
+#endif
+  WS_LOGIC_TC_SYNC(tc);
+  tc->COUNT16.CC[0].reg = ticks - 1;
+  WS_LOGIC_TC_SYNC(tc);
+  tc->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+  NVIC_ClearPendingIRQ(WS_LOGIC_TC_IRQ);
+  NVIC_EnableIRQ(WS_LOGIC_TC_IRQ);
+  tc->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+  WS_LOGIC_TC_SYNC(tc);
+  _timerRunning = true;
+  return true;
+#else
+  (void)rateHz;
+  return false;
+#endif
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops the timer which takes the samples.
+*/
+/***********************************************************************************/
+void Wippersnapper_LogicCapture::stopTimer() {
+  if (!_timerRunning)
+    return; // the timer may be used by others while idle
+  _timerRunning = false;
+#if defined(ARDUINO_ARCH_ESP32)
+  timerAlarmDisable(logicTimer);
+  timerDetachInterrupt(logicTimer);
+  timerEnd(logicTimer);
+  logicTimer = NULL;
+#elif defined(ARDUINO_ARCH_SAMD)
+  Tc *tc = WS_LOGIC_TC;
+  NVIC_DisableIRQ(WS_LOGIC_TC_IRQ);
+  tc->COUNT16.INTENCLR.reg = TC_INTENCLR_MC0;
+  tc->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  WS_LOGIC_TC_SYNC(tc);
+#endif
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the samples within the ring as a LogicCapture
+            message, in chunks if it exceeds the outgoing buffer.
+    @param  triggered
+            True if the trigger fired, False if it timed out.
+    @returns  True if the capture was published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::publishCapture(bool triggered) {
+  // the ring holds the last logicSize samples, oldest at its head once full
+  uint32_t count = logicCount;
+  _encodeCount = min(count, logicSize);
+  _encodeFirst = count > logicSize ? logicHead : 0;
+
+  wippersnapper_signal_v1_CreateSignalRequest msg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+  msg.which_payload =
+      wippersnapper_signal_v1_CreateSignalRequest_logic_capture_tag;
+  wippersnapper_pin_v1_LogicCapture *capture = &msg.payload.logic_capture;
+  capture->pins_count = _pinCount;
+  for (uint8_t i = 0; i < _pinCount; i++)
+    capture->pins[i] = _pins[i];
+  capture->sample_rate_hz = _rateHz;
+  capture->sample_count = _encodeCount;
+  capture->triggered = triggered;
+  if (triggered)
+    capture->trigger_sample = _encodeCount - (count - logicTriggerCount);
+  capture->runs.funcs.encode = cbEncodeRuns;
+  capture->runs.arg = this;
+
+  WS_DEBUG_PRINT("Publishing logic capture of ");
+  WS_DEBUG_PRINT(_encodeCount);
+  WS_DEBUG_PRINTLN(" samples");
+  // Messages larger than the outgoing buffer are published in chunks
+  return WS.queuePublish(WS._topic_signal_device,
+                         wippersnapper_signal_v1_CreateSignalRequest_fields,
+                         &msg, WS_MSG_CLASS_DIAGNOSTIC);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a pin is sampled by a capture in progress.
+    @param  pinName
+            The pin's name.
+    @returns  True if the pin is sampled, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::isCapturePin(uint8_t pinName) {
+  if (logicState == WS_LOGIC_IDLE)
+    return false;
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    if (_pins[i] == pinName)
+      return true;
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a pin's PWM signal comes from the timer taking the
+            samples of a capture in progress.
+    @param  pinName
+            The pin's name.
+    @returns  True if the pin's PWM timer is in use, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LogicCapture::usesTimerOf(uint8_t pinName) {
+#if defined(ARDUINO_ARCH_SAMD)
+  uint32_t pwmChannel = g_APinDescription[pinName].ulPWMChannel;
+  return _timerRunning && pwmChannel != NOT_ON_PWM &&
+         (void *)GetTC(pwmChannel) == (void *)WS_LOGIC_TC;
+#else
+  (void)pinName;
+  return false;
+#endif
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops any capture in progress, restores the input buffers it
+            enabled and frees its samples.
+*/
+/***********************************************************************************/
+void Wippersnapper_LogicCapture::releaseCapture() {
+  stopTimer();
+  logicState = WS_LOGIC_IDLE;
+  _state = WS_LOGIC_IDLE;
+#ifdef WS_HAS_LOGIC_TIMER
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    if (!(_inputsEnabled & (1 << i)))
+      continue;
+#if defined(ARDUINO_ARCH_SAMD)
+    PORT->Group[logicPorts[i]].PINCFG[logicBits[i]].reg &= ~PORT_PINCFG_INEN;
+#else
+    PIN_INPUT_DISABLE(GPIO_PIN_MUX_REG[_pins[i]]);
+#endif
+  }
+#endif
+  _inputsEnabled = 0;
+  free(logicRing);
+  logicRing = NULL;
+  logicSize = 0;
+}
@@ -0,0 +1,94 @@
+/*!
+ * @file Wippersnapper_LogicCapture.h
+ *
+ * Samples a set of digital pins at a fixed rate over a triggered window,
+ * for remote troubleshooting of intermittent signals.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_LOGICCAPTURE_H
+#define WIPPERSNAPPER_LOGICCAPTURE_H
+
+#include "Wippersnapper.h"
+
+#ifndef WS_LOGIC_CAPTURE_MAX_SAMPLES
+#if defined(ARDUINO_ARCH_ESP32)
+#define WS_LOGIC_CAPTURE_MAX_SAMPLES                                           \
+  16384 ///< Longest capture window, a byte of RAM per sample
+#else
+#define WS_LOGIC_CAPTURE_MAX_SAMPLES                                           \
+  4096 ///< Longest capture window, a byte of RAM per sample
+#endif
+#endif
+#define WS_LOGIC_CAPTURE_MAX_PINS 8 ///< Pins sampled at once, a bit each
+#define WS_LOGIC_CAPTURE_MIN_RATE_HZ 1000 ///< Slowest sample rate, in Hz
+#define WS_LOGIC_CAPTURE_MAX_RATE_HZ 50000 ///< Fastest sample rate, in Hz
+#define WS_LOGIC_CAPTURE_TIMEOUT_MS                                            \
+  60000 ///< Time to wait for the trigger if none is set, in millis
+#define WS_LOGIC_CAPTURE_SLACK_MS                                              \
+  1000 ///< Time allowed past the window's length once triggered, in millis
+
+/** Progress of a logic capture */
+typedef enum {
+  WS_LOGIC_IDLE,      ///< No capture in progress
+  WS_LOGIC_ARMED,     ///< Sampling the pre-trigger window, awaiting trigger
+  WS_LOGIC_TRIGGERED, ///< Sampling the window after the trigger
+  WS_LOGIC_DONE       ///< Window complete, waiting to be published
+} ws_logic_state_t;
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that samples up to WS_LOGIC_CAPTURE_MAX_PINS digital
+            pins from a hardware timer interrupt, reading whole input
+            registers as Wippersnapper_DigitalGPIO does. Samples fill a
+            ring buffer until the trigger fires, so the window holds the
+            levels before and after it. The window is then run-length
+            encoded and published as a LogicCapture message, in chunks
+            if it exceeds the outgoing buffer.
+*/
+/**************************************************************************/
+class Wippersnapper_LogicCapture {
+public:
+  Wippersnapper_LogicCapture();
+  ~Wippersnapper_LogicCapture();
+
+  bool captureRequest(wippersnapper_pin_v1_LogicCaptureRequest *msg);
+  void process();
+  bool encodeRuns(pb_ostream_t *stream);
+  bool isCapturePin(uint8_t pinName);
+  bool usesTimerOf(uint8_t pinName);
+
+private:
+  bool startTimer(uint32_t rateHz);
+  void stopTimer();
+  bool publishCapture(bool triggered);
+  void releaseCapture();
+  uint8_t _pins[WS_LOGIC_CAPTURE_MAX_PINS]; ///< Sampled pins, bit n is _pins[n]
+  uint8_t _pinCount = 0;      ///< Pins within _pins
+  uint32_t _rateHz = 0;       ///< Sample rate, as set by the timer, in Hz
+  uint32_t _samples = 0;      ///< Samples within the window
+  uint32_t _preTrigger = 0;   ///< Samples of the window before the trigger
+  uint32_t _timeoutMs = 0;    ///< Time to wait for the trigger, in millis
+  uint32_t _windowMs = 0;     ///< Time to sample the window, in millis
+  uint8_t _state = 0;         ///< ws_logic_state_t last seen by process()
+  uint32_t _startTime = 0;    ///< When process() saw the state begin, in millis
+  uint8_t _inputsEnabled = 0; ///< Bit per pin whose input buffer was enabled
+                              ///< for the capture, disabled on release
+  uint32_t _encodeFirst = 0;  ///< Index of the oldest sample within the ring
+  uint32_t _encodeCount = 0;  ///< Samples published from the ring
+  bool _timerRunning = false; ///< True while the timer takes samples
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_LOGICCAPTURE_H
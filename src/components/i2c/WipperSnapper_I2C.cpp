@@ -189,7 +189,27 @@ WipperSnapper_Component_I2C::scanAddresses() {
 
 /*******************************************************************************/
 /*!
-    @brief    Initializes I2C device driver.
+    @brief    Returns the driver attached at an I2C address.
+    @param    i2cAddress
+              The I2C device's address.
+    @returns  Pointer to the driver, NULL if no driver uses the address.
+*/
+/*******************************************************************************/
+WipperSnapper_I2C_Driver *
+WipperSnapper_Component_I2C::getDriver(uint16_t i2cAddress) {
+  for (size_t i = 0; i < drivers.size(); i++) {
+    if (drivers[i]->getI2CAddress() == i2cAddress)
+      return drivers[i];
+  }
+  return NULL;
+}
+
+/*******************************************************************************/
+/*!
+    @brief    Initializes I2C device driver. If a driver for the same device
+              type is already attached at the address, only its changed
+              sensors are updated. A driver for another device type at the
+              address is replaced.
     @param    msgDeviceInitReq
               A decoded I2CDevice initialization request message.
     @returns True if I2C device is initialized and attached, False otherwise.
@@ -200,6 +220,26 @@ bool WipperSnapper_Component_I2C::initI2CDevice(
   WS_DEBUG_PRINTLN("Attempting to initialize an I2C device...");
 
   uint16_t i2cAddress = (uint16_t)msgDeviceInitReq->i2c_device_address;
+
+  // Reconcile with a driver already attached at the address
+  WipperSnapper_I2C_Driver *driver = getDriver(i2cAddress);
+  if (driver != NULL) {
+    if (strcmp(driver->getDeviceName(), msgDeviceInitReq->i2c_device_name) ==
+        0) {
+      if (driver->reconfigureDriver(msgDeviceInitReq)) {
+        WS_DEBUG_PRINTLN("I2C device already initialized, sensors updated");
+      } else {
+        WS_DEBUG_PRINTLN("I2C device already initialized, unchanged");
+      }
+      trackSensors(driver);
+      _busStatusResponse =
+          wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_SUCCESS;
+      return true;
+    }
+    WS_DEBUG_PRINTLN("Replacing I2C device attached at the same address");
+    removeDriver(i2cAddress);
+  }
+
   if (strcmp("aht20", msgDeviceInitReq->i2c_device_name) == 0) {
     _ahtx0 = new WipperSnapper_I2C_Driver_AHTX0(this->_i2c, i2cAddress);
     if (!_ahtx0->isInitialized()) {
@@ -261,6 +301,8 @@ bool WipperSnapper_Component_I2C::initI2CDevice(
         wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_UNSUPPORTED_SENSOR;
     return false;
   }
+  drivers.back()->setDeviceName(msgDeviceInitReq->i2c_device_name);
+  trackSensors(drivers.back());
   _busStatusResponse = wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_SUCCESS;
   return true;
 }
@@ -309,7 +351,10 @@ void WipperSnapper_Component_I2C::updateI2CDeviceProperties(
           WS_DEBUG_PRINTLN("ERROR: Unable to determine sensor_type!");
           break;
         }
+        drivers[i]->setSensorDeadband(
+            &msgDeviceUpdateReq->i2c_device_properties[j]);
       }
+      trackSensors(drivers[i]);
     }
   }
   _busStatusResponse = wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_SUCCESS;
@@ -324,26 +369,75 @@ void WipperSnapper_Component_I2C::updateI2CDeviceProperties(
 /*******************************************************************************/
 void WipperSnapper_Component_I2C::deinitI2CDevice(
     wippersnapper_i2c_v1_I2CDeviceDeinitRequest *msgDeviceDeinitReq) {
-  uint16_t deviceAddr = (uint16_t)msgDeviceDeinitReq->i2c_device_address;
-  std::vector<WipperSnapper_I2C_Driver *>::iterator iter, end;
+  removeDriver((uint16_t)msgDeviceDeinitReq->i2c_device_address);
+  _busStatusResponse = wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_SUCCESS;
+}
 
-  for (iter = drivers.begin(), end = drivers.end(); iter != end; ++iter) {
-    if ((*iter)->getI2CAddress() == deviceAddr) {
-      // Delete the object that iter points to
-      delete *iter;
-// ESP-IDF, Erase–remove iter ptr from driver vector
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
-      *iter = nullptr;
-      drivers.erase(remove(drivers.begin(), drivers.end(), nullptr),
-                    drivers.end());
-#else
-      // Arduino can not erase-remove, erase only
-      drivers.erase(iter);
-#endif
+/*******************************************************************************/
+/*!
+    @brief    Deletes the driver attached at an I2C address.
+    @param    i2cAddress
+              The I2C device's address.
+*/
+/*******************************************************************************/
+void WipperSnapper_Component_I2C::removeDriver(uint16_t i2cAddress) {
+  for (size_t i = 0; i < drivers.size(); i++) {
+    if (drivers[i]->getI2CAddress() == i2cAddress) {
+      // Delete the driver object and remove it from the driver vector
+      WS._lastValue->untrack(WS_CHANNEL_I2C(i2cAddress));
+      delete drivers[i];
+      drivers.erase(drivers.begin() + i);
       WS_DEBUG_PRINTLN("I2C Device De-initialized!");
+      return;
     }
   }
-  _busStatusResponse = wippersnapper_i2c_v1_BusResponse_BUS_RESPONSE_SUCCESS;
+}
+
+/*******************************************************************************/
+/*!
+    @brief    Caches the values of a driver's enabled sensors within the
+              last-value cache, and stops caching its disabled sensors.
+    @param    driver
+              The I2C device's driver.
+*/
+/*******************************************************************************/
+void WipperSnapper_Component_I2C::trackSensors(
+    WipperSnapper_I2C_Driver *driver) {
+  uint16_t channel = WS_CHANNEL_I2C(driver->getI2CAddress());
+  for (int type = _wippersnapper_i2c_v1_SensorType_MIN + 1;
+       type < _wippersnapper_i2c_v1_SensorType_ARRAYSIZE; type++) {
+    if (driver->sensorPeriod((wippersnapper_i2c_v1_SensorType)type) != 0L)
+      WS._lastValue->track(channel, type);
+    else
+      WS._lastValue->untrack(channel, type);
+  }
+}
+
+/*******************************************************************************/
+/*!
+    @brief    Reads every enabled sensor of an I2C device outside of their
+              schedules, storing the values within the last-value cache.
+    @param    i2cAddress
+              The I2C device's address.
+    @returns  True if a driver is attached at the address, False otherwise.
+*/
+/*******************************************************************************/
+bool WipperSnapper_Component_I2C::readI2CDevice(uint16_t i2cAddress) {
+  WipperSnapper_I2C_Driver *driver = getDriver(i2cAddress);
+  if (driver == NULL)
+    return false;
+  uint16_t channel = WS_CHANNEL_I2C(i2cAddress);
+  for (int type = _wippersnapper_i2c_v1_SensorType_MIN + 1;
+       type < _wippersnapper_i2c_v1_SensorType_ARRAYSIZE; type++) {
+    if (driver->sensorPeriod((wippersnapper_i2c_v1_SensorType)type) == 0L)
+      continue;
+    float value;
+    if (driver->readSensor((wippersnapper_i2c_v1_SensorType)type, &value))
+      WS._lastValue->update(channel, type, value);
+    else
+      WS._lastValue->updateFailed(channel, type);
+  }
+  return true;
 }
 
 /*******************************************************************************/
@@ -376,8 +470,9 @@ bool WipperSnapper_Component_I2C::encodePublishI2CDeviceEventMsg(
   pb_get_encoded_size(&msgSz, wippersnapper_signal_v1_I2CResponse_fields,
                       msgi2cResponse);
   WS_DEBUG_PRINT("PUBLISHING -> I2C Device Sensor Event Message...");
-  if (!WS._mqtt->publish(WS._topic_signal_i2c_device, WS._buffer_outgoing,
-                         msgSz, 1)) {
+  if (!WS.queuePublish(WS._topic_signal_i2c_device, WS._buffer_outgoing, msgSz,
+                       WS_MSG_CLASS_TELEMETRY,
+                       WS_CHANNEL_I2C(sensorAddress))) {
     return false;
   };
   WS_DEBUG_PRINTLN("PUBLISHED!");
@@ -434,11 +529,15 @@ void WipperSnapper_Component_I2C::update() {
     // Event struct
     sensors_event_t event;
 
+    // Sampling periods are stretched while the outbound link is congested
+    uint16_t channel = WS_CHANNEL_I2C((*iter)->getI2CAddress());
+
     // AMBIENT_TEMPERATURE sensor
     curTime = millis();
     if ((*iter)->sensorAmbientTemperaturePeriod() != 0L &&
         curTime - (*iter)->sensorAmbientTemperaturePeriodPrv() >
-            (*iter)->sensorAmbientTemperaturePeriod()) {
+            WS._outbound->samplingPeriod(
+                channel, (*iter)->sensorAmbientTemperaturePeriod())) {
       if ((*iter)->getEventAmbientTemperature(&event)) {
         WS_DEBUG_PRINT("Sensor 0x");
         WS_DEBUG_PRINTHEX((*iter)->getI2CAddress());
@@ -456,6 +555,9 @@ void WipperSnapper_Component_I2C::update() {
       } else {
         WS_DEBUG_PRINTLN(
             "ERROR: Failed to get ambient temperature sensor reading!");
+        WS._lastValue->updateFailed(
+            channel,
+            wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE);
       }
     }
 
@@ -463,7 +565,8 @@ void WipperSnapper_Component_I2C::update() {
     curTime = millis();
     if ((*iter)->sensorRelativeHumidityPeriod() != 0L &&
         curTime - (*iter)->sensorRelativeHumidityPeriodPrv() >
-            (*iter)->sensorRelativeHumidityPeriod()) {
+            WS._outbound->samplingPeriod(
+                channel, (*iter)->sensorRelativeHumidityPeriod())) {
       if ((*iter)->getEventRelativeHumidity(&event)) {
         WS_DEBUG_PRINT("Sensor 0x");
         WS_DEBUG_PRINTHEX((*iter)->getI2CAddress());
@@ -480,6 +583,9 @@ void WipperSnapper_Component_I2C::update() {
         (*iter)->setSensorRelativeHumidityPeriodPrv(curTime);
       } else {
         WS_DEBUG_PRINTLN("ERROR: Failed to get humidity sensor reading!");
+        WS._lastValue->updateFailed(
+            channel,
+            wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY);
       }
     }
 
@@ -487,7 +593,8 @@ void WipperSnapper_Component_I2C::update() {
     curTime = millis();
     if ((*iter)->sensorPressurePeriod() != 0L &&
         curTime - (*iter)->sensorPressurePeriodPrv() >
-            (*iter)->sensorPressurePeriod()) {
+            WS._outbound->samplingPeriod(
+                channel, (*iter)->sensorPressurePeriod())) {
       if ((*iter)->getEventPressure(&event)) {
         WS_DEBUG_PRINT("Sensor 0x");
         WS_DEBUG_PRINTHEX((*iter)->getI2CAddress());
@@ -503,13 +610,16 @@ void WipperSnapper_Component_I2C::update() {
         (*iter)->setSensorPressurePeriodPrv(curTime);
       } else {
         WS_DEBUG_PRINTLN("ERROR: Failed to get Pressure sensor reading!");
+        WS._lastValue->updateFailed(
+            channel, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE);
       }
     }
 
     // CO2 sensor
     curTime = millis();
     if ((*iter)->sensorCO2Period() != 0L &&
-        curTime - (*iter)->sensorCO2PeriodPrv() > (*iter)->sensorCO2Period()) {
+        curTime - (*iter)->sensorCO2PeriodPrv() >
+            WS._outbound->samplingPeriod(channel, (*iter)->sensorCO2Period())) {
       if ((*iter)->getEventCO2(&event)) {
         WS_DEBUG_PRINT("Sensor 0x");
         WS_DEBUG_PRINTHEX((*iter)->getI2CAddress());
@@ -523,6 +633,8 @@ void WipperSnapper_Component_I2C::update() {
         (*iter)->setSensorCO2PeriodPrv(curTime);
       } else {
         WS_DEBUG_PRINTLN("ERROR: Failed to obtain CO2 sensor reading!");
+        WS._lastValue->updateFailed(
+            channel, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2);
       }
     }
 
@@ -530,7 +642,8 @@ void WipperSnapper_Component_I2C::update() {
     curTime = millis();
     if ((*iter)->sensorAltitudePeriod() != 0L &&
         curTime - (*iter)->sensorAltitudePeriodPrv() >
-            (*iter)->sensorAltitudePeriod()) {
+            WS._outbound->samplingPeriod(
+                channel, (*iter)->sensorAltitudePeriod())) {
       if ((*iter)->getEventAltitude(&event)) {
         WS_DEBUG_PRINT("Sensor 0x");
         WS_DEBUG_PRINTHEX((*iter)->getI2CAddress());
@@ -546,13 +659,46 @@ void WipperSnapper_Component_I2C::update() {
         (*iter)->setSensorAltitudePeriodPrv(curTime);
       } else {
         WS_DEBUG_PRINTLN("ERROR: Failed to get altitude sensor reading!");
+        WS._lastValue->updateFailed(
+            channel, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE);
       }
     }
 
+    // Suppress readings which stayed within their sensor's deadband
+    pb_size_t reportedCount = 0;
+    curTime = millis();
+    for (int i = 0;
+         i < msgi2cResponse.payload.resp_i2c_device_event.sensor_event_count;
+         i++) {
+      wippersnapper_i2c_v1_SensorEvent *sensorEvent =
+          &msgi2cResponse.payload.resp_i2c_device_event.sensor_event[i];
+      WS._lastValue->update(channel, sensorEvent->type, sensorEvent->value);
+      if ((*iter)->reportSensorEvent(sensorEvent->type, sensorEvent->value,
+                                     curTime))
+        msgi2cResponse.payload.resp_i2c_device_event
+            .sensor_event[reportedCount++] = *sensorEvent;
+    }
+    msgi2cResponse.payload.resp_i2c_device_event.sensor_event_count =
+        reportedCount;
+
     // Did this driver obtain data from sensors?
     if (msgi2cResponse.payload.resp_i2c_device_event.sensor_event_count == 0)
       continue;
 
+    // Batched channels are compressed and published together
+    if (WS._batch->isBatched(channel)) {
+      for (int i = 0;
+           i < msgi2cResponse.payload.resp_i2c_device_event.sensor_event_count;
+           i++) {
+        WS._batch->add(
+            channel,
+            msgi2cResponse.payload.resp_i2c_device_event.sensor_event[i].type,
+            msgi2cResponse.payload.resp_i2c_device_event.sensor_event[i]
+                .value);
+      }
+      continue;
+    }
+
     // Encode and publish I2CDeviceEvent message
     if (!encodePublishI2CDeviceEventMsg(&msgi2cResponse,
                                         (*iter)->getI2CAddress())) {
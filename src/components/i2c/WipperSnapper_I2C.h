@@ -45,6 +45,8 @@ public:
   wippersnapper_i2c_v1_BusResponse getBusStatus();
 
   wippersnapper_i2c_v1_I2CBusScanResponse scanAddresses();
+  WipperSnapper_I2C_Driver *getDriver(uint16_t i2cAddress);
+  bool readI2CDevice(uint16_t i2cAddress);
   bool
   initI2CDevice(wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq);
 
@@ -63,6 +65,8 @@ public:
       uint32_t sensorAddress);
 
 private:
+  void removeDriver(uint16_t i2cAddress);
+  void trackSensors(WipperSnapper_I2C_Driver *driver);
   bool _isInit = false;
   int32_t _portNum;
   TwoWire *_i2c = nullptr;
@@ -18,6 +18,20 @@
 
 #include <Adafruit_Sensor.h>
 
+#define WS_I2C_MAX_DEADBANDS                                                   \
+  6 ///< Maximum number of sensor types with a deadband, per driver
+
+/** Report-by-exception state of one of a driver's sensors */
+struct i2cSensorDeadband {
+  wippersnapper_i2c_v1_SensorType sensorType; ///< Sensor type
+  float absolute;  ///< Smallest reportable change, in the sensor's SI unit
+  float relative;  ///< Smallest reportable change, as a fraction of the value
+  long maxSilence; ///< Longest time between reports, in milliseconds
+  float prvValue;  ///< Value of the last reported reading
+  long prvReport;  ///< When the last reading was reported, in millis
+  bool reported;   ///< True once a reading has been reported
+};
+
 /**************************************************************************/
 /*!
     @brief  Base class for I2C Drivers.
@@ -42,7 +56,7 @@ public:
       @brief    Destructor for an I2C sensor.
   */
   /*******************************************************************************/
-  ~WipperSnapper_I2C_Driver() { _sensorAddress = 0; }
+  virtual ~WipperSnapper_I2C_Driver() { _sensorAddress = 0; }
 
   /*******************************************************************************/
   /*!
@@ -56,45 +70,327 @@ public:
   configureDriver(wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq) {
     int propertyIdx = 0;
     while (propertyIdx < msgDeviceInitReq->i2c_device_properties_count) {
-      switch (
-          msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_type) {
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
-        enableSensorAmbientTemperature();
-        setSensorAmbientTemperaturePeriod(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
-        enableSensorRelativeHumidity();
-        setSensorRelativeHumidityPeriod(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
-        enableSensorPressure();
-        setSensorPressurePeriod(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
-        enableSensorCO2();
-        setSensorCO2Period(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
-        enableSensorGas();
-        setSensorGasPeriod(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
-        enableSensorAltitude();
-        setSensorAltitudePeriod(
-            msgDeviceInitReq->i2c_device_properties[propertyIdx].sensor_period);
-        break;
-      default:
-        break;
-      }
+      wippersnapper_i2c_v1_I2CDeviceSensorProperties *properties =
+          &msgDeviceInitReq->i2c_device_properties[propertyIdx];
+      enableSensor(properties->sensor_type);
+      setSensorPeriod(properties->sensor_type, properties->sensor_period);
+      setSensorDeadband(properties);
       ++propertyIdx;
     }
   }
 
+  /*******************************************************************************/
+  /*!
+      @brief    Applies a re-sent I2CDeviceInitRequest to a driver which is
+                already configured. Only sensors whose period or deadband
+                changed are updated, the others keep their schedule and
+                report-by-exception state. Sensors missing from the request
+                are disabled.
+      @param    msgDeviceInitReq
+                I2CDeviceInitRequest containing a list of I2C device properties.
+      @returns  True if any sensor changed, False otherwise.
+  */
+  /*******************************************************************************/
+  bool reconfigureDriver(
+      wippersnapper_i2c_v1_I2CDeviceInitRequest *msgDeviceInitReq) {
+    static const wippersnapper_i2c_v1_SensorType sensorTypes[] = {
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE,
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY,
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE,
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2,
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE,
+        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE};
+    bool changed = false;
+
+    // Disable sensors which are no longer requested
+    for (uint8_t i = 0; i < sizeof(sensorTypes) / sizeof(sensorTypes[0]);
+         i++) {
+      if (sensorPeriod(sensorTypes[i]) == 0L)
+        continue;
+      bool requested = false;
+      for (int j = 0; j < msgDeviceInitReq->i2c_device_properties_count; j++) {
+        if (msgDeviceInitReq->i2c_device_properties[j].sensor_type ==
+            sensorTypes[i])
+          requested = true;
+      }
+      if (!requested) {
+        disableSensor(sensorTypes[i]);
+        changed = true;
+      }
+    }
+
+    // Enable new sensors and apply changed periods and deadbands
+    for (int j = 0; j < msgDeviceInitReq->i2c_device_properties_count; j++) {
+      wippersnapper_i2c_v1_I2CDeviceSensorProperties *properties =
+          &msgDeviceInitReq->i2c_device_properties[j];
+      long period = sensorPeriod(properties->sensor_type);
+      if (period != (long)properties->sensor_period * 1000) {
+        if (period == 0L)
+          enableSensor(properties->sensor_type);
+        setSensorPeriod(properties->sensor_type, properties->sensor_period);
+        changed = true;
+      }
+      if (setSensorDeadband(properties))
+        changed = true;
+    }
+    return changed;
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Enables one of the device's sensors.
+      @param    sensorType
+                The sensor's type.
+  */
+  /*******************************************************************************/
+  void enableSensor(wippersnapper_i2c_v1_SensorType sensorType) {
+    switch (sensorType) {
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
+      enableSensorAmbientTemperature();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
+      enableSensorRelativeHumidity();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
+      enableSensorPressure();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
+      enableSensorCO2();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
+      enableSensorGas();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
+      enableSensorAltitude();
+      break;
+    default:
+      break;
+    }
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Disables one of the device's sensors.
+      @param    sensorType
+                The sensor's type.
+  */
+  /*******************************************************************************/
+  void disableSensor(wippersnapper_i2c_v1_SensorType sensorType) {
+    switch (sensorType) {
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
+      disableSensorAmbientTemperature();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
+      disableSensorRelativeHumidity();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
+      disableSensorPressure();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
+      disableSensorCO2();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
+      disableSensorGas();
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
+      disableSensorAltitude();
+      break;
+    default:
+      break;
+    }
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Sets the return frequency of one of the device's sensors.
+      @param    sensorType
+                The sensor's type.
+      @param    period
+                The time interval at which to return new data, in seconds.
+  */
+  /*******************************************************************************/
+  void setSensorPeriod(wippersnapper_i2c_v1_SensorType sensorType,
+                       float period) {
+    switch (sensorType) {
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
+      setSensorAmbientTemperaturePeriod(period);
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
+      setSensorRelativeHumidityPeriod(period);
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
+      setSensorPressurePeriod(period);
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
+      setSensorCO2Period(period);
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
+      setSensorGasPeriod(period);
+      break;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
+      setSensorAltitudePeriod(period);
+      break;
+    default:
+      break;
+    }
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Gets the return frequency of one of the device's sensors.
+      @param    sensorType
+                The sensor's type.
+      @returns  The time interval between readings, in milliseconds. 0 if the
+                sensor is disabled.
+  */
+  /*******************************************************************************/
+  long sensorPeriod(wippersnapper_i2c_v1_SensorType sensorType) {
+    switch (sensorType) {
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
+      return sensorAmbientTemperaturePeriod();
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
+      return sensorRelativeHumidityPeriod();
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
+      return sensorPressurePeriod();
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
+      return sensorCO2Period();
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
+      return sensorGasPeriod();
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
+      return sensorAltitudePeriod();
+    default:
+      return 0L;
+    }
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Reads one of the device's sensors.
+      @param    sensorType
+                The sensor's type.
+      @param    value
+                The reading, in the sensor type's SI unit.
+      @returns  True if the sensor was read, False otherwise.
+  */
+  /*******************************************************************************/
+  bool readSensor(wippersnapper_i2c_v1_SensorType sensorType, float *value) {
+    sensors_event_t event;
+    switch (sensorType) {
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE:
+      if (!getEventAmbientTemperature(&event))
+        return false;
+      *value = event.temperature;
+      return true;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY:
+      if (!getEventRelativeHumidity(&event))
+        return false;
+      *value = event.relative_humidity;
+      return true;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PRESSURE:
+      if (!getEventPressure(&event))
+        return false;
+      *value = event.pressure;
+      return true;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_CO2:
+      if (!getEventCO2(&event))
+        return false;
+      *value = event.data[0];
+      return true;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_GAS_RESISTANCE:
+      if (!getEventGasResistance(&event))
+        return false;
+      *value = event.gas_resistance;
+      return true;
+    case wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_ALTITUDE:
+      if (!getEventAltitude(&event))
+        return false;
+      *value = event.data[0];
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Sets a sensor's deadband and maximum silence interval from its
+                I2C device properties. A sensor without a deadband reports
+                every reading.
+      @param    properties
+                The sensor's I2CDeviceSensorProperties.
+      @returns  True if the deadband changed, False if it was already set.
+  */
+  /*******************************************************************************/
+  bool setSensorDeadband(
+      wippersnapper_i2c_v1_I2CDeviceSensorProperties *properties) {
+    i2cSensorDeadband *deadband = NULL;
+    for (int i = 0; i < _deadbandCount; i++) {
+      if (_deadbands[i].sensorType == properties->sensor_type)
+        deadband = &_deadbands[i];
+    }
+    // Silence interval is in seconds, convert it to milliseconds
+    long maxSilence = (long)properties->sensor_max_silence * 1000;
+    if (deadband == NULL) {
+      if (_deadbandCount == WS_I2C_MAX_DEADBANDS)
+        return false;
+      deadband = &_deadbands[_deadbandCount++];
+      deadband->sensorType = properties->sensor_type;
+    } else if (deadband->absolute == properties->sensor_deadband_abs &&
+               deadband->relative == properties->sensor_deadband_rel &&
+               deadband->maxSilence == maxSilence) {
+      return false; // unchanged, keep the last reported reading
+    }
+    deadband->absolute = properties->sensor_deadband_abs;
+    deadband->relative = properties->sensor_deadband_rel;
+    deadband->maxSilence = maxSilence;
+    deadband->reported = false;
+    return true;
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Checks if a sensor reading should be reported. Readings which
+                changed by less than every configured deadband since the last
+                reported reading are suppressed, unless the sensor has been
+                silent for longer than its maximum silence interval.
+      @param    sensorType
+                The reading's sensor type.
+      @param    value
+                The reading's value.
+      @param    curTime
+                The time of the reading, in millis.
+      @returns  True if the reading should be reported, False otherwise.
+  */
+  /*******************************************************************************/
+  bool reportSensorEvent(wippersnapper_i2c_v1_SensorType sensorType,
+                         float value, long curTime) {
+    i2cSensorDeadband *deadband = NULL;
+    for (int i = 0; i < _deadbandCount; i++) {
+      if (_deadbands[i].sensorType == sensorType)
+        deadband = &_deadbands[i];
+    }
+    if (deadband == NULL ||
+        (deadband->absolute <= 0.0 && deadband->relative <= 0.0))
+      return true;
+
+    if (deadband->reported &&
+        (deadband->maxSilence == 0L ||
+         curTime - deadband->prvReport < deadband->maxSilence)) {
+      float change = fabs(value - deadband->prvValue);
+      bool inAbsolute =
+          deadband->absolute <= 0.0 || change < deadband->absolute;
+      bool inRelative = deadband->relative <= 0.0 ||
+                        change < deadband->relative * fabs(deadband->prvValue);
+      if (inAbsolute && inRelative)
+        return false;
+    }
+
+    deadband->prvValue = value;
+    deadband->prvReport = curTime;
+    deadband->reported = true;
+    return true;
+  }
+
   /*******************************************************************************/
   /*!
       @brief    Gets the initialization status of an I2C driver.
@@ -120,6 +416,26 @@ public:
   /*******************************************************************************/
   uint16_t getI2CAddress() { return _sensorAddress; }
 
+  /*******************************************************************************/
+  /*!
+      @brief    Sets the name of the I2C device's type.
+      @param    deviceName
+                The i2c_device_name the driver was created for.
+  */
+  /*******************************************************************************/
+  void setDeviceName(const char *deviceName) {
+    strncpy(_deviceName, deviceName, sizeof(_deviceName) - 1);
+    _deviceName[sizeof(_deviceName) - 1] = '\0';
+  }
+
+  /*******************************************************************************/
+  /*!
+      @brief    Gets the name of the I2C device's type.
+      @returns  The i2c_device_name the driver was created for.
+  */
+  /*******************************************************************************/
+  const char *getDeviceName() { return _deviceName; }
+
   /****************************** SENSOR_TYPE: CO2
    * *******************************/
   /*******************************************************************************/
@@ -568,13 +884,15 @@ public:
   /*!
       @brief    Base implementation - Reads a gas sensor and converts
                 the reading into the expected SI unit.
-      @param    gas_resistance
-                Gas resistor (ohms) reading.
+      @param    gasEvent
+                Gas resistor reading, in ohms.
       @returns  True if the sensor event was obtained successfully, False
                 otherwise.
   */
   /*******************************************************************************/
-  virtual bool getEventGas(uint32_t gas_resistance) { return gas_resistance; }
+  virtual bool getEventGasResistance(sensors_event_t *gasEvent) {
+    return false;
+  }
 
   /*******************************************************************************/
   /*!
@@ -676,6 +994,7 @@ protected:
   bool _isInitialized = false; ///< True if the I2C device was initialized
                                ///< successfully, False otherwise.
   uint16_t _sensorAddress;     ///< The I2C device's unique I2C address.
+  char _deviceName[15] = {0};  ///< The device's i2c_device_name
   long _tempSensorPeriod =
       0L; ///< The time period between reading the temperature sensor's value.
   long _tempSensorPeriodPrv =
@@ -700,6 +1019,10 @@ protected:
       0L; ///< The time period between reading the altitude sensor's value.
   long _altitudeSensorPeriodPrv = 0L; ///< The time when the altitude sensor
                                       ///< was last read.
+  i2cSensorDeadband
+      _deadbands[WS_I2C_MAX_DEADBANDS]; ///< Report-by-exception state of
+                                        ///< each sensor with a deadband.
+  uint8_t _deadbandCount = 0; ///< Number of sensors with a deadband.
 };
 
 #endif // WipperSnapper_I2C_Driver_H
\ No newline at end of file
@@ -0,0 +1,382 @@
+/*!
+ * @file Wippersnapper_LastValue.cpp
+ *
+ * Keeps the most recent value of every configured channel and serves
+ * read-now requests from the broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_LastValue.h"
+
+/***********************************************************************************/
+/*!
+    @brief  Creates an empty last-value cache.
+*/
+/***********************************************************************************/
+Wippersnapper_LastValue::Wippersnapper_LastValue() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Destroys the last-value cache.
+*/
+/***********************************************************************************/
+Wippersnapper_LastValue::~Wippersnapper_LastValue() {
+  delete[] _values;
+  _values = NULL;
+  _capacity = 0;
+  _count = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Sizes the cache for the hardware described by the broker: one
+            value per digital and analog pin, and WS_LAST_VALUE_I2C_SENSORS
+            values shared by the I2C devices. Values already cached are
+            kept, the cache never shrinks.
+    @param  totalPins
+            The number of digital and analog pins of the hardware.
+*/
+/***********************************************************************************/
+void Wippersnapper_LastValue::allocate(int32_t totalPins) {
+  int32_t entries = totalPins + WS_LAST_VALUE_I2C_SENSORS;
+  if (entries > WS_LAST_VALUE_MAX_ENTRIES)
+    entries = WS_LAST_VALUE_MAX_ENTRIES;
+  if (entries <= _capacity)
+    return;
+  lastValue *values = new lastValue[entries];
+  for (uint8_t i = 0; i < _count; i++)
+    values[i] = _values[i];
+  delete[] _values;
+  _values = values;
+  _capacity = (uint8_t)entries;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Starts caching the values of a channel. The channel has no
+            value until it is first read.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The I2C sensor's type, 0 for pins.
+    @returns  True if the channel is cached, False if the cache is full.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::track(uint16_t channel, uint8_t sensorType) {
+  if (find(channel, sensorType) != NULL)
+    return true;
+  if (_count == _capacity) {
+    WS_DEBUG_PRINTLN("ERROR: Last-value cache full, channel not cached");
+    return false;
+  }
+  lastValue *entry = &_values[_count++];
+  entry->channel = channel;
+  entry->sensorType = sensorType;
+  entry->quality =
+      wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_UNSPECIFIED;
+  entry->time = 0;
+  entry->value = 0.0;
+  entry->requested = false;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops caching every value of a channel.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+*/
+/***********************************************************************************/
+void Wippersnapper_LastValue::untrack(uint16_t channel) {
+  for (uint8_t i = 0; i < _count;) {
+    if (_values[i].channel == channel)
+      _values[i] = _values[--_count];
+    else
+      i++;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops caching the value of a single I2C sensor.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The sensor's type.
+*/
+/***********************************************************************************/
+void Wippersnapper_LastValue::untrack(uint16_t channel, uint8_t sensorType) {
+  lastValue *entry = find(channel, sensorType);
+  if (entry != NULL)
+    *entry = _values[--_count];
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stores a value read from a channel.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The I2C sensor's type, 0 for pins.
+    @param  value
+            The value read.
+*/
+/***********************************************************************************/
+void Wippersnapper_LastValue::update(uint16_t channel, uint8_t sensorType,
+                                     float value) {
+  lastValue *entry = find(channel, sensorType);
+  if (entry == NULL)
+    return;
+  entry->value = value;
+  entry->time = millis();
+  entry->quality = wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_GOOD;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Records a failed read of a channel, its previous value is kept.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The I2C sensor's type, 0 for pins.
+*/
+/***********************************************************************************/
+void Wippersnapper_LastValue::updateFailed(uint16_t channel,
+                                           uint8_t sensorType) {
+  lastValue *entry = find(channel, sensorType);
+  if (entry == NULL)
+    return;
+  entry->quality =
+      wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_READ_FAILED;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Serves a read-now request. Values older than the request's
+            maximum age, or whose last read failed, are read again before
+            the requested values are published.
+    @param  msg
+            The decoded ReadValuesRequest message. Requests every cached
+            channel if it lists no channels.
+    @returns  True if the values were published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::readValuesRequest(
+    wippersnapper_signal_v1_ReadValuesRequest *msg) {
+  uint32_t curTime = millis();
+  for (uint8_t i = 0; i < _count; i++) {
+    _values[i].requested = msg->channels_count == 0;
+    for (pb_size_t j = 0; j < msg->channels_count; j++) {
+      if (_values[i].channel == msg->channels[j])
+        _values[i].requested = true;
+    }
+  }
+
+  // Read stale channels, every sensor of a channel is read at once
+  uint16_t prvChannel = WS_CHANNEL_NONE;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!_values[i].requested || _values[i].channel == prvChannel ||
+        !isStale(&_values[i], curTime, msg->max_age_ms))
+      continue;
+    prvChannel = _values[i].channel;
+    if (!readNow(prvChannel)) {
+      WS_DEBUG_PRINT("ERROR: Unable to read channel 0x");
+      WS_DEBUG_PRINTHEX(prvChannel);
+      WS_DEBUG_PRINTLN("");
+    }
+    WS.feedWDT();
+  }
+
+  return publishRequested();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the cached values of a list of channels, such as the
+            outputs just written by a list of pin events.
+    @param  channels
+            The channels' identifiers, WS_CHANNEL_*.
+    @param  count
+            Number of channels within the list.
+    @returns  True if the values were published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::publishChannels(const uint16_t *channels,
+                                              uint8_t count) {
+  for (uint8_t i = 0; i < _count; i++) {
+    _values[i].requested = false;
+    for (uint8_t j = 0; j < count; j++) {
+      if (_values[i].channel == channels[j])
+        _values[i].requested = true;
+    }
+  }
+  return publishRequested();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the requested values, split across messages, then
+            clears their request.
+    @returns  True if the values were published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::publishRequested() {
+  bool is_success = true;
+  uint8_t i = 0;
+  while (i < _count) {
+    uint8_t first = i;
+    uint8_t values = 0;
+    for (; i < _count && values < WS_LAST_VALUE_MSG_MAX; i++) {
+      if (_values[i].requested)
+        values++;
+    }
+    if (values > 0 && !publishValues(first, i))
+      is_success = false;
+  }
+  for (i = 0; i < _count; i++)
+    _values[i].requested = false;
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Finds the cached value of a channel.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @param  sensorType
+            The I2C sensor's type, 0 for pins.
+    @returns  Pointer to the cached value, NULL if the channel is not cached.
+*/
+/***********************************************************************************/
+lastValue *Wippersnapper_LastValue::find(uint16_t channel,
+                                         uint8_t sensorType) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_values[i].channel == channel && _values[i].sensorType == sensorType)
+      return &_values[i];
+  }
+  return NULL;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a cached value must be read again.
+    @param  entry
+            The cached value.
+    @param  curTime
+            The current time, in millis.
+    @param  maxAge
+            Age of the oldest value which may be served, in milliseconds.
+    @returns  True if the value must be read again, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::isStale(lastValue *entry, uint32_t curTime,
+                                      uint32_t maxAge) {
+  // the last value written to an output is always current
+  if (!WS_CHANNEL_IS_I2C(entry->channel) &&
+      !WS_CHANNEL_IS_ANALOG(entry->channel) &&
+      !WS._digitalGPIO->isDigitalInput(WS_CHANNEL_ID(entry->channel)))
+    return false;
+  return entry->quality !=
+             wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_GOOD ||
+         curTime - entry->time > maxAge;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Reads a channel outside of its schedule, storing its values
+            within the cache.
+    @param  channel
+            The channel's identifier, WS_CHANNEL_*.
+    @returns  True if the channel was read, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::readNow(uint16_t channel) {
+  if (WS_CHANNEL_IS_I2C(channel)) {
+    for (size_t i = 0; i < WS.i2cComponents.size(); i++) {
+      if (WS.i2cComponents[i]->readI2CDevice(WS_CHANNEL_ID(channel)))
+        return true;
+    }
+    return false;
+  }
+  if (WS_CHANNEL_IS_ANALOG(channel))
+    return WS._analogIO->readAnalogInput(WS_CHANNEL_ID(channel));
+  return WS._digitalGPIO->readDigitalInput(WS_CHANNEL_ID(channel));
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the requested values within a range of the cache.
+    @param  first
+            Index of the range's first value.
+    @param  last
+            Index after the range's last value.
+    @returns  True if the values were published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::publishValues(uint8_t first, uint8_t last) {
+  _encodeFirst = first;
+  _encodeLast = last;
+  wippersnapper_signal_v1_CreateSignalRequest msg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+  msg.which_payload = wippersnapper_signal_v1_CreateSignalRequest_values_tag;
+  msg.payload.values.values.funcs.encode = cbEncodeValues;
+  msg.payload.values.values.arg = this;
+
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
+  if (!pb_encode(&stream, wippersnapper_signal_v1_CreateSignalRequest_fields,
+                 &msg)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode last values");
+    return false;
+  }
+  WS_DEBUG_PRINT("Publishing last values...");
+  if (!WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing,
+                       stream.bytes_written, WS_MSG_CLASS_STATE))
+    return false;
+  WS_DEBUG_PRINTLN("Published!");
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Encodes the requested values as repeated ChannelValue messages.
+    @param  stream
+            Output stream to write to.
+    @param  field
+            Message descriptor, usually autogenerated.
+    @param  arg
+            The Wippersnapper_LastValue instance.
+    @returns  True if the values were encoded, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_LastValue::cbEncodeValues(pb_ostream_t *stream,
+                                             const pb_field_t *field,
+                                             void *const *arg) {
+  Wippersnapper_LastValue *cache = (Wippersnapper_LastValue *)*arg;
+  uint32_t curTime = millis();
+  for (uint8_t i = cache->_encodeFirst; i < cache->_encodeLast; i++) {
+    lastValue *entry = &cache->_values[i];
+    if (!entry->requested)
+      continue;
+    wippersnapper_signal_v1_ChannelValue value =
+        wippersnapper_signal_v1_ChannelValue_init_zero;
+    value.channel = entry->channel;
+    value.sensor_type = entry->sensorType;
+    value.value = entry->value;
+    value.age_ms = curTime - entry->time;
+    value.quality = (wippersnapper_signal_v1_ValueQuality)entry->quality;
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(
+            stream, wippersnapper_signal_v1_ChannelValue_fields, &value))
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,84 @@
+/*!
+ * @file Wippersnapper_LastValue.h
+ *
+ * Keeps the most recent value of every configured channel and serves
+ * read-now requests from the broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_LASTVALUE_H
+#define WIPPERSNAPPER_LASTVALUE_H
+
+#include "Wippersnapper.h"
+
+#ifndef WS_LAST_VALUE_I2C_SENSORS
+#define WS_LAST_VALUE_I2C_SENSORS                                              \
+  16 ///< Number of I2C sensor values cached, across every I2C device
+#endif
+#define WS_LAST_VALUE_MAX_ENTRIES                                              \
+  255 ///< Maximum number of cached values, they are indexed by a byte
+#define WS_LAST_VALUE_MSG_MAX                                                  \
+  16 ///< Maximum number of values published within a single message
+
+/** Most recent value of a channel, or of one sensor of an I2C device */
+struct lastValue {
+  uint16_t channel;   ///< Channel identifier, WS_CHANNEL_*
+  uint8_t sensorType; ///< wippersnapper_i2c_v1_SensorType, 0 for pins
+  uint8_t quality;    ///< wippersnapper_signal_v1_ValueQuality
+  uint32_t time;      ///< When the value was read, in millis
+  float value;        ///< Value read
+  bool requested;     ///< True while the value is part of a read-now request
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that caches the most recent value, read time and quality
+            of every configured digital pin, analog pin and I2C sensor.
+            Read-now requests are answered from the cache when its values
+            are recent enough, otherwise the channel is read immediately,
+            outside of its schedule.
+*/
+/**************************************************************************/
+class Wippersnapper_LastValue {
+public:
+  Wippersnapper_LastValue();
+  ~Wippersnapper_LastValue();
+
+  void allocate(int32_t totalPins);
+  bool track(uint16_t channel, uint8_t sensorType = 0);
+  void untrack(uint16_t channel);
+  void untrack(uint16_t channel, uint8_t sensorType);
+  void update(uint16_t channel, uint8_t sensorType, float value);
+  void updateFailed(uint16_t channel, uint8_t sensorType = 0);
+
+  bool readValuesRequest(wippersnapper_signal_v1_ReadValuesRequest *msg);
+  bool publishChannels(const uint16_t *channels, uint8_t count);
+
+private:
+  lastValue *find(uint16_t channel, uint8_t sensorType);
+  bool isStale(lastValue *entry, uint32_t curTime, uint32_t maxAge);
+  bool readNow(uint16_t channel);
+  bool publishRequested();
+  bool publishValues(uint8_t first, uint8_t last);
+  static bool cbEncodeValues(pb_ostream_t *stream, const pb_field_t *field,
+                             void *const *arg);
+  lastValue *_values = NULL; ///< Cached values
+  uint8_t _capacity = 0;     ///< Number of values _values can hold
+  uint8_t _count = 0;        ///< Number of cached values
+  uint8_t _encodeFirst = 0; ///< First value encoded by cbEncodeValues()
+  uint8_t _encodeLast = 0;  ///< Value after the last encoded value
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_LASTVALUE_H
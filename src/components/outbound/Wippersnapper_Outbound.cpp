@@ -0,0 +1,630 @@
+/*!
+ * @file Wippersnapper_Outbound.cpp
+ *
+ * Prioritized queue for messages published from the device to the
+ * Adafruit IO MQTT broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_Outbound.h"
+
+/** Names of each message class, as used within secrets.json */
+static const char *msgClassNames[WS_MSG_CLASS_COUNT] = {
+    "control", "state", "telemetry", "diagnostic"};
+
+/***********************************************************************************/
+/*!
+    @brief  Allocates a queue for each outbound message class, and the
+            pool holding their payloads, and loads the
+            default QoS policy. Periodic telemetry and diagnostics are
+            published at QoS 0, commands responses and on-change state
+            at QoS 1.
+*/
+/***********************************************************************************/
+Wippersnapper_Outbound::Wippersnapper_Outbound() {
+  const uint8_t depths[WS_MSG_CLASS_COUNT] = {
+      WS_OUTBOUND_DEPTH_CONTROL, WS_OUTBOUND_DEPTH_STATE,
+      WS_OUTBOUND_DEPTH_TELEMETRY, WS_OUTBOUND_DEPTH_DIAGNOSTIC};
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    _queues[i].slots = new outboundMsg[depths[i]];
+    _queues[i].depth = depths[i];
+    _queues[i].head = 0;
+    _queues[i].count = 0;
+    _queues[i].dropped = 0;
+    _queues[i].published[0] = 0;
+    _queues[i].published[1] = 0;
+    _queues[i].failed = 0;
+  }
+  _pool = new uint8_t[WS_OUTBOUND_POOL_SIZE];
+  _classQoS[WS_MSG_CLASS_CONTROL] = 1;
+  _classQoS[WS_MSG_CLASS_STATE] = 1;
+  _classQoS[WS_MSG_CLASS_TELEMETRY] = 0;
+  _classQoS[WS_MSG_CLASS_DIAGNOSTIC] = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases all outbound queues.
+*/
+/***********************************************************************************/
+Wippersnapper_Outbound::~Wippersnapper_Outbound() {
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    delete[] _queues[i].slots;
+    _queues[i].count = 0;
+  }
+  delete[] _pool;
+  _poolUsed = 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Queues an encoded message for publishing. Control messages are
+            published immediately unless older control messages are still
+            waiting, so they never wait behind other traffic.
+    @param  topic
+            The MQTT topic to publish to. Must remain valid until published.
+    @param  payload
+            The encoded message. Copied into the queue.
+    @param  len
+            Length of the encoded message, in bytes. Messages larger than
+            WS_OUTBOUND_MAX_PAYLOAD_SIZE must be published through
+            Wippersnapper_Chunking.
+    @param  msgClass
+            The message's traffic class.
+    @param  channel
+            The channel the message belongs to, WS_CHANNEL_*. Used to look
+            up the QoS to publish with.
+    @returns  True if the message was published or queued, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::enqueue(const char *topic, uint8_t *payload,
+                                     uint16_t len, ws_msg_class_t msgClass,
+                                     uint16_t channel) {
+  outboundQueue *q = &_queues[msgClass];
+  uint8_t qos = getQoS(msgClass, channel);
+
+  if (len > WS_OUTBOUND_MAX_PAYLOAD_SIZE) {
+    WS_DEBUG_PRINTLN("ERROR: Outbound message exceeds the outgoing buffer");
+    q->dropped++;
+    return false;
+  }
+
+  if (msgClass == WS_MSG_CLASS_CONTROL && q->count == 0) {
+    if (publishMsg(topic, payload, len, qos, msgClass))
+      return true;
+    WS_DEBUG_PRINTLN("ERROR: Control message publish failed, queueing...");
+  }
+
+  if (!reserve(msgClass, len)) {
+    WS_DEBUG_PRINT("Outbound pool full, dropping message of class ");
+    WS_DEBUG_PRINTLN(msgClass);
+    q->dropped++;
+    return false;
+  }
+
+  outboundMsg *msg = &q->slots[(q->head + q->count) % q->depth];
+  msg->topic = topic;
+  msg->offset = _poolUsed;
+  msg->len = len;
+  msg->qos = qos;
+  memcpy(_pool + _poolUsed, payload, len);
+  _poolUsed += len;
+  q->count++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Makes room for a message within its class queue and the payload
+            pool. A full queue discards its oldest message. A full pool
+            discards the oldest messages of the lowest priority classes
+            first, never those of a higher priority class than the new
+            message.
+    @param  msgClass
+            The message's traffic class.
+    @param  len
+            Length of the encoded message, in bytes.
+    @returns  True if the message fits, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::reserve(ws_msg_class_t msgClass, uint16_t len) {
+  outboundQueue *q = &_queues[msgClass];
+  if (q->count == q->depth) {
+    WS_DEBUG_PRINT("Outbound queue full, dropping oldest message of class ");
+    WS_DEBUG_PRINTLN(msgClass);
+    release(msgClass);
+    q->dropped++;
+  }
+  for (int i = WS_MSG_CLASS_COUNT - 1;
+       i >= msgClass && _poolUsed + len > WS_OUTBOUND_POOL_SIZE; i--) {
+    while (_queues[i].count > 0 && _poolUsed + len > WS_OUTBOUND_POOL_SIZE) {
+      release((ws_msg_class_t)i);
+      _queues[i].dropped++;
+    }
+  }
+  return _poolUsed + len <= WS_OUTBOUND_POOL_SIZE;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Removes the oldest message of a class queue and compacts the
+            payload pool, moving the payloads queued after it down.
+    @param  msgClass
+            The message class to remove from.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::release(ws_msg_class_t msgClass) {
+  outboundQueue *q = &_queues[msgClass];
+  if (q->count == 0)
+    return;
+  outboundMsg *msg = &q->slots[q->head];
+  uint16_t offset = msg->offset;
+  uint16_t len = msg->len;
+  q->head = (q->head + 1) % q->depth;
+  q->count--;
+
+  memmove(_pool + offset, _pool + offset + len, _poolUsed - offset - len);
+  _poolUsed -= len;
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    for (int j = 0; j < _queues[i].count; j++) {
+      outboundMsg *m =
+          &_queues[i].slots[(_queues[i].head + j) % _queues[i].depth];
+      if (m->offset > offset)
+        m->offset -= len;
+    }
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes a message and updates the class counters.
+    @param  topic
+            The MQTT topic to publish to.
+    @param  payload
+            The encoded message.
+    @param  len
+            Length of the encoded message, in bytes.
+    @param  qos
+            The MQTT Quality of Service to publish with.
+    @param  msgClass
+            The message's traffic class.
+    @returns  True if the message was published, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::publishMsg(const char *topic, uint8_t *payload,
+                                        uint16_t len, uint8_t qos,
+                                        ws_msg_class_t msgClass) {
+  WS.feedWDT();
+  if (!WS._mqtt->publish(topic, payload, len, qos)) {
+    _queues[msgClass].failed++;
+    return false;
+  }
+  _queues[msgClass].published[qos > 0 ? 1 : 0]++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes the oldest message within a class queue.
+    @param  msgClass
+            The message class to publish from.
+    @returns  True if a message was published, False if the queue was
+              empty or the publish failed.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::publishNext(ws_msg_class_t msgClass) {
+  outboundQueue *q = &_queues[msgClass];
+  if (q->count == 0)
+    return false;
+
+  outboundMsg *msg = &q->slots[q->head];
+  if (!publishMsg(msg->topic, _pool + msg->offset, msg->len, msg->qos,
+                  msgClass)) {
+    // leave the message at the head of the queue and retry on the next tick
+    WS_DEBUG_PRINTLN("ERROR: Unable to publish queued message");
+    return false;
+  }
+  release(msgClass);
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes queued messages in strict priority order. Control and
+            state messages are fully drained, telemetry is limited to
+            WS_OUTBOUND_TELEMETRY_PER_TICK messages and diagnostics are only
+            sent once telemetry is idle.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::process() {
+  if (millis() - _prvStats > WS_OUTBOUND_STATS_INTERVAL_MS) {
+    printStats();
+    _prvStats = millis();
+  }
+  if (millis() - _prvBackpressure > WS_BACKPRESSURE_INTERVAL_MS) {
+    updateBackpressure();
+    _prvBackpressure = millis();
+  }
+
+  while (publishNext(WS_MSG_CLASS_CONTROL))
+    ;
+  if (queued(WS_MSG_CLASS_CONTROL) > 0)
+    return; // link is failing, hold lower-priority traffic
+  while (publishNext(WS_MSG_CLASS_STATE))
+    ;
+  if (queued(WS_MSG_CLASS_STATE) > 0)
+    return;
+  for (int i = 0; i < WS_OUTBOUND_TELEMETRY_PER_TICK; i++) {
+    if (!publishNext(WS_MSG_CLASS_TELEMETRY))
+      return;
+  }
+  if (queued(WS_MSG_CLASS_TELEMETRY) == 0)
+    publishNext(WS_MSG_CLASS_DIAGNOSTIC);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Publishes every queued message, highest priority class first.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::flush() {
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    while (publishNext((ws_msg_class_t)i))
+      ;
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of messages waiting within a class queue.
+    @param  msgClass
+            The message class.
+    @returns  Number of queued messages.
+*/
+/***********************************************************************************/
+uint8_t Wippersnapper_Outbound::queued(ws_msg_class_t msgClass) {
+  return _queues[msgClass].count;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of messages waiting within all queues.
+    @returns  Number of queued messages.
+*/
+/***********************************************************************************/
+uint8_t Wippersnapper_Outbound::queuedTotal() {
+  uint8_t total = 0;
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++)
+    total += _queues[i].count;
+  return total;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of messages discarded from a class queue.
+    @param  msgClass
+            The message class.
+    @returns  Number of dropped messages.
+*/
+/***********************************************************************************/
+uint32_t Wippersnapper_Outbound::dropped(ws_msg_class_t msgClass) {
+  return _queues[msgClass].dropped;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of messages published from a class.
+    @param  msgClass
+            The message class.
+    @param  qos
+            The MQTT QoS level, 0 or 1.
+    @returns  Number of messages published at the QoS level.
+*/
+/***********************************************************************************/
+uint32_t Wippersnapper_Outbound::published(ws_msg_class_t msgClass,
+                                           uint8_t qos) {
+  return _queues[msgClass].published[qos > 0 ? 1 : 0];
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of failed publishes from a class.
+    @param  msgClass
+            The message class.
+    @returns  Number of failed publishes.
+*/
+/***********************************************************************************/
+uint32_t Wippersnapper_Outbound::failed(ws_msg_class_t msgClass) {
+  return _queues[msgClass].failed;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Prints the publish counters of each message class.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::printStats() {
+  WS_DEBUG_PRINTLN("Outbound message counters (QoS 0/QoS 1/failed/dropped):");
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    WS_DEBUG_PRINT("\t");
+    WS_DEBUG_PRINT(msgClassNames[i]);
+    WS_DEBUG_PRINT(": ");
+    WS_DEBUG_PRINT(_queues[i].published[0]);
+    WS_DEBUG_PRINT("/");
+    WS_DEBUG_PRINT(_queues[i].published[1]);
+    WS_DEBUG_PRINT("/");
+    WS_DEBUG_PRINT(_queues[i].failed);
+    WS_DEBUG_PRINT("/");
+    WS_DEBUG_PRINTLN(_queues[i].dropped);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Sets the QoS used for messages of a class.
+    @param  msgClass
+            The message class.
+    @param  qos
+            The MQTT QoS level, 0 or 1.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::setClassQoS(ws_msg_class_t msgClass,
+                                         uint8_t qos) {
+  _classQoS[msgClass] = qos > 0 ? 1 : 0;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Sets the QoS used for messages of a channel, overriding the
+            QoS of the message's class.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @param  qos
+            The MQTT QoS level, 0 or 1.
+    @returns  True if the override was stored, False if the policy table
+              is full.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::setChannelQoS(uint16_t channel, uint8_t qos) {
+  for (int i = 0; i < _channelQoSCount; i++) {
+    if (_channelQoS[i].channel == channel) {
+      _channelQoS[i].qos = qos > 0 ? 1 : 0;
+      return true;
+    }
+  }
+  if (_channelQoSCount == WS_QOS_MAX_CHANNEL_POLICIES) {
+    WS_DEBUG_PRINTLN("ERROR: Channel QoS policy table is full");
+    return false;
+  }
+  _channelQoS[_channelQoSCount].channel = channel;
+  _channelQoS[_channelQoSCount].qos = qos > 0 ? 1 : 0;
+  _channelQoSCount++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Looks up the QoS to publish a message with.
+    @param  msgClass
+            The message class.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @returns  The channel's QoS override if one exists, the class QoS
+              otherwise.
+*/
+/***********************************************************************************/
+uint8_t Wippersnapper_Outbound::getQoS(ws_msg_class_t msgClass,
+                                       uint16_t channel) {
+  if (channel != WS_CHANNEL_NONE) {
+    for (int i = 0; i < _channelQoSCount; i++) {
+      if (_channelQoS[i].channel == channel)
+        return _channelQoS[i].qos;
+    }
+  }
+  return _classQoS[msgClass];
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Loads a QoS policy from the optional "qos" object of
+            secrets.json, ie:
+            {"telemetry": 1, "channels": {"A0": 0, "0x44": 1}}
+    @param  policy
+            The "qos" object. Classes and channels which are not
+            present keep their current QoS.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::configureQoS(JsonObject policy) {
+  if (policy.isNull())
+    return;
+
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++) {
+    if (policy.containsKey(msgClassNames[i]))
+      setClassQoS((ws_msg_class_t)i, policy[msgClassNames[i]].as<uint8_t>());
+  }
+
+  JsonObject channels = policy["channels"];
+  for (JsonPair kv : channels) {
+    uint16_t channel;
+    if (!channelFromName(kv.key().c_str(), &channel)) {
+      WS_DEBUG_PRINT("ERROR: Invalid QoS channel name: ");
+      WS_DEBUG_PRINTLN(kv.key().c_str());
+      continue;
+    }
+    setChannelQoS(channel, kv.value().as<uint8_t>());
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Converts a channel name from secrets.json into a channel
+            identifier. Digital pins are named "D<pin>", analog pins
+            "A<pin>" and I2C devices by their hexadecimal address, "0x<addr>".
+    @param  name
+            The channel's name.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @returns  True if the name was parsed, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::channelFromName(const char *name,
+                                             uint16_t *channel) {
+  if (name == NULL || name[0] == '\0' || name[1] == '\0')
+    return false;
+  char *end;
+  if (name[0] == '0' && (name[1] == 'x' || name[1] == 'X')) {
+    long addr = strtol(name + 2, &end, 16);
+    if (*end != '\0' || addr < 0 || addr > 0x7F)
+      return false;
+    *channel = WS_CHANNEL_I2C(addr);
+    return true;
+  }
+  long pin = strtol(name + 1, &end, 10);
+  if (*end != '\0' || pin < 0 || pin > 0x3FFF)
+    return false;
+  if (name[0] == 'D')
+    *channel = WS_CHANNEL_DIGITAL(pin);
+  else if (name[0] == 'A')
+    *channel = WS_CHANNEL_ANALOG(pin);
+  else
+    return false;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Notifies the outbound queue that the broker throttled the
+            device. Sampling periods are stretched by the largest factor
+            until the link recovers.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::throttled() {
+  _throttled = true;
+  _stretch = WS_BACKPRESSURE_MAX_STRETCH;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the factor low-priority sampling periods are currently
+            stretched by.
+    @returns  The stretch factor, 1 if the link is not congested.
+*/
+/***********************************************************************************/
+uint8_t Wippersnapper_Outbound::stretch() { return _stretch; }
+
+/***********************************************************************************/
+/*!
+    @brief  Adjusts the stretch factor from the outbound link's state. The
+            factor doubles while telemetry backs up, publishes fail or the
+            device is throttled, and halves once the telemetry queue has
+            drained.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::updateBackpressure() {
+  uint32_t failedTotal = 0;
+  for (int i = 0; i < WS_MSG_CLASS_COUNT; i++)
+    failedTotal += _queues[i].failed;
+
+  outboundQueue *telemetry = &_queues[WS_MSG_CLASS_TELEMETRY];
+  bool congested = _throttled || failedTotal != _prvFailed ||
+                   _queues[WS_MSG_CLASS_STATE].count > 0 ||
+                   telemetry->count >= telemetry->depth / 2;
+  _prvFailed = failedTotal;
+  _throttled = false;
+
+  uint8_t prvStretch = _stretch;
+  if (congested && _stretch < WS_BACKPRESSURE_MAX_STRETCH)
+    _stretch = min(_stretch * 2, WS_BACKPRESSURE_MAX_STRETCH);
+  else if (!congested && telemetry->count == 0 && _stretch > 1)
+    _stretch /= 2;
+
+  if (_stretch != prvStretch) {
+    WS_DEBUG_PRINT("Outbound backpressure, sampling periods stretched x");
+    WS_DEBUG_PRINTLN(_stretch);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the period a low-priority channel should be sampled at,
+            given the outbound link's congestion.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @param  period
+            The channel's configured sampling period, in milliseconds.
+    @returns  The stretched sampling period, in milliseconds. Never longer
+              than the channel's declared maximum period, never shorter
+              than the configured period.
+*/
+/***********************************************************************************/
+long Wippersnapper_Outbound::samplingPeriod(uint16_t channel, long period) {
+  if (_stretch == 1 || period <= 0)
+    return period;
+
+  long stretched = period * _stretch;
+  for (int i = 0; i < _channelRateCount; i++) {
+    if (_channelRates[i].channel == channel) {
+      if (stretched > _channelRates[i].maxPeriod)
+        stretched = max(period, _channelRates[i].maxPeriod);
+      break;
+    }
+  }
+  return stretched;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Declares a channel's minimum acceptable sampling rate.
+    @param  channel
+            The channel identifier, WS_CHANNEL_*.
+    @param  maxPeriod
+            Longest acceptable sampling period, in milliseconds.
+    @returns  True if the rate was stored, False if the table is full.
+*/
+/***********************************************************************************/
+bool Wippersnapper_Outbound::setChannelMaxPeriod(uint16_t channel,
+                                                 long maxPeriod) {
+  for (int i = 0; i < _channelRateCount; i++) {
+    if (_channelRates[i].channel == channel) {
+      _channelRates[i].maxPeriod = maxPeriod;
+      return true;
+    }
+  }
+  if (_channelRateCount == WS_BACKPRESSURE_MAX_CHANNEL_RATES) {
+    WS_DEBUG_PRINTLN("ERROR: Channel sampling rate table is full");
+    return false;
+  }
+  _channelRates[_channelRateCount].channel = channel;
+  _channelRates[_channelRateCount].maxPeriod = maxPeriod;
+  _channelRateCount++;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Loads the minimum sampling rate of channels from the optional
+            "max_period" object of secrets.json, ie: {"A0": 60, "0x44": 300}
+    @param  policy
+            The "max_period" object, longest acceptable sampling period of
+            each channel in seconds.
+*/
+/***********************************************************************************/
+void Wippersnapper_Outbound::configureSampling(JsonObject policy) {
+  for (JsonPair kv : policy) {
+    uint16_t channel;
+    if (!channelFromName(kv.key().c_str(), &channel)) {
+      WS_DEBUG_PRINT("ERROR: Invalid sampling channel name: ");
+      WS_DEBUG_PRINTLN(kv.key().c_str());
+      continue;
+    }
+    setChannelMaxPeriod(channel, kv.value().as<long>() * 1000);
+  }
+}
@@ -0,0 +1,165 @@
+/*!
+ * @file Wippersnapper_Outbound.h
+ *
+ * Prioritized queue for messages published from the device to the
+ * Adafruit IO MQTT broker.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_OUTBOUND_H
+#define WIPPERSNAPPER_OUTBOUND_H
+
+#include "Wippersnapper.h"
+#include <ArduinoJson.h>
+
+// Every queued payload is encoded within the shared outgoing buffer, so
+// WS_MQTT_MAX_PAYLOAD_SIZE bounds its length. Larger messages are published
+// through Wippersnapper_Chunking instead.
+#define WS_OUTBOUND_MAX_PAYLOAD_SIZE                                           \
+  WS_MQTT_MAX_PAYLOAD_SIZE ///< Largest payload which may be queued, in bytes
+#ifndef WS_OUTBOUND_POOL_SIZE
+#define WS_OUTBOUND_POOL_SIZE                                                  \
+  (2 * WS_OUTBOUND_MAX_PAYLOAD_SIZE) ///< Payload bytes shared by all queues
+#endif
+#if WS_OUTBOUND_POOL_SIZE < WS_OUTBOUND_MAX_PAYLOAD_SIZE
+#error "WS_OUTBOUND_POOL_SIZE must hold the largest queued payload"
+#endif
+
+#ifndef WS_OUTBOUND_DEPTH_CONTROL
+#define WS_OUTBOUND_DEPTH_CONTROL 4 ///< Queue depth, control/ack messages
+#endif
+#ifndef WS_OUTBOUND_DEPTH_STATE
+#define WS_OUTBOUND_DEPTH_STATE 6 ///< Queue depth, on-change state messages
+#endif
+#ifndef WS_OUTBOUND_DEPTH_TELEMETRY
+#define WS_OUTBOUND_DEPTH_TELEMETRY 6 ///< Queue depth, periodic telemetry
+#endif
+#ifndef WS_OUTBOUND_DEPTH_DIAGNOSTIC
+#define WS_OUTBOUND_DEPTH_DIAGNOSTIC 2 ///< Queue depth, diagnostic messages
+#endif
+
+#define WS_OUTBOUND_TELEMETRY_PER_TICK                                         \
+  2 ///< Maximum telemetry messages published per call to process()
+#define WS_OUTBOUND_STATS_INTERVAL_MS                                          \
+  300000 ///< Time between printing publish counters, in milliseconds
+
+#define WS_QOS_MAX_CHANNEL_POLICIES                                            \
+  8 ///< Maximum number of per-channel QoS overrides
+
+#ifndef WS_BACKPRESSURE_MAX_STRETCH
+#define WS_BACKPRESSURE_MAX_STRETCH                                            \
+  8 ///< Largest factor a sampling period is stretched by while congested
+#endif
+#define WS_BACKPRESSURE_INTERVAL_MS                                            \
+  5000 ///< Time between adjustments of the stretch factor, in milliseconds
+#define WS_BACKPRESSURE_MAX_CHANNEL_RATES                                      \
+  8 ///< Maximum number of channels declaring a minimum sampling rate
+
+/** A message waiting to be published */
+struct outboundMsg {
+  const char *topic; ///< MQTT topic to publish to
+  uint16_t offset;   ///< Offset of the encoded message within the pool
+  uint16_t len;      ///< Length of payload, in bytes
+  uint8_t qos;       ///< MQTT QoS level
+};
+
+/** QoS override for a single channel */
+struct qosChannelPolicy {
+  uint16_t channel; ///< Channel identifier, WS_CHANNEL_*
+  uint8_t qos;      ///< MQTT QoS level used for this channel
+};
+
+/** Minimum sampling rate of a single channel */
+struct channelRate {
+  uint16_t channel; ///< Channel identifier, WS_CHANNEL_*
+  long maxPeriod;   ///< Longest acceptable sampling period, in milliseconds
+};
+
+/** Ring of outbound messages belonging to one message class, their
+ * payloads are held within the shared pool */
+struct outboundQueue {
+  outboundMsg *slots; ///< Storage for queued messages
+  uint8_t depth;      ///< Total number of slots
+  uint8_t head;       ///< Index of the oldest queued message
+  uint8_t count;      ///< Number of queued messages
+  uint32_t dropped;   ///< Messages discarded because the queue was full
+  uint32_t published[2]; ///< Messages published, indexed by QoS level
+  uint32_t failed;       ///< Messages which failed to publish
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that holds outbound messages in per-class queues and
+            publishes them to the broker in strict priority order. The
+            payloads of all queues share a single pool of
+            WS_OUTBOUND_POOL_SIZE bytes, packed in arrival order.
+*/
+/**************************************************************************/
+class Wippersnapper_Outbound {
+public:
+  Wippersnapper_Outbound();
+  ~Wippersnapper_Outbound();
+
+  bool enqueue(const char *topic, uint8_t *payload, uint16_t len,
+               ws_msg_class_t msgClass, uint16_t channel = WS_CHANNEL_NONE);
+  void process();
+  void flush();
+
+  uint8_t queued(ws_msg_class_t msgClass);
+  uint8_t queuedTotal();
+  uint32_t dropped(ws_msg_class_t msgClass);
+  uint32_t published(ws_msg_class_t msgClass, uint8_t qos);
+  uint32_t failed(ws_msg_class_t msgClass);
+  void printStats();
+
+  // QoS policy
+  void setClassQoS(ws_msg_class_t msgClass, uint8_t qos);
+  bool setChannelQoS(uint16_t channel, uint8_t qos);
+  uint8_t getQoS(ws_msg_class_t msgClass, uint16_t channel = WS_CHANNEL_NONE);
+  void configureQoS(JsonObject policy);
+  static bool channelFromName(const char *name, uint16_t *channel);
+
+  // Backpressure
+  void throttled();
+  uint8_t stretch();
+  long samplingPeriod(uint16_t channel, long period);
+  bool setChannelMaxPeriod(uint16_t channel, long maxPeriod);
+  void configureSampling(JsonObject policy);
+
+private:
+  bool publishNext(ws_msg_class_t msgClass);
+  void release(ws_msg_class_t msgClass);
+  bool reserve(ws_msg_class_t msgClass, uint16_t len);
+  void updateBackpressure();
+  bool publishMsg(const char *topic, uint8_t *payload, uint16_t len,
+                  uint8_t qos, ws_msg_class_t msgClass);
+  outboundQueue _queues[WS_MSG_CLASS_COUNT]; ///< One queue per message class
+  uint8_t *_pool = NULL;                     ///< Payloads, in arrival order
+  uint16_t _poolUsed = 0;                    ///< Bytes of the pool in use
+  uint8_t _classQoS[WS_MSG_CLASS_COUNT];     ///< Default QoS of each class
+  qosChannelPolicy
+      _channelQoS[WS_QOS_MAX_CHANNEL_POLICIES]; ///< Per-channel overrides
+  uint8_t _channelQoSCount = 0; ///< Number of per-channel overrides
+  long _prvStats = 0;           ///< When counters were last printed, in millis
+  channelRate
+      _channelRates[WS_BACKPRESSURE_MAX_CHANNEL_RATES]; ///< Min. sample rates
+  uint8_t _channelRateCount = 0; ///< Number of channels declaring a min. rate
+  uint8_t _stretch = 1;          ///< Factor sampling periods are stretched by
+  long _prvBackpressure = 0;     ///< When the stretch factor was last adjusted
+  uint32_t _prvFailed = 0;       ///< Failed publishes at the last adjustment
+  bool _throttled = false;       ///< True if the broker throttled the device
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_OUTBOUND_H
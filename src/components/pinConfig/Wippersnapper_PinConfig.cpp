@@ -0,0 +1,222 @@
+/*!
+ * @file Wippersnapper_PinConfig.cpp
+ *
+ * Stages a list of pin configuration requests and applies it as a single
+ * transaction.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_PinConfig.h"
+
+/***********************************************************************************/
+/*!
+    @brief  Creates an empty pin configuration transaction.
+*/
+/***********************************************************************************/
+Wippersnapper_PinConfig::Wippersnapper_PinConfig() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases the staged requests.
+*/
+/***********************************************************************************/
+Wippersnapper_PinConfig::~Wippersnapper_PinConfig() { _pins.clear(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Adds a request to the transaction.
+    @param  pinMsg
+            The decoded pin configuration request.
+*/
+/***********************************************************************************/
+void Wippersnapper_PinConfig::stage(
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg) {
+  _pins.push_back(*pinMsg);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Returns the number of staged requests.
+    @returns  Number of staged requests.
+*/
+/***********************************************************************************/
+size_t Wippersnapper_PinConfig::staged() { return _pins.size(); }
+
+/***********************************************************************************/
+/*!
+    @brief  Checks every staged request against the board before any pin
+            is changed. Each pin must exist and support its direction,
+            appear once, and the board must have enough input slots for
+            the inputs left once the transaction is applied.
+    @returns  True if the whole transaction can be applied, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PinConfig::validate() {
+  int32_t digitalInputs = 0; // input slots taken, minus slots released
+  int32_t analogInputs = 0;
+  for (size_t i = 0; i < _pins.size(); i++) {
+    if (!validatePin(i)) {
+      WS_DEBUG_PRINT("ERROR: Invalid pin configuration for ");
+      WS_DEBUG_PRINTLN(_pins[i].pin_name);
+      return false;
+    }
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg = &_pins[i];
+    int pin = atoi(pinMsg->pin_name + 1);
+    bool input =
+        pinMsg->request_type ==
+            wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE &&
+        pinMsg->direction ==
+            wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_INPUT;
+    if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_DIGITAL)
+      digitalInputs += input - WS._digitalGPIO->isDigitalInput(pin);
+    else
+      analogInputs += input - WS._analogIO->isAnalogInput(pin);
+  }
+
+  if (digitalInputs > WS._digitalGPIO->freeDigitalInputSlots() ||
+      analogInputs > WS._analogIO->freeAnalogInputSlots()) {
+    WS_DEBUG_PRINTLN("ERROR: Pin configuration exceeds the board's inputs");
+    return false;
+  }
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Applies a validated transaction. Pins are released first so
+            their input slots can be reused, then every digital pin is
+            set up in a single pass, then analog pins. Pins already
+            configured as requested are left untouched. Only pins which
+            were set up are recorded in the configuration cache.
+    @returns  True if every pin was applied, False if any pin failed.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PinConfig::apply() {
+  bool is_success = true;
+  std::vector<wippersnapper_pin_v1_ConfigurePinRequest *> digitalPins;
+  std::vector<wippersnapper_pin_v1_ConfigurePinRequest *> analogPins;
+
+  // Release deleted pins
+  for (size_t i = 0; i < _pins.size(); i++) {
+    if (_pins[i].request_type ==
+            wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE &&
+        !WS.configurePinRequest(&_pins[i]))
+      is_success = false;
+  }
+
+  // Reconcile the others with their current configuration
+  for (size_t i = 0; i < _pins.size(); i++) {
+    wippersnapper_pin_v1_ConfigurePinRequest *pinMsg = &_pins[i];
+    if (pinMsg->request_type !=
+        wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE)
+      continue;
+    if (WS.reconcilePinRequest(pinMsg, atoi(pinMsg->pin_name + 1)))
+      continue;
+    if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_DIGITAL)
+      digitalPins.push_back(pinMsg);
+    else
+      analogPins.push_back(pinMsg);
+    WS.feedWDT();
+  }
+
+  // Set up the remaining pins
+  std::vector<bool> configured;
+  if (!digitalPins.empty() &&
+      !WS._digitalGPIO->initDigitalPins(digitalPins.data(), digitalPins.size(),
+                                        configured))
+    is_success = false;
+  for (size_t i = 0; i < digitalPins.size(); i++) {
+    if (configured[i])
+      WS._configCache->pinConfigured(digitalPins[i]);
+  }
+  for (size_t i = 0; i < analogPins.size(); i++) {
+    if (WS.applyPinRequest(analogPins[i], atoi(analogPins[i]->pin_name + 1)))
+      WS._configCache->pinConfigured(analogPins[i]);
+    else
+      is_success = false;
+    WS.feedWDT();
+  }
+  return is_success;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks a single staged request.
+    @param  idx
+            Index of the request within the transaction.
+    @returns  True if the request is valid for this board, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PinConfig::validatePin(size_t idx) {
+  wippersnapper_pin_v1_ConfigurePinRequest *pinMsg = &_pins[idx];
+
+  // pin names are a letter followed by the pin number, "D5" or "A0"
+  const char *name = pinMsg->pin_name;
+  if ((name[0] != 'D' && name[0] != 'A') || name[1] == '\0')
+    return false;
+  for (const char *c = name + 1; *c != '\0'; c++) {
+    if (*c < '0' || *c > '9')
+      return false;
+  }
+  for (size_t i = 0; i < idx; i++) {
+    if (strcmp(_pins[i].pin_name, name) == 0)
+      return false; // a pin may only be configured once per list
+  }
+
+  if (pinMsg->mode != wippersnapper_pin_v1_Mode_MODE_DIGITAL &&
+      pinMsg->mode != wippersnapper_pin_v1_Mode_MODE_ANALOG)
+    return false;
+  if (pinMsg->request_type ==
+      wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE)
+    return true;
+  if (pinMsg->request_type !=
+      wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE)
+    return false;
+
+  bool output =
+      pinMsg->direction ==
+      wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_OUTPUT;
+  if (!output &&
+      pinMsg->direction !=
+          wippersnapper_pin_v1_ConfigurePinRequest_Direction_DIRECTION_INPUT)
+    return false;
+  // pulses are counted by digital inputs, over a period, and need an
+  // interrupt line no other pin uses
+  if (pinMsg->digital_read_mode ==
+          wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_PULSE_COUNT &&
+      (output || pinMsg->mode != wippersnapper_pin_v1_Mode_MODE_DIGITAL ||
+       pinMsg->period <= 0 ||
+       Wippersnapper_DigitalGPIO::isExtIntOwned(atoi(name + 1))))
+    return false;
+  // encoders pair the pin with a free digital input, published over a
+  // period, on a change threshold or both
+  if (pinMsg->digital_read_mode ==
+      wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE) {
+    uint8_t pinB = pinMsg->encoder_pin;
+    if (output || pinMsg->mode != wippersnapper_pin_v1_Mode_MODE_DIGITAL ||
+        pinMsg->period < 0 ||
+        (pinMsg->period == 0 && pinMsg->change_threshold == 0) ||
+        pinMsg->encoder_pin != pinB || pinB == atoi(name + 1) ||
+        !Wippersnapper_DigitalGPIO::isValidDigitalPin(pinB, false) ||
+        Wippersnapper_DigitalGPIO::sharesExtInt(atoi(name + 1), pinB) ||
+        WS._digitalGPIO->isDigitalInput(pinB))
+      return false;
+    for (size_t i = 0; i < _pins.size(); i++) {
+      if (_pins[i].pin_name[0] == 'D' && atoi(_pins[i].pin_name + 1) == pinB)
+        return false; // phase B is taken by another request
+    }
+  }
+  if (pinMsg->mode == wippersnapper_pin_v1_Mode_MODE_ANALOG)
+    return !output; // analog outputs are not supported
+  if (WS._pulseCapture->isCapturePin(atoi(name + 1)))
+    return false; // released by a pulse capture request first
+  return Wippersnapper_DigitalGPIO::isValidDigitalPin(atoi(name + 1), output);
+}
@@ -0,0 +1,52 @@
+/*!
+ * @file Wippersnapper_PinConfig.h
+ *
+ * Stages a list of pin configuration requests and applies it as a single
+ * transaction.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_PINCONFIG_H
+#define WIPPERSNAPPER_PINCONFIG_H
+
+#include "Wippersnapper.h"
+#include <vector>
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that holds the pin configuration requests of a single
+            list sent by the broker. The whole list is validated before
+            any pin is touched, then applied in one pass: pins are
+            released first, digital pins are set up together, port by
+            port, and analog pins follow.
+*/
+/**************************************************************************/
+class Wippersnapper_PinConfig {
+public:
+  Wippersnapper_PinConfig();
+  ~Wippersnapper_PinConfig();
+
+  void stage(wippersnapper_pin_v1_ConfigurePinRequest *pinMsg);
+  size_t staged();
+  bool validate();
+  bool apply();
+
+private:
+  bool validatePin(size_t idx);
+  std::vector<wippersnapper_pin_v1_ConfigurePinRequest>
+      _pins; ///< Staged requests, in the order they were received
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_PINCONFIG_H
@@ -0,0 +1,684 @@
+/*!
+ * @file Wippersnapper_PulseCapture.cpp
+ *
+ * Records the pulse trains of single-wire timing sensors in the
+ * background and decodes them from the main loop.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_PulseCapture.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include "soc/soc_caps.h"
+#if SOC_RMT_SUPPORTED
+#include "driver/rmt.h"
+#define WS_HAS_RMT ///< Pulse trains are recorded by the RMT receiver
+#define WS_RMT_RX_FIRST                                                        \
+  (SOC_RMT_CHANNELS_PER_GROUP -                                                \
+   SOC_RMT_RX_CANDIDATES_PER_GROUP) ///< First channel able to receive
+#define WS_RMT_MAX_TICKS 32767     ///< Longest level of an RMT item, in ticks
+#define WS_RMT_RINGBUF_SIZE 1024   ///< RMT driver's receive buffer, in bytes
+#define WS_RMT_DHT_IDLE_TICKS 200  ///< Level which ends a DHT22 frame, in ticks
+#define WS_RMT_FILTER_CYCLES 100   ///< Glitches ignored by RMT, APB cycles
+#endif
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR ///< Places interrupt handlers within IRAM on ESP32
+#endif
+#define WS_CAPTURE_IRQ_MAX 4 ///< Edge interrupt handlers for captures
+
+// Edges timed by the interrupt handlers, while a capture is armed. Each
+// handler only writes its own capture's widths, which the loop reads once
+// the handler is detached.
+static volatile uint8_t captureEdges[WS_CAPTURE_IRQ_MAX]; ///< Edges seen
+static volatile uint32_t captureLastEdges[WS_CAPTURE_IRQ_MAX]; ///< In micros
+/** Time between consecutive edges of each capture, in micros */
+static volatile uint32_t captureWidths[WS_CAPTURE_IRQ_MAX]
+                                      [WS_PULSE_CAPTURE_WIDTHS];
+static uint8_t captureFirstLevels[WS_CAPTURE_IRQ_MAX]; ///< Level after edge 0
+static uint8_t captureIrqsUsed = 0; ///< Bit per handler in use
+static uint8_t captureIrqPins[WS_CAPTURE_IRQ_MAX]; ///< Pin of each handler
+
+/**************************************************************************/
+/*!
+    @brief  Records the time since the previous edge of a capture. Called
+            from interrupt context.
+    @param  irq
+            The edge interrupt handler which fired.
+*/
+/**************************************************************************/
+static void IRAM_ATTR captureEdge(uint8_t irq) {
+  uint32_t time = micros();
+  uint8_t edges = captureEdges[irq];
+  if (edges > WS_PULSE_CAPTURE_WIDTHS)
+    return; // every width is recorded
+  if (edges > 0)
+    captureWidths[irq][edges - 1] = time - captureLastEdges[irq];
+  captureLastEdges[irq] = time;
+  captureEdges[irq] = edges + 1;
+}
+
+// attachInterrupt() handlers take no argument, one handler per capture
+static void IRAM_ATTR isrCapture0() { captureEdge(0); } ///< Edge handler 0
+static void IRAM_ATTR isrCapture1() { captureEdge(1); } ///< Edge handler 1
+static void IRAM_ATTR isrCapture2() { captureEdge(2); } ///< Edge handler 2
+static void IRAM_ATTR isrCapture3() { captureEdge(3); } ///< Edge handler 3
+/** Edge interrupt handlers, indexed by pulseCapture.irq */
+static void (*const captureIsrs[WS_CAPTURE_IRQ_MAX])(void) = {
+    isrCapture0, isrCapture1, isrCapture2, isrCapture3};
+
+/***********************************************************************************/
+/*!
+    @brief  Creates the pulse capture component, without any input.
+*/
+/***********************************************************************************/
+Wippersnapper_PulseCapture::Wippersnapper_PulseCapture() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases every pulse capture input.
+*/
+/***********************************************************************************/
+Wippersnapper_PulseCapture::~Wippersnapper_PulseCapture() {
+  while (_count > 0)
+    releaseCapture(_captures[0].pinName);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Configures a pin to capture and decode the pulses of a timing
+            sensor, or releases it.
+    @param  msg
+            The decoded ConfigurePulseCaptureRequest message. A timeout
+            of 0 selects the default of the capture mode.
+    @returns  True if the request was applied, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::configureCapture(
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest *msg) {
+  uint8_t pinName = atoi(msg->pin_name + 1);
+  if (msg->request_type ==
+      wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_DELETE) {
+    releaseCapture(pinName);
+    return true;
+  }
+
+  uint8_t mode = msg->capture_mode;
+  bool dht =
+      mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22;
+  bool echo =
+      mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO;
+  if (msg->request_type !=
+          wippersnapper_pin_v1_ConfigurePinRequest_RequestType_REQUEST_TYPE_CREATE ||
+      mode ==
+          wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_UNSPECIFIED ||
+      mode > _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_MAX ||
+      msg->period <= 0) {
+    WS_DEBUG_PRINTLN("ERROR: Invalid pulse capture request");
+    return false;
+  }
+  // a DHT22's start signal is driven by the capture pin
+  if (!Wippersnapper_DigitalGPIO::isValidDigitalPin(pinName, dht) ||
+      (echo && (msg->trigger_pin == pinName ||
+                !Wippersnapper_DigitalGPIO::isValidDigitalPin(
+                    msg->trigger_pin, true)))) {
+    WS_DEBUG_PRINTLN("ERROR: Pulse capture requested on an invalid pin");
+    return false;
+  }
+  // the pin's own capture, and its trigger pin, are replaced
+  pulseCapture *prev = findCapture(pinName);
+  bool triggerInUse =
+      echo && (WS._digitalGPIO->isDigitalInput(msg->trigger_pin) ||
+               WS._pwm->isPWMPin(msg->trigger_pin) ||
+               (isCapturePin(msg->trigger_pin) &&
+                (prev == NULL || prev->triggerPin != msg->trigger_pin)));
+  if (WS._digitalGPIO->isDigitalInput(pinName) || WS._pwm->isPWMPin(pinName) ||
+      (prev == NULL && isCapturePin(pinName)) || triggerInUse) {
+    WS_DEBUG_PRINTLN("ERROR: Pulse capture requested on a pin in use");
+    return false;
+  }
+
+  // a pin is set up again for its new configuration
+  releaseCapture(pinName);
+  if (_count == WS_PULSE_CAPTURE_MAX) {
+    WS_DEBUG_PRINTLN("ERROR: Every pulse capture input is in use");
+    return false;
+  }
+  pulseCapture *cap = &_captures[_count];
+  cap->pinName = pinName;
+  cap->mode = mode;
+  cap->triggerPin = echo ? msg->trigger_pin : 0;
+  cap->state = WS_CAPTURE_IDLE;
+  // Period is in seconds, cast it to long and convert it to milliseconds
+  cap->period = (long)msg->period * 1000;
+  cap->prvPeriod = 0L;
+  cap->timeoutUs = msg->timeout_us;
+  if (dht) {
+    cap->period = max(cap->period, (long)WS_PULSE_CAPTURE_DHT_MIN_PERIOD);
+    cap->timeoutUs = WS_PULSE_CAPTURE_DHT_TIMEOUT_US;
+  } else if (cap->timeoutUs == 0) {
+    cap->timeoutUs = echo ? WS_PULSE_CAPTURE_ECHO_TIMEOUT_US
+                          : WS_PULSE_CAPTURE_PULSE_TIMEOUT_US;
+  }
+  if (!attachReceiver(cap))
+    return false;
+  _count++;
+
+  pinMode(pinName, dht ? INPUT_PULLUP : INPUT);
+  if (echo) {
+    pinMode(cap->triggerPin, OUTPUT);
+    digitalWrite(cap->triggerPin, LOW);
+  }
+  uint16_t channel = WS_CHANNEL_DIGITAL(pinName);
+  if (dht) {
+    WS._lastValue->track(
+        channel, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE);
+    WS._lastValue->track(
+        channel, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY);
+  } else {
+    WS._lastValue->track(
+        channel, echo ? wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PROXIMITY
+                      : wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RAW);
+  }
+  WS_DEBUG_PRINT("Capturing pulses on D");
+  WS_DEBUG_PRINT(pinName);
+  WS_DEBUG_PRINT(cap->rmtChannel != -1 ? " with RMT channel "
+                                       : " by interrupt ");
+  WS_DEBUG_PRINTLN(cap->rmtChannel != -1 ? cap->rmtChannel : cap->irq);
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops capturing the pulses of a pin and returns it, and an
+            echo's trigger pin, to a high impedance input.
+    @param  pinName
+            The pin's name.
+*/
+/***********************************************************************************/
+void Wippersnapper_PulseCapture::releaseCapture(uint8_t pinName) {
+  pulseCapture *cap = findCapture(pinName);
+  if (cap == NULL)
+    return;
+  detachReceiver(cap);
+  pinMode(pinName, INPUT); // hi-z
+  if (cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO)
+    pinMode(cap->triggerPin, INPUT);
+  WS._lastValue->untrack(WS_CHANNEL_DIGITAL(pinName));
+  *cap = _captures[--_count];
+  WS_DEBUG_PRINT("Released pulse capture on D");
+  WS_DEBUG_PRINTLN(pinName);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a pin, or an echo's trigger pin, captures pulses.
+    @param  pinName
+            The pin's name.
+    @returns  True if the pin is used by a pulse capture, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::isCapturePin(uint8_t pinName) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_captures[i].pinName == pinName ||
+        (_captures[i].mode ==
+             wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO &&
+         _captures[i].triggerPin == pinName))
+      return true;
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a capture on another pin times its edges with the
+            external interrupt line of a pin.
+    @param  pinName
+            The pin's name.
+    @returns  True if another capture's edge interrupt uses the line,
+              False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::usesExtInt(uint8_t pinName) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_captures[i].irq != -1 &&
+        Wippersnapper_DigitalGPIO::sharesExtInt(pinName, _captures[i].pinName))
+      return true;
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Starts the captures whose period elapsed, and decodes and
+            publishes those which completed. Never waits on a sensor, a
+            capture in progress is checked again on the next call.
+*/
+/***********************************************************************************/
+void Wippersnapper_PulseCapture::process() {
+  for (uint8_t i = 0; i < _count; i++) {
+    pulseCapture *cap = &_captures[i];
+    uint32_t elapsed = micros() - cap->stateTime;
+    switch (cap->state) {
+    case WS_CAPTURE_IDLE:
+      if (millis() - cap->prvPeriod > (unsigned long)cap->period)
+        startCapture(cap);
+      break;
+    case WS_CAPTURE_STARTING:
+      if (elapsed >= WS_PULSE_CAPTURE_DHT_START_US)
+        armCapture(cap);
+      break;
+    case WS_CAPTURE_ARMED:
+      if (!readCapture(cap, elapsed > cap->timeoutUs))
+        break;
+      cap->state = WS_CAPTURE_IDLE;
+      if (!decodeCapture(cap)) {
+        WS_DEBUG_PRINT("ERROR: Unable to decode the pulses on D");
+        WS_DEBUG_PRINTLN(cap->pinName);
+      }
+      break;
+    }
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Finds a pulse capture input.
+    @param  pinName
+            The pin's name.
+    @returns  The capture, NULL if the pin does not capture pulses.
+*/
+/***********************************************************************************/
+pulseCapture *Wippersnapper_PulseCapture::findCapture(uint8_t pinName) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_captures[i].pinName == pinName)
+      return &_captures[i];
+  }
+  return NULL;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Sets up the receiver of a new capture. On ESP32, DHT22 frames
+            and echoes short enough for RMT items are recorded by a free
+            RMT receive channel. Other captures, and other boards, time
+            the edges with an interrupt handler.
+    @param  cap
+            The capture, its mode and timeout set.
+    @returns  True if the capture has a receiver, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::attachReceiver(pulseCapture *cap) {
+  cap->irq = -1;
+  cap->rmtChannel = -1;
+#ifdef WS_HAS_RMT
+  // RMT frames end once the line idles, a train of pulses never does
+  bool dht =
+      cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22;
+  uint32_t tickUs = dht ? 1 : 2;
+  if (dht ||
+      (cap->mode ==
+           wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO &&
+       cap->timeoutUs / tickUs <= WS_RMT_MAX_TICKS)) {
+    // the core's drivers take the first channels, take the last ones
+    for (int ch = SOC_RMT_CHANNELS_PER_GROUP - 1; ch >= WS_RMT_RX_FIRST; ch--) {
+      bool used = false;
+      for (uint8_t i = 0; i < _count; i++)
+        used |= _captures[i].rmtChannel == ch;
+      if (used)
+        continue;
+      rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)cap->pinName,
+                                                  (rmt_channel_t)ch);
+      config.clk_div = 80 * tickUs; // APB clock is 80MHz
+      config.rx_config.idle_threshold =
+          dht ? WS_RMT_DHT_IDLE_TICKS : cap->timeoutUs / tickUs;
+      config.rx_config.filter_en = true;
+      config.rx_config.filter_ticks_thresh = WS_RMT_FILTER_CYCLES;
+      if (rmt_config(&config) != ESP_OK ||
+          rmt_driver_install((rmt_channel_t)ch, WS_RMT_RINGBUF_SIZE, 0) !=
+              ESP_OK)
+        continue; // claimed by another driver
+      cap->rmtChannel = ch;
+      return true;
+    }
+  }
+#endif
+  if (digitalPinToInterrupt(cap->pinName) == NOT_AN_INTERRUPT) {
+    WS_DEBUG_PRINTLN("ERROR: Pin has no interrupt, unable to capture pulses");
+    return false;
+  }
+  if (Wippersnapper_DigitalGPIO::isExtIntOwned(cap->pinName)) {
+    WS_DEBUG_PRINTLN("ERROR: Interrupt line in use, unable to capture pulses");
+    return false;
+  }
+  for (int8_t irq = 0; irq < WS_CAPTURE_IRQ_MAX; irq++) {
+    if (captureIrqsUsed & (1 << irq))
+      continue;
+    captureIrqsUsed |= (1 << irq);
+    captureIrqPins[irq] = cap->pinName;
+    cap->irq = irq;
+    return true;
+  }
+  WS_DEBUG_PRINTLN("ERROR: No free edge interrupt, unable to capture pulses");
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases the receiver of a capture.
+    @param  cap
+            The capture.
+*/
+/***********************************************************************************/
+void Wippersnapper_PulseCapture::detachReceiver(pulseCapture *cap) {
+#ifdef WS_HAS_RMT
+  if (cap->rmtChannel != -1) {
+    rmt_rx_stop((rmt_channel_t)cap->rmtChannel);
+    rmt_driver_uninstall((rmt_channel_t)cap->rmtChannel);
+    cap->rmtChannel = -1;
+  }
+#endif
+  if (cap->irq != -1) {
+    if (cap->state == WS_CAPTURE_ARMED)
+      detachInterrupt(digitalPinToInterrupt(captureIrqPins[cap->irq]));
+    captureIrqsUsed &= ~(1 << cap->irq);
+    cap->irq = -1;
+  }
+  cap->state = WS_CAPTURE_IDLE;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Starts a capture. A DHT22 first has its line held low as a
+            start signal, an echo is triggered by a 10us pulse.
+    @param  cap
+            The capture.
+*/
+/***********************************************************************************/
+void Wippersnapper_PulseCapture::startCapture(pulseCapture *cap) {
+  cap->prvPeriod = millis();
+  if (cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22) {
+    pinMode(cap->pinName, OUTPUT);
+    digitalWrite(cap->pinName, LOW);
+    cap->state = WS_CAPTURE_STARTING;
+    cap->stateTime = micros();
+    return;
+  }
+  armCapture(cap);
+  if (cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO) {
+    digitalWrite(cap->triggerPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(cap->triggerPin, LOW);
+  }
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Starts recording the pulses of a capture. A DHT22's line is
+            released once its edges are timed by interrupt, since the
+            sensor answers within 40us, and before the RMT receiver
+            starts, which would end the frame on the long start signal.
+            The capture is skipped until its next period if another pin
+            took its interrupt line.
+    @param  cap
+            The capture.
+*/
+/***********************************************************************************/
+void Wippersnapper_PulseCapture::armCapture(pulseCapture *cap) {
+  // never take over the handler of another pin on the same EXTINT line
+  if (cap->irq != -1 &&
+      Wippersnapper_DigitalGPIO::isExtIntOwned(cap->pinName)) {
+    WS_DEBUG_PRINT("ERROR: Interrupt line in use, skipping the capture of D");
+    WS_DEBUG_PRINTLN(cap->pinName);
+    if (cap->mode ==
+        wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22)
+      pinMode(cap->pinName, INPUT_PULLUP);
+    cap->state = WS_CAPTURE_IDLE;
+    return;
+  }
+  if (cap->irq != -1) {
+    captureEdges[cap->irq] = 0;
+    // each edge flips the level, the first one away from the current level
+    captureFirstLevels[cap->irq] = !digitalRead(cap->pinName);
+    attachInterrupt(digitalPinToInterrupt(cap->pinName), captureIsrs[cap->irq],
+                    CHANGE);
+  }
+  if (cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22)
+    pinMode(cap->pinName, INPUT_PULLUP);
+#ifdef WS_HAS_RMT
+  if (cap->rmtChannel != -1)
+    rmt_rx_start((rmt_channel_t)cap->rmtChannel, true);
+#endif
+  cap->state = WS_CAPTURE_ARMED;
+  cap->stateTime = micros();
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Collects the widths recorded by an armed capture into _widths,
+            once the capture completed or timed out.
+    @param  cap
+            The armed capture.
+    @param  timedOut
+            True if the capture ran for longer than its timeout.
+    @returns  True if the capture is over and _widths holds its levels,
+              False if it is still recording.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::readCapture(pulseCapture *cap,
+                                             bool timedOut) {
+  _widthCount = 0;
+#ifdef WS_HAS_RMT
+  if (cap->rmtChannel != -1) {
+    rmt_channel_t ch = (rmt_channel_t)cap->rmtChannel;
+    RingbufHandle_t ringbuf = NULL;
+    size_t size = 0;
+    rmt_item32_t *items = NULL;
+    if (rmt_get_ringbuf_handle(ch, &ringbuf) == ESP_OK)
+      items = (rmt_item32_t *)xRingbufferReceive(ringbuf, &size, 0);
+    if (items == NULL && !timedOut)
+      return false;
+    rmt_rx_stop(ch);
+    if (items == NULL)
+      return true;
+    uint32_t tickUs =
+        cap->mode ==
+                wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22
+            ? 1
+            : 2;
+    _firstLevel = items[0].level0;
+    // items hold two levels each, a zero duration ends the frame
+    for (size_t i = 0; i < size / sizeof(rmt_item32_t); i++) {
+      if (items[i].duration0 == 0 || _widthCount == WS_PULSE_CAPTURE_WIDTHS)
+        break;
+      _widths[_widthCount++] = items[i].duration0 * tickUs;
+      if (items[i].duration1 == 0 || _widthCount == WS_PULSE_CAPTURE_WIDTHS)
+        break;
+      _widths[_widthCount++] = items[i].duration1 * tickUs;
+    }
+    vRingbufferReturnItem(ringbuf, items);
+    return true;
+  }
+#endif
+  if (cap->irq == -1)
+    return true;
+  // edges which bound the widths the capture mode decodes
+  uint8_t needed = 3;
+  if (cap->mode ==
+      wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO)
+    needed = 2;
+  else if (cap->mode ==
+           wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22)
+    needed = 84; // line released, response and 40 bits
+  if (captureEdges[cap->irq] < needed && !timedOut)
+    return false;
+  detachInterrupt(digitalPinToInterrupt(cap->pinName));
+  uint8_t edges = captureEdges[cap->irq];
+  _firstLevel = captureFirstLevels[cap->irq];
+  _widthCount = edges > 0 ? min(edges - 1, WS_PULSE_CAPTURE_WIDTHS) : 0;
+  for (uint16_t i = 0; i < _widthCount; i++)
+    _widths[i] = captureWidths[cap->irq][i];
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Decodes the widths of a completed capture and publishes the
+            values: a pulse's width in micros, an echo's distance in cm,
+            a DHT22's temperature in C and relative humidity in percent.
+    @param  cap
+            The completed capture.
+    @returns  True if the capture was decoded and published, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::decodeCapture(pulseCapture *cap) {
+  int idx;
+  switch (cap->mode) {
+  case wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_PULSE_HIGH:
+  case wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_PULSE_LOW:
+    idx = findWidth(
+        cap->mode ==
+                wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_PULSE_HIGH
+            ? HIGH
+            : LOW);
+    return idx != -1 &&
+           publishValue(cap, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RAW,
+                        _widths[idx]);
+  case wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO:
+    idx = findWidth(HIGH);
+    return idx != -1 &&
+           publishValue(cap,
+                        wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_PROXIMITY,
+                        _widths[idx] / WS_PULSE_CAPTURE_US_PER_CM);
+  case wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22: {
+    float temperature, humidity;
+    return decodeDHT22(&temperature, &humidity) &&
+           publishValue(
+               cap,
+               wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_AMBIENT_TEMPERATURE,
+               temperature) &&
+           publishValue(
+               cap, wippersnapper_i2c_v1_SensorType_SENSOR_TYPE_RELATIVE_HUMIDITY,
+               humidity);
+  }
+  }
+  return false;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Finds the first complete level of a capture.
+    @param  level
+            The level, LOW or HIGH.
+    @returns  Index of the level's width within _widths, -1 if none.
+*/
+/***********************************************************************************/
+int Wippersnapper_PulseCapture::findWidth(uint8_t level) {
+  for (uint16_t i = 0; i < _widthCount; i++) {
+    if (((_firstLevel ^ i) & 1) == level)
+      return i;
+  }
+  return -1;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Decodes a DHT22 frame. After its 80us low and 80us high
+            response, the sensor sends 40 bits as a 50us low followed by
+            a 26-28us high for a 0 or a 70us high for a 1. The bits are
+            the last 40 highs of the capture, so a partial level before
+            the response is skipped.
+    @param  temperature
+            Set to the temperature, in degrees C.
+    @param  humidity
+            Set to the relative humidity, in percent.
+    @returns  True if the frame was complete and its checksum matched.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::decodeDHT22(float *temperature,
+                                             float *humidity) {
+  uint8_t bytes[5] = {0};
+  int bit = 39;
+  for (int i = _widthCount - 1; i >= 0 && bit >= 0; i--) {
+    if (((_firstLevel ^ i) & 1) != HIGH)
+      continue;
+    if (_widths[i] > WS_PULSE_CAPTURE_DHT_ONE_US)
+      bytes[bit >> 3] |= 0x80 >> (bit & 7);
+    bit--;
+  }
+  if (bit >= 0)
+    return false; // frame cut short
+  if ((uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4] ||
+      (bytes[0] | bytes[1] | bytes[2] | bytes[3]) == 0)
+    return false; // corrupted, or a line stuck low
+  *humidity = ((bytes[0] << 8) | bytes[1]) * 0.1f;
+  *temperature = (((bytes[2] & 0x7F) << 8) | bytes[3]) * 0.1f;
+  if (bytes[2] & 0x80)
+    *temperature = -*temperature;
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Caches a decoded value and publishes it as a pin event.
+    @param  cap
+            The capture the value was decoded from.
+    @param  sensorType
+            The value's SensorType.
+    @param  value
+            The decoded value.
+    @returns  True if the pin event was encoded, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PulseCapture::publishValue(pulseCapture *cap,
+                                              uint8_t sensorType, float value) {
+  uint16_t channel = WS_CHANNEL_DIGITAL(cap->pinName);
+  WS._lastValue->update(channel, sensorType, value);
+
+  wippersnapper_signal_v1_CreateSignalRequest msg =
+      wippersnapper_signal_v1_CreateSignalRequest_init_zero;
+  msg.which_payload = wippersnapper_signal_v1_CreateSignalRequest_pin_event_tag;
+  wippersnapper_pin_v1_PinEvent *event = &msg.payload.pin_event;
+  if (WS._numericPinValues) {
+    event->pin_id = channel;
+    event->which_numeric_value =
+        wippersnapper_pin_v1_PinEvent_pin_value_float_tag;
+    event->numeric_value.pin_value_float = value;
+  } else {
+    sprintf(event->pin_name, "D%d", cap->pinName);
+    Wippersnapper::formatPinValue(event->pin_value, sizeof(event->pin_value),
+                                  value);
+  }
+  event->sensor_type = sensorType;
+
+  WS_DEBUG_PRINT("Encoding captured value...");
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(WS._buffer_outgoing, sizeof(WS._buffer_outgoing));
+  if (!pb_encode(&stream, wippersnapper_signal_v1_CreateSignalRequest_fields,
+                 &msg)) {
+    WS_DEBUG_PRINTLN("ERROR: Unable to encode captured value");
+    return false;
+  }
+  WS_DEBUG_PRINTLN("Encoded!");
+  WS_DEBUG_PRINT("Publishing captured value...");
+  WS.queuePublish(WS._topic_signal_device, WS._buffer_outgoing,
+                  stream.bytes_written, WS_MSG_CLASS_TELEMETRY, channel);
+  WS_DEBUG_PRINTLN("Published!");
+  return true;
+}
@@ -0,0 +1,107 @@
+/*!
+ * @file Wippersnapper_PulseCapture.h
+ *
+ * Records the pulse trains of single-wire timing sensors in the
+ * background and decodes them from the main loop.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_PULSECAPTURE_H
+#define WIPPERSNAPPER_PULSECAPTURE_H
+
+#include "Wippersnapper.h"
+
+#ifndef WS_PULSE_CAPTURE_MAX
+#define WS_PULSE_CAPTURE_MAX 4 ///< Maximum number of pulse capture inputs
+#endif
+#define WS_PULSE_CAPTURE_WIDTHS                                                \
+  86 ///< Levels recorded per capture, a DHT22 frame takes 83
+#define WS_PULSE_CAPTURE_DHT_START_US                                          \
+  1100 ///< Time a DHT22's start signal is held low, in micros
+#define WS_PULSE_CAPTURE_DHT_MIN_PERIOD                                        \
+  2000 ///< Shortest time between DHT22 reads, in millis
+#define WS_PULSE_CAPTURE_DHT_TIMEOUT_US                                        \
+  10000 ///< Time a DHT22 frame may take, in micros
+#define WS_PULSE_CAPTURE_DHT_ONE_US                                            \
+  48 ///< High time above which a DHT22 bit is a 1, in micros
+#define WS_PULSE_CAPTURE_ECHO_TIMEOUT_US                                       \
+  60000 ///< Longest echo if none is set, past an out of range HC-SR04
+#define WS_PULSE_CAPTURE_PULSE_TIMEOUT_US                                      \
+  100000 ///< Longest pulse if none is set, in micros
+#define WS_PULSE_CAPTURE_US_PER_CM                                             \
+  58.3f ///< Echo time of an object 1cm away, at 343m/s
+
+/** Progress of a pulse capture input */
+typedef enum {
+  WS_CAPTURE_IDLE,     ///< Waiting for the input's next period
+  WS_CAPTURE_STARTING, ///< Holding a sensor's start signal
+  WS_CAPTURE_ARMED,    ///< Recording the sensor's pulses
+} ws_capture_state_t;
+
+/** A pin whose pulses are captured and decoded */
+struct pulseCapture {
+  uint8_t pinName;    ///< Pin name
+  uint8_t mode;       ///< Decoder, a CaptureMode
+  uint8_t triggerPin; ///< Pin pulsed to start an echo measurement
+  uint8_t state;      ///< Progress of the capture, a ws_capture_state_t
+  int8_t irq;         ///< Edge interrupt handler, -1 if not in use
+  int8_t rmtChannel;  ///< ESP32 RMT receive channel, -1 if not in use
+  long period;        ///< Time between captures, in millis
+  long prvPeriod;     ///< When the last capture started, in millis
+  uint32_t timeoutUs; ///< Longest time a capture may record, in micros
+  uint32_t stateTime; ///< When the capture entered its state, in micros
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that captures the pulse trains of single-wire timing
+            sensors, DHT22-style sensors, ultrasonic rangers and sensors
+            with a PWM output, without blocking the loop. Pulses are
+            recorded by the ESP32's RMT receiver where it fits the
+            signal, by timestamping edge interrupts otherwise, then
+            decoded from the main loop and published as pin events.
+*/
+/**************************************************************************/
+class Wippersnapper_PulseCapture {
+public:
+  Wippersnapper_PulseCapture();
+  ~Wippersnapper_PulseCapture();
+
+  bool
+  configureCapture(wippersnapper_pin_v1_ConfigurePulseCaptureRequest *msg);
+  void releaseCapture(uint8_t pinName);
+  bool isCapturePin(uint8_t pinName);
+  bool usesExtInt(uint8_t pinName);
+  void process();
+
+private:
+  pulseCapture *findCapture(uint8_t pinName);
+  bool attachReceiver(pulseCapture *cap);
+  void detachReceiver(pulseCapture *cap);
+  void startCapture(pulseCapture *cap);
+  void armCapture(pulseCapture *cap);
+  bool readCapture(pulseCapture *cap, bool timedOut);
+  bool decodeCapture(pulseCapture *cap);
+  int findWidth(uint8_t level);
+  bool decodeDHT22(float *temperature, float *humidity);
+  bool publishValue(pulseCapture *cap, uint8_t sensorType, float value);
+  pulseCapture _captures[WS_PULSE_CAPTURE_MAX]; ///< Captures, in use first
+  uint8_t _count = 0;                           ///< Captures in use
+  uint32_t _widths[WS_PULSE_CAPTURE_WIDTHS]; ///< Widths of the last capture
+  uint16_t _widthCount = 0;                  ///< Widths within _widths
+  uint8_t _firstLevel = 0;                   ///< Level of _widths[0]
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_PULSECAPTURE_H
@@ -0,0 +1,380 @@
+/*!
+ * @file Wippersnapper_PWM.cpp
+ *
+ * Drives PWM outputs from the board's hardware timers.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wippersnapper_PWM.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+// the Arduino core pairs LEDC channels on a timer, even channels only are
+// used so every output has a timer, and a frequency, of its own
+#ifdef SOC_LEDC_SUPPORT_HS_MODE
+#define WS_PWM_LEDC_CHANNELS (SOC_LEDC_CHANNEL_NUM << 1) ///< LEDC channels
+#else
+#define WS_PWM_LEDC_CHANNELS SOC_LEDC_CHANNEL_NUM ///< LEDC channels
+#endif
+#elif defined(ARDUINO_ARCH_SAMD)
+// TCC2 of the SAMD21, and TCC2 to TCC4 of the SAMD51, are 16-bit. A full
+// duty cycle compares at top + 1, so the period is one tick shorter.
+#define WS_PWM_TCC_MAX_TOP 0xFFFE ///< Longest period every TCC can count
+#ifdef __SAMD51__
+#define WS_TCC_PERB(tcc) ((tcc)->PERBUF.reg) ///< Buffered TCC period
+#define WS_TCC_CCB(tcc, ch)                                                    \
+  ((tcc)->CCBUF[ch].reg) ///< Buffered TCC compare value
+#else
+#define WS_TCC_PERB(tcc) ((tcc)->PERB.reg) ///< Buffered TCC period
+#define WS_TCC_CCB(tcc, ch) ((tcc)->CCB[ch].reg) ///< Buffered TCC compare
+#endif
+/** TCC clock divisors, by value of CTRLA.PRESCALER */
+static const uint16_t tccPrescalers[8] = {1, 2, 4, 8, 16, 64, 256, 1024};
+#endif
+
+/***********************************************************************************/
+/*!
+    @brief  Creates the PWM component, without any output.
+*/
+/***********************************************************************************/
+Wippersnapper_PWM::Wippersnapper_PWM() {}
+
+/***********************************************************************************/
+/*!
+    @brief  Releases every PWM output.
+*/
+/***********************************************************************************/
+Wippersnapper_PWM::~Wippersnapper_PWM() {
+  while (_count > 0)
+    releasePWMPin(_pins[0].pinName);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Configures a pin as a PWM output, or changes the frequency,
+            resolution or duty cycle of a PWM output.
+    @param  msg
+            The decoded ConfigurePWMPinRequest message. A frequency or
+            resolution of 0 selects the default.
+    @returns  True if the pin drives the requested PWM signal, False
+              otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PWM::configurePWMPin(
+    wippersnapper_pin_v1_ConfigurePWMPinRequest *msg) {
+  uint8_t pinName = atoi(msg->pin_name + 1);
+  if (!Wippersnapper_DigitalGPIO::isValidDigitalPin(pinName, true)) {
+    WS_DEBUG_PRINTLN("ERROR: PWM requested on a pin which is not an output");
+    return false;
+  }
+  // digital pins, encoder phases and captured pins belong to their
+  // component
+  if (findPWMPin(pinName) == NULL &&
+      (WS._digitalGPIO->isDigitalInput(pinName) ||
+       WS._digitalGPIO->isDigitalOutput(pinName) ||
+       WS._digitalGPIO->isEncoderPin(pinName) ||
+       WS._pulseCapture->isCapturePin(pinName) ||
+       WS._logicCapture->isCapturePin(pinName))) {
+    WS_DEBUG_PRINTLN("ERROR: PWM requested on a pin in use");
+    return false;
+  }
+  uint32_t frequency =
+      msg->frequency > 0 ? msg->frequency : WS_PWM_DEFAULT_FREQUENCY;
+  uint8_t resolution =
+      msg->resolution > 0 ? msg->resolution : WS_PWM_DEFAULT_RESOLUTION;
+  if (msg->frequency < 0 || resolution > WS_PWM_MAX_RESOLUTION) {
+    WS_DEBUG_PRINTLN("ERROR: Invalid PWM frequency or resolution");
+    return false;
+  }
+
+  pwmPin *pin = findPWMPin(pinName);
+  if (pin != NULL && (pin->frequency != frequency ||
+                      pin->resolution != resolution)) {
+    // the timer is set up again for the new period
+    releasePWMPin(pinName);
+    pin = NULL;
+  }
+  if (pin == NULL) {
+    if (_count == WS_PWM_MAX_PINS) {
+      WS_DEBUG_PRINTLN("ERROR: Every PWM output is in use");
+      return false;
+    }
+    pin = &_pins[_count];
+    pin->pinName = pinName;
+    pin->frequency = frequency;
+    pin->resolution = resolution;
+    pin->dutyCycle = 0;
+    pin->timer = -1;
+    pin->channel = 0;
+    pin->top = 0;
+    if (!attachTimer(pin))
+      return false;
+    _count++;
+    WS_DEBUG_PRINT("Configured PWM output on D");
+    WS_DEBUG_PRINT(pinName);
+    WS_DEBUG_PRINT(", frequency (Hz): ");
+    WS_DEBUG_PRINTLN(frequency);
+  }
+  return writeDutyCycle(pinName, msg->duty_cycle);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Changes the duty cycle of a PWM output. The new duty cycle
+            starts with the output's next period.
+    @param  pinName
+            The pin's name.
+    @param  dutyCycle
+            The duty cycle, from 0 to 2^resolution - 1. Values outside of
+            that range are clamped.
+    @returns  True if the pin is a PWM output, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PWM::writeDutyCycle(uint8_t pinName, int32_t dutyCycle) {
+  pwmPin *pin = findPWMPin(pinName);
+  if (pin == NULL) {
+    WS_DEBUG_PRINTLN("ERROR: PWM event for a pin which is not a PWM output");
+    return false;
+  }
+  int32_t maxDuty = (1L << pin->resolution) - 1;
+  pin->dutyCycle = constrain(dutyCycle, 0, maxDuty);
+  writeTimer(pin);
+  return true;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Stops the PWM signal of a pin and returns it to a high
+            impedance input.
+    @param  pinName
+            The pin's name.
+*/
+/***********************************************************************************/
+void Wippersnapper_PWM::releasePWMPin(uint8_t pinName) {
+  pwmPin *pin = findPWMPin(pinName);
+  if (pin == NULL)
+    return;
+  detachTimer(pin);
+  pinMode(pinName, INPUT); // hi-z
+  *pin = _pins[--_count];
+  WS_DEBUG_PRINT("Released PWM output on D");
+  WS_DEBUG_PRINTLN(pinName);
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Checks if a pin is a PWM output.
+    @param  pinName
+            The pin's name.
+    @returns  True if the pin is a PWM output, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PWM::isPWMPin(uint8_t pinName) {
+  return findPWMPin(pinName) != NULL;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Finds a PWM output.
+    @param  pinName
+            The pin's name.
+    @returns  The PWM output, NULL if the pin is not a PWM output.
+*/
+/***********************************************************************************/
+pwmPin *Wippersnapper_PWM::findPWMPin(uint8_t pinName) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_pins[i].pinName == pinName)
+      return &_pins[i];
+  }
+  return NULL;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Sets up the hardware timer of a new PWM output. ESP32 outputs
+            take a free LEDC channel. SAMD pins driven by a TCC share its
+            period with the other outputs of that TCC, the first picks
+            the TCC's prescaler so its frequency fits the counter. Pins
+            driven by a TC keep the core's frequency. Other boards rely
+            on analogWrite().
+    @param  pin
+            The PWM output, its frequency and resolution set.
+    @returns  True if the output has a timer, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PWM::attachTimer(pwmPin *pin) {
+#if defined(ARDUINO_ARCH_ESP32)
+  for (int8_t channel = 0; channel < WS_PWM_LEDC_CHANNELS; channel += 2) {
+    bool used = false;
+    for (uint8_t i = 0; i < _count; i++)
+      used |= _pins[i].timer == channel;
+    if (used)
+      continue;
+    // fails when the frequency is too high for the resolution
+    if (ledcSetup(channel, pin->frequency, pin->resolution) == 0) {
+      WS_DEBUG_PRINTLN("ERROR: PWM frequency unreachable at this resolution");
+      return false;
+    }
+    ledcAttachPin(pin->pinName, channel);
+    pin->timer = channel;
+    return true;
+  }
+  WS_DEBUG_PRINTLN("ERROR: No free LEDC channel for PWM output");
+  return false;
+#elif defined(ARDUINO_ARCH_SAMD)
+  uint32_t pwmChannel = g_APinDescription[pin->pinName].ulPWMChannel;
+  if (pwmChannel == NOT_ON_PWM) {
+    WS_DEBUG_PRINTLN("ERROR: Pin has no PWM timer");
+    return false;
+  }
+  if (WS._logicCapture->usesTimerOf(pin->pinName)) {
+    WS_DEBUG_PRINTLN("ERROR: Pin's PWM timer is taking a logic capture");
+    return false;
+  }
+  // the core muxes the pin onto its timer and starts the timer
+  analogWrite(pin->pinName, 0);
+  uint8_t tccNum = GetTCNumber(pwmChannel);
+  if (tccNum >= TCC_INST_NUM) {
+    WS_DEBUG_PRINTLN("Pin is driven by a TC, keeping the core's frequency");
+    return true;
+  }
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_pins[i].timer == tccNum && _pins[i].frequency != pin->frequency) {
+      WS_DEBUG_PRINTLN("ERROR: PWM frequency differs from its TCC's outputs");
+      pinMode(pin->pinName, INPUT);
+      return false;
+    }
+  }
+
+  Tcc *tcc = (Tcc *)GetTC(pwmChannel);
+  uint8_t div = (tcc->CTRLA.reg & TCC_CTRLA_PRESCALER_Msk) >>
+                TCC_CTRLA_PRESCALER_Pos;
+  bool shared = sharesTimer(tccNum);
+  if (!shared) {
+    // the fastest clock whose period fits the counter, the finest duty
+    for (div = 0; div < 7; div++) {
+      if (F_CPU / tccPrescalers[div] / pin->frequency <= WS_PWM_TCC_MAX_TOP + 1)
+        break;
+    }
+  }
+  uint32_t ticks = F_CPU / tccPrescalers[div] / pin->frequency;
+  if (ticks < 2 || ticks > WS_PWM_TCC_MAX_TOP + 1) {
+    WS_DEBUG_PRINTLN("ERROR: PWM frequency outside of the TCC's range");
+    pinMode(pin->pinName, INPUT);
+    return false;
+  }
+  uint32_t top = ticks - 1;
+  if (top < (1UL << pin->resolution) - 1) {
+    WS_DEBUG_PRINTLN("PWM frequency too high, resolution reduced");
+  }
+  pin->timer = tccNum;
+  pin->channel = GetTCChannelNumber(pwmChannel);
+  pin->top = top;
+  if (!shared && (tcc->CTRLA.reg & TCC_CTRLA_PRESCALER_Msk) !=
+                     TCC_CTRLA_PRESCALER(div)) {
+    // the prescaler is enable-protected, the period is written directly
+    tcc->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+    while (tcc->SYNCBUSY.reg)
+      ;
+    tcc->CTRLA.reg =
+        (tcc->CTRLA.reg & ~TCC_CTRLA_PRESCALER_Msk) | TCC_CTRLA_PRESCALER(div);
+    tcc->PER.reg = top;
+    tcc->CTRLA.reg |= TCC_CTRLA_ENABLE;
+    while (tcc->SYNCBUSY.reg)
+      ;
+    return true;
+  }
+  // the new period starts with the timer's next cycle
+  tcc->CTRLBSET.reg = TCC_CTRLBSET_LUPD;
+  WS_TCC_PERB(tcc) = top;
+  tcc->CTRLBCLR.reg = TCC_CTRLBCLR_LUPD;
+  while (tcc->SYNCBUSY.reg)
+    ;
+  return true;
+#else
+  return true;
+#endif
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+/***********************************************************************************/
+/*!
+    @brief  Checks if a TCC drives a PWM output already.
+    @param  tccNum
+            The TCC's number.
+    @returns  True if a PWM output uses the TCC, False otherwise.
+*/
+/***********************************************************************************/
+bool Wippersnapper_PWM::sharesTimer(uint8_t tccNum) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_pins[i].timer == tccNum)
+      return true;
+  }
+  return false;
+}
+#endif
+
+/***********************************************************************************/
+/*!
+    @brief  Releases the hardware timer of a PWM output.
+    @param  pin
+            The PWM output.
+*/
+/***********************************************************************************/
+void Wippersnapper_PWM::detachTimer(pwmPin *pin) {
+#if defined(ARDUINO_ARCH_ESP32)
+  if (pin->timer != -1)
+    ledcDetachPin(pin->pinName);
+#else
+  // a TCC keeps running for its other outputs
+  pin->dutyCycle = 0;
+  writeTimer(pin);
+#endif
+  pin->timer = -1;
+}
+
+/***********************************************************************************/
+/*!
+    @brief  Writes the duty cycle of a PWM output to its timer. LEDC
+            channels and TCCs latch a new duty cycle at the end of the
+            current period.
+    @param  pin
+            The PWM output.
+*/
+/***********************************************************************************/
+void Wippersnapper_PWM::writeTimer(pwmPin *pin) {
+  uint32_t maxDuty = (1UL << pin->resolution) - 1;
+#if defined(ARDUINO_ARCH_ESP32)
+  ledcWrite(pin->timer, pin->dutyCycle);
+  (void)maxDuty;
+#else
+#if defined(ARDUINO_ARCH_SAMD)
+  if (pin->timer != -1) {
+    Tcc *tcc = (Tcc *)GetTC(g_APinDescription[pin->pinName].ulPWMChannel);
+    // a full duty cycle compares past the period, so the output stays
+    // high, top is below the counter's maximum so top + 1 still fits
+    uint32_t cc =
+        (uint32_t)pin->dutyCycle == maxDuty
+            ? pin->top + 1
+            : ((uint64_t)pin->dutyCycle * (pin->top + 1)) >> pin->resolution;
+    tcc->CTRLBSET.reg = TCC_CTRLBSET_LUPD;
+    WS_TCC_CCB(tcc, pin->channel) = cc;
+    tcc->CTRLBCLR.reg = TCC_CTRLBCLR_LUPD;
+    while (tcc->SYNCBUSY.reg)
+      ;
+    return;
+  }
+#endif
+  // analogWrite() takes 8-bit duty cycles
+  uint32_t value = pin->resolution > 8 ? pin->dutyCycle >> (pin->resolution - 8)
+                                       : (pin->dutyCycle * 255) / maxDuty;
+  analogWrite(pin->pinName, value);
+#endif
+}
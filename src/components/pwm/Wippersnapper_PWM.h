@@ -0,0 +1,75 @@
+/*!
+ * @file Wippersnapper_PWM.h
+ *
+ * Drives PWM outputs from the board's hardware timers.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * Copyright (c) Brent Rubell 2022 for Adafruit Industries.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef WIPPERSNAPPER_PWM_H
+#define WIPPERSNAPPER_PWM_H
+
+#include "Wippersnapper.h"
+
+#ifndef WS_PWM_MAX_PINS
+#define WS_PWM_MAX_PINS 8 ///< Maximum number of PWM outputs
+#endif
+#define WS_PWM_DEFAULT_FREQUENCY 5000 ///< Frequency if none is set, in Hz
+#define WS_PWM_DEFAULT_RESOLUTION 8   ///< Resolution if none is set, in bits
+#define WS_PWM_MAX_RESOLUTION 16      ///< Finest duty cycle resolution, in bits
+
+/** A PWM output */
+struct pwmPin {
+  uint8_t pinName;    ///< Pin name
+  uint8_t resolution; ///< Duty cycle resolution, in bits
+  uint32_t frequency; ///< Output frequency, in Hz
+  int32_t dutyCycle;  ///< Duty cycle, from 0 to 2^resolution - 1
+  int8_t timer;       ///< ESP32 LEDC channel or SAMD TCC, -1 if none
+  uint8_t channel;    ///< SAMD TCC compare channel
+  uint32_t top;       ///< SAMD TCC period, in timer ticks
+};
+
+// forward decl.
+class Wippersnapper;
+
+/**************************************************************************/
+/*!
+    @brief  Class that maps PWM outputs onto the board's hardware timers,
+            the ESP32's LEDC channels or the SAMD's TCC timers. Their
+            duty cycles are written to buffered registers, so a new duty
+            cycle starts at the next period boundary and the output
+            never glitches. Other boards and pins without a TCC use
+            analogWrite(), which may cut a period short.
+*/
+/**************************************************************************/
+class Wippersnapper_PWM {
+public:
+  Wippersnapper_PWM();
+  ~Wippersnapper_PWM();
+
+  bool configurePWMPin(wippersnapper_pin_v1_ConfigurePWMPinRequest *msg);
+  bool writeDutyCycle(uint8_t pinName, int32_t dutyCycle);
+  void releasePWMPin(uint8_t pinName);
+  bool isPWMPin(uint8_t pinName);
+
+private:
+  pwmPin *findPWMPin(uint8_t pinName);
+  bool attachTimer(pwmPin *pin);
+  void detachTimer(pwmPin *pin);
+  void writeTimer(pwmPin *pin);
+#if defined(ARDUINO_ARCH_SAMD)
+  bool sharesTimer(uint8_t tccNum);
+#endif
+  pwmPin _pins[WS_PWM_MAX_PINS]; ///< PWM outputs, in use first
+  uint8_t _count = 0;            ///< Number of PWM outputs in use
+};
+extern Wippersnapper WS;
+
+#endif // WIPPERSNAPPER_PWM_H
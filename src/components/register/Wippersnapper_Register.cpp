@@ -41,6 +41,9 @@ bool Wippersnapper::encodePubRegistrationReq() {
   // Set version
   strcpy(_message.str_version, WS_VERSION);
 
+  // Offer numeric pin values, the broker decides in its response
+  _message.numeric_pin_values = true;
+
   // encode registration request message
   uint8_t _message_buffer[256];
   pb_ostream_t _msg_stream =
@@ -84,6 +87,51 @@ void Wippersnapper::pollRegistrationResp() {
   }
 }
 
+/****************************************************************************/
+/*!
+    @brief    Initializes the hardware components described by a
+              registration response. Components which already exist, set
+              up from the configuration cache, are kept unless the
+              response describes other pin hardware.
+    @param    message
+              The registration response message.
+*/
+/****************************************************************************/
+void Wippersnapper::applyRegistration(
+    wippersnapper_description_v1_CreateDescriptionResponse *message) {
+  WS_DEBUG_PRINTLN("Hardware Response Msg:")
+  WS_DEBUG_PRINT("\tGPIO Pins: ");
+  WS_DEBUG_PRINTLN(message->total_gpio_pins);
+  WS_DEBUG_PRINT("\tAnalog Pins: ");
+  WS_DEBUG_PRINTLN(message->total_analog_pins);
+  WS_DEBUG_PRINT("\tReference voltage: ");
+  WS_DEBUG_PRINT(message->reference_voltage);
+  WS_DEBUG_PRINTLN("v");
+  WS_DEBUG_PRINT("\tNumeric pin values: ");
+  WS_DEBUG_PRINTLN(message->numeric_pin_values);
+  WS._numericPinValues = message->numeric_pin_values;
+  // The cached pins were set up for other hardware, release them and
+  // rebuild the components for this description
+  if (WS._configCache->hardwareChanged(message)) {
+    WS_DEBUG_PRINTLN("Hardware description changed, discarding cached pins");
+    WS._configCache->invalidatePins();
+    delete WS._digitalGPIO;
+    WS._digitalGPIO = NULL;
+    delete WS._analogIO;
+    WS._analogIO = NULL;
+  }
+  // Initialize Digital IO class
+  if (WS._digitalGPIO == NULL)
+    WS._digitalGPIO = new Wippersnapper_DigitalGPIO(message->total_gpio_pins);
+  // Initialize Analog IO class
+  if (WS._analogIO == NULL)
+    WS._analogIO = new Wippersnapper_AnalogIO(message->total_analog_pins,
+                                              message->reference_voltage);
+  // Size the last-value cache for this hardware's pins and I2C sensors
+  WS._lastValue->allocate(message->total_gpio_pins +
+                          message->total_analog_pins);
+}
+
 /****************************************************************************/
 /*!
     @brief    Decodes hardware registration response message from the
@@ -114,19 +162,9 @@ void Wippersnapper::decodeRegistrationResp(char *data, uint16_t len) {
   // Decode registration response message
   if (message.response ==
       wippersnapper_description_v1_CreateDescriptionResponse_Response_RESPONSE_OK) {
-    WS_DEBUG_PRINTLN("Hardware Response Msg:")
-    WS_DEBUG_PRINT("\tGPIO Pins: ");
-    WS_DEBUG_PRINTLN(message.total_gpio_pins);
-    WS_DEBUG_PRINT("\tAnalog Pins: ");
-    WS_DEBUG_PRINTLN(message.total_analog_pins);
-    WS_DEBUG_PRINT("\tReference voltage: ");
-    WS_DEBUG_PRINT(message.reference_voltage);
-    WS_DEBUG_PRINTLN("v");
-    // Initialize Digital IO class
-    WS._digitalGPIO = new Wippersnapper_DigitalGPIO(message.total_gpio_pins);
-    // Initialize Analog IO class
-    WS._analogIO = new Wippersnapper_AnalogIO(message.total_analog_pins,
-                                              message.reference_voltage);
+    applyRegistration(&message);
+    // Cache the response, pins and devices are reconciled against it
+    WS._configCache->registered(&message);
     WS._boardStatus = WS_BOARD_DEF_OK;
 
     // Publish RegistrationComplete message to broker
@@ -111,14 +111,82 @@ void WipperSnapper_LittleFS::parseSecrets() {
   // set password
   WS._network_pass = network_type_wifi_native_network_password;
 
+  // Optional, Set the outbound message QoS policy
+  WS._outbound->configureQoS(_doc["qos"]);
+  // Optional, Set the minimum sampling rate of channels
+  WS._outbound->configureSampling(_doc["max_period"]);
+  // Optional, Set the channels whose telemetry is batched
+  WS._batch->configureBatch(_doc["batch"]);
+
   // close the file
   secretsFile.close();
 
   // clear the document and release all memory from the memory pool
   _doc.clear();
 
-  // stop LittleFS, we no longer need it
-  LittleFS.end();
+  // LittleFS stays mounted, it also holds the configuration cache
+}
+
+/**************************************************************************/
+/*!
+    @brief    Replaces the contents of a file on the LittleFS filesystem.
+              The data is written to a temporary file which is then
+              renamed over the file, LittleFS renames atomically so a
+              reset never leaves a partial file at path.
+    @param    path
+              Path of the file.
+    @param    data
+              Data to write.
+    @param    len
+              Length of data, in bytes.
+    @returns  True if the whole file was written, False otherwise.
+*/
+/**************************************************************************/
+bool WipperSnapper_LittleFS::writeBinaryFile(const char *path,
+                                             const uint8_t *data, size_t len) {
+  char tmpPath[64];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+  File file = LittleFS.open(tmpPath, "w");
+  if (!file) {
+    WS_DEBUG_PRINT("ERROR: Unable to open file for writing: ");
+    WS_DEBUG_PRINTLN(tmpPath);
+    return false;
+  }
+  size_t written = file.write(data, len);
+  file.close();
+  if (written != len) {
+    LittleFS.remove(tmpPath);
+    return false;
+  }
+  return LittleFS.rename(tmpPath, path);
+}
+
+/**************************************************************************/
+/*!
+    @brief    Reads a whole file from the LittleFS filesystem.
+    @param    path
+              Path of the file.
+    @param    len
+              Set to the length of the file, in bytes.
+    @returns  Buffer holding the file, which must be freed by the caller.
+              NULL if the file does not exist or could not be read.
+*/
+/**************************************************************************/
+uint8_t *WipperSnapper_LittleFS::readBinaryFile(const char *path,
+                                                size_t *len) {
+  if (!LittleFS.exists(path))
+    return NULL;
+  File file = LittleFS.open(path, "r");
+  if (!file)
+    return NULL;
+  *len = file.size();
+  uint8_t *data = (uint8_t *)malloc(*len > 0 ? *len : 1);
+  if (data != NULL && file.read(data, *len) != *len) {
+    free(data);
+    data = NULL;
+  }
+  file.close();
+  return data;
 }
 
 void WipperSnapper_LittleFS::fsHalt() {
@@ -36,11 +36,18 @@ public:
   void parseSecrets();
   void fsHalt();
 
+  bool writeBinaryFile(const char *path, const uint8_t *data, size_t len);
+  uint8_t *readBinaryFile(const char *path, size_t *len);
+
 private:
   // NOTE: calculated capacity with maximum
   // length of usernames/passwords/tokens
-  // is 382 bytes, rounded to nearest power of 2.
-  StaticJsonDocument<512> _doc; /*!< Json configuration file */
+  // is 382 bytes. The optional "qos" (5 keys
+  // and 8 channels), "max_period" (8 channels)
+  // and "batch" (8 channels) add 35 members
+  // to the root and their objects, 560 bytes,
+  // plus about 190 bytes of copied strings.
+  StaticJsonDocument<1152> _doc; /*!< Json configuration file */
 };
 
 extern Wippersnapper WS;
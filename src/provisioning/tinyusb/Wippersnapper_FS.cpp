@@ -446,6 +446,13 @@ void Wippersnapper_FS::parseSecrets() {
   // Optional, Set the IO URL
   WS._mqttBrokerURL = doc["io_url"];
 
+  // Optional, Set the outbound message QoS policy
+  WS._outbound->configureQoS(doc["qos"]);
+  // Optional, Set the minimum sampling rate of channels
+  WS._outbound->configureSampling(doc["max_period"]);
+  // Optional, Set the channels whose telemetry is batched
+  WS._batch->configureBatch(doc["batch"]);
+
   // clear the document and release all memory from the memory pool
   doc.clear();
 
@@ -472,6 +479,88 @@ void Wippersnapper_FS::writeErrorToBootOut(PGM_P str) {
   }
 }
 
+/**************************************************************************/
+/*!
+    @brief    Replaces the contents of a file on the flash filesystem.
+              The data is written to a temporary file which then replaces
+              the file, so a reset never leaves a partial file at path.
+              Nothing is written while a USB host has the filesystem
+              mounted: the host caches the volume and a write it did not
+              make corrupts its view of the disk.
+    @param    path
+              Path of the file.
+    @param    data
+              Data to write.
+    @param    len
+              Length of data, in bytes.
+    @returns  True if the whole file was written, False otherwise.
+*/
+/**************************************************************************/
+bool Wippersnapper_FS::writeBinaryFile(const char *path, const uint8_t *data,
+                                       size_t len) {
+  if (TinyUSBDevice.mounted()) {
+    WS_DEBUG_PRINTLN("ERROR: Filesystem is mounted by a USB host, not writing");
+    return false;
+  }
+  char tmpPath[64];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+  // FILE_WRITE appends, remove any previous attempt first
+  if (wipperFatFs.exists(tmpPath))
+    wipperFatFs.remove(tmpPath);
+  File file = wipperFatFs.open(tmpPath, FILE_WRITE);
+  if (!file) {
+    WS_DEBUG_PRINT("ERROR: Unable to open file for writing: ");
+    WS_DEBUG_PRINTLN(tmpPath);
+    return false;
+  }
+  size_t written = file.write(data, len);
+  file.flush();
+  file.close();
+  if (written != len) {
+    wipperFatFs.remove(tmpPath);
+    return false;
+  }
+  // FAT cannot rename over a file, readBinaryFile() falls back to the
+  // temporary file if a reset lands between the two
+  if (wipperFatFs.exists(path) && !wipperFatFs.remove(path))
+    return false;
+  return wipperFatFs.rename(tmpPath, path);
+}
+
+/**************************************************************************/
+/*!
+    @brief    Reads a whole file from the flash filesystem.
+    @param    path
+              Path of the file.
+    @param    len
+              Set to the length of the file, in bytes.
+    @returns  Buffer holding the file, which must be freed by the caller.
+              NULL if the file does not exist or could not be read.
+*/
+/**************************************************************************/
+uint8_t *Wippersnapper_FS::readBinaryFile(const char *path, size_t *len) {
+  char tmpPath[64];
+  if (!wipperFatFs.exists(path)) {
+    // a reset between removing the file and renaming its replacement
+    // leaves the complete replacement under its temporary name
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    if (!wipperFatFs.exists(tmpPath))
+      return NULL;
+    path = tmpPath;
+  }
+  File file = wipperFatFs.open(path);
+  if (!file)
+    return NULL;
+  *len = file.size();
+  uint8_t *data = (uint8_t *)malloc(*len > 0 ? *len : 1);
+  if (data != NULL && file.read(data, *len) != (int)*len) {
+    free(data);
+    data = NULL;
+  }
+  file.close();
+  return data;
+}
+
 /**************************************************************************/
 /*!
     @brief    Halts execution and blinks the status LEDs yellow.
@@ -56,6 +56,9 @@ public:
   void writeErrorToBootOut(PGM_P str);
   void fsHalt();
 
+  bool writeBinaryFile(const char *path, const uint8_t *data, size_t len);
+  uint8_t *readBinaryFile(const char *path, size_t *len);
+
   void parseSecrets();
 
   bool setNetwork; /*!< True if a network interface type was set up, False
@@ -63,8 +66,12 @@ public:
 
   // NOTE: calculated capacity with maximum
   // length of usernames/passwords/tokens
-  // is 382 bytes, rounded to nearest power of 2.
-  StaticJsonDocument<512> doc; /*!< Json configuration file */
+  // is 382 bytes. The optional "qos" (5 keys
+  // and 8 channels), "max_period" (8 channels)
+  // and "batch" (8 channels) add 35 members
+  // to the root and their objects, 560 bytes,
+  // plus about 190 bytes of copied strings.
+  StaticJsonDocument<1152> doc; /*!< Json configuration file */
 private:
   bool _freshFS = false; /*!< True if filesystem was initialized by
                             WipperSnapper, False otherwise. */
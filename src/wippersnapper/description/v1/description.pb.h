@@ -35,6 +35,7 @@ typedef struct _wippersnapper_description_v1_CreateDescriptionRequest {
     int32_t mac_addr;
     int32_t usb_vid;
     int32_t usb_pid;
+    bool numeric_pin_values;
     char str_version[20];
 } wippersnapper_description_v1_CreateDescriptionRequest;
 
@@ -44,6 +45,7 @@ typedef struct _wippersnapper_description_v1_CreateDescriptionResponse {
     int32_t total_analog_pins;
     float reference_voltage;
     int32_t total_i2c_ports;
+    bool numeric_pin_values;
 } wippersnapper_description_v1_CreateDescriptionResponse;
 
 typedef struct _wippersnapper_description_v1_RegistrationComplete {
@@ -62,15 +64,15 @@ extern "C" {
 #endif
 
 /* Initializer values for message structs */
-#define wippersnapper_description_v1_CreateDescriptionRequest_init_default {"", 0, 0, 0, ""}
+#define wippersnapper_description_v1_CreateDescriptionRequest_init_default {"", 0, 0, 0, 0, ""}
 #define wippersnapper_description_v1_CreateDescriptionRequest_Version_init_default {0}
-#define wippersnapper_description_v1_CreateDescriptionResponse_init_default {_wippersnapper_description_v1_CreateDescriptionResponse_Response_MIN, 0, 0, 0, 0}
+#define wippersnapper_description_v1_CreateDescriptionResponse_init_default {_wippersnapper_description_v1_CreateDescriptionResponse_Response_MIN, 0, 0, 0, 0, 0}
 #define wippersnapper_description_v1_RegistrationComplete_init_default {0}
 #define wippersnapper_description_v1_GetDefinitionRequest_init_default {0}
 #define wippersnapper_description_v1_GetDefinitionResponse_init_default {0}
-#define wippersnapper_description_v1_CreateDescriptionRequest_init_zero {"", 0, 0, 0, ""}
+#define wippersnapper_description_v1_CreateDescriptionRequest_init_zero {"", 0, 0, 0, 0, ""}
 #define wippersnapper_description_v1_CreateDescriptionRequest_Version_init_zero {0}
-#define wippersnapper_description_v1_CreateDescriptionResponse_init_zero {_wippersnapper_description_v1_CreateDescriptionResponse_Response_MIN, 0, 0, 0, 0}
+#define wippersnapper_description_v1_CreateDescriptionResponse_init_zero {_wippersnapper_description_v1_CreateDescriptionResponse_Response_MIN, 0, 0, 0, 0, 0}
 #define wippersnapper_description_v1_RegistrationComplete_init_zero {0}
 #define wippersnapper_description_v1_GetDefinitionRequest_init_zero {0}
 #define wippersnapper_description_v1_GetDefinitionResponse_init_zero {0}
@@ -80,12 +82,14 @@ extern "C" {
 #define wippersnapper_description_v1_CreateDescriptionRequest_mac_addr_tag 2
 #define wippersnapper_description_v1_CreateDescriptionRequest_usb_vid_tag 3
 #define wippersnapper_description_v1_CreateDescriptionRequest_usb_pid_tag 4
+#define wippersnapper_description_v1_CreateDescriptionRequest_numeric_pin_values_tag 5
 #define wippersnapper_description_v1_CreateDescriptionRequest_str_version_tag 15
 #define wippersnapper_description_v1_CreateDescriptionResponse_response_tag 1
 #define wippersnapper_description_v1_CreateDescriptionResponse_total_gpio_pins_tag 2
 #define wippersnapper_description_v1_CreateDescriptionResponse_total_analog_pins_tag 3
 #define wippersnapper_description_v1_CreateDescriptionResponse_reference_voltage_tag 4
 #define wippersnapper_description_v1_CreateDescriptionResponse_total_i2c_ports_tag 5
+#define wippersnapper_description_v1_CreateDescriptionResponse_numeric_pin_values_tag 6
 #define wippersnapper_description_v1_RegistrationComplete_is_complete_tag 1
 
 /* Struct field encoding specification for nanopb */
@@ -94,6 +98,7 @@ X(a, STATIC,   SINGULAR, STRING,   machine_name,      1) \
 X(a, STATIC,   SINGULAR, INT32,    mac_addr,          2) \
 X(a, STATIC,   SINGULAR, INT32,    usb_vid,           3) \
 X(a, STATIC,   SINGULAR, INT32,    usb_pid,           4) \
+X(a, STATIC,   SINGULAR, BOOL,     numeric_pin_values,   5) \
 X(a, STATIC,   SINGULAR, STRING,   str_version,      15)
 #define wippersnapper_description_v1_CreateDescriptionRequest_CALLBACK NULL
 #define wippersnapper_description_v1_CreateDescriptionRequest_DEFAULT NULL
@@ -108,7 +113,8 @@ X(a, STATIC,   SINGULAR, UENUM,    response,          1) \
 X(a, STATIC,   SINGULAR, INT32,    total_gpio_pins,   2) \
 X(a, STATIC,   SINGULAR, INT32,    total_analog_pins,   3) \
 X(a, STATIC,   SINGULAR, FLOAT,    reference_voltage,   4) \
-X(a, STATIC,   SINGULAR, INT32,    total_i2c_ports,   5)
+X(a, STATIC,   SINGULAR, INT32,    total_i2c_ports,   5) \
+X(a, STATIC,   SINGULAR, BOOL,     numeric_pin_values,   6)
 #define wippersnapper_description_v1_CreateDescriptionResponse_CALLBACK NULL
 #define wippersnapper_description_v1_CreateDescriptionResponse_DEFAULT NULL
 
@@ -143,9 +149,9 @@ extern const pb_msgdesc_t wippersnapper_description_v1_GetDefinitionResponse_msg
 #define wippersnapper_description_v1_GetDefinitionResponse_fields &wippersnapper_description_v1_GetDefinitionResponse_msg
 
 /* Maximum encoded size of messages (where known) */
-#define wippersnapper_description_v1_CreateDescriptionRequest_size 119
+#define wippersnapper_description_v1_CreateDescriptionRequest_size 121
 #define wippersnapper_description_v1_CreateDescriptionRequest_Version_size 0
-#define wippersnapper_description_v1_CreateDescriptionResponse_size 40
+#define wippersnapper_description_v1_CreateDescriptionResponse_size 42
 #define wippersnapper_description_v1_RegistrationComplete_size 2
 #define wippersnapper_description_v1_GetDefinitionRequest_size 0
 #define wippersnapper_description_v1_GetDefinitionResponse_size 0
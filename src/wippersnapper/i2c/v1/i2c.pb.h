@@ -97,6 +97,9 @@ typedef struct _wippersnapper_i2c_v1_I2CDeviceInitResponse {
 typedef struct _wippersnapper_i2c_v1_I2CDeviceSensorProperties {
     wippersnapper_i2c_v1_SensorType sensor_type;
     uint32_t sensor_period;
+    float sensor_deadband_abs;
+    float sensor_deadband_rel;
+    uint32_t sensor_max_silence;
 } wippersnapper_i2c_v1_I2CDeviceSensorProperties;
 
 typedef struct _wippersnapper_i2c_v1_I2CDeviceUpdateResponse {
@@ -160,7 +163,7 @@ extern "C" {
 #define wippersnapper_i2c_v1_I2CBusSetFrequency_init_default {0, 0}
 #define wippersnapper_i2c_v1_I2CBusScanRequest_init_default {0, false, wippersnapper_i2c_v1_I2CBusInitRequest_init_default}
 #define wippersnapper_i2c_v1_I2CBusScanResponse_init_default {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, _wippersnapper_i2c_v1_BusResponse_MIN}
-#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default {_wippersnapper_i2c_v1_SensorType_MIN, 0}
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default {_wippersnapper_i2c_v1_SensorType_MIN, 0, 0, 0, 0}
 #define wippersnapper_i2c_v1_I2CDeviceInitRequests_init_default {{{NULL}, NULL}}
 #define wippersnapper_i2c_v1_I2CDeviceInitRequest_init_default {0, false, wippersnapper_i2c_v1_I2CBusInitRequest_init_default, 0, "", 0, {wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_default}}
 #define wippersnapper_i2c_v1_I2CDeviceInitResponse_init_default {0, _wippersnapper_i2c_v1_BusResponse_MIN}
@@ -175,7 +178,7 @@ extern "C" {
 #define wippersnapper_i2c_v1_I2CBusSetFrequency_init_zero {0, 0}
 #define wippersnapper_i2c_v1_I2CBusScanRequest_init_zero {0, false, wippersnapper_i2c_v1_I2CBusInitRequest_init_zero}
 #define wippersnapper_i2c_v1_I2CBusScanResponse_init_zero {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, _wippersnapper_i2c_v1_BusResponse_MIN}
-#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero {_wippersnapper_i2c_v1_SensorType_MIN, 0}
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero {_wippersnapper_i2c_v1_SensorType_MIN, 0, 0, 0, 0}
 #define wippersnapper_i2c_v1_I2CDeviceInitRequests_init_zero {{{NULL}, NULL}}
 #define wippersnapper_i2c_v1_I2CDeviceInitRequest_init_zero {0, false, wippersnapper_i2c_v1_I2CBusInitRequest_init_zero, 0, "", 0, {wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero, wippersnapper_i2c_v1_I2CDeviceSensorProperties_init_zero}}
 #define wippersnapper_i2c_v1_I2CDeviceInitResponse_init_zero {0, _wippersnapper_i2c_v1_BusResponse_MIN}
@@ -205,6 +208,9 @@ extern "C" {
 #define wippersnapper_i2c_v1_I2CDeviceInitResponse_bus_response_tag 3
 #define wippersnapper_i2c_v1_I2CDeviceSensorProperties_sensor_type_tag 1
 #define wippersnapper_i2c_v1_I2CDeviceSensorProperties_sensor_period_tag 2
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_sensor_deadband_abs_tag 3
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_sensor_deadband_rel_tag 4
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_sensor_max_silence_tag 5
 #define wippersnapper_i2c_v1_I2CDeviceUpdateResponse_i2c_device_address_tag 1
 #define wippersnapper_i2c_v1_I2CDeviceUpdateResponse_bus_response_tag 3
 #define wippersnapper_i2c_v1_SensorEvent_type_tag 1
@@ -258,7 +264,10 @@ X(a, STATIC,   SINGULAR, UENUM,    bus_response,      2)
 
 #define wippersnapper_i2c_v1_I2CDeviceSensorProperties_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UENUM,    sensor_type,       1) \
-X(a, STATIC,   SINGULAR, UINT32,   sensor_period,     2)
+X(a, STATIC,   SINGULAR, UINT32,   sensor_period,     2) \
+X(a, STATIC,   SINGULAR, FLOAT,    sensor_deadband_abs,   3) \
+X(a, STATIC,   SINGULAR, FLOAT,    sensor_deadband_rel,   4) \
+X(a, STATIC,   SINGULAR, UINT32,   sensor_max_silence,   5)
 #define wippersnapper_i2c_v1_I2CDeviceSensorProperties_CALLBACK NULL
 #define wippersnapper_i2c_v1_I2CDeviceSensorProperties_DEFAULT NULL
 
@@ -364,11 +373,11 @@ extern const pb_msgdesc_t wippersnapper_i2c_v1_I2CDeviceEvent_msg;
 #define wippersnapper_i2c_v1_I2CBusSetFrequency_size 17
 #define wippersnapper_i2c_v1_I2CBusScanRequest_size 52
 #define wippersnapper_i2c_v1_I2CBusScanResponse_size 722
-#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_size 8
+#define wippersnapper_i2c_v1_I2CDeviceSensorProperties_size 24
 /* wippersnapper_i2c_v1_I2CDeviceInitRequests_size depends on runtime parameters */
-#define wippersnapper_i2c_v1_I2CDeviceInitRequest_size 224
+#define wippersnapper_i2c_v1_I2CDeviceInitRequest_size 464
 #define wippersnapper_i2c_v1_I2CDeviceInitResponse_size 8
-#define wippersnapper_i2c_v1_I2CDeviceUpdateRequest_size 183
+#define wippersnapper_i2c_v1_I2CDeviceUpdateRequest_size 423
 #define wippersnapper_i2c_v1_I2CDeviceUpdateResponse_size 8
 #define wippersnapper_i2c_v1_I2CDeviceDeinitRequest_size 17
 #define wippersnapper_i2c_v1_I2CDeviceDeinitResponse_size 8
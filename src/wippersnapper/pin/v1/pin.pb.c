@@ -15,6 +15,12 @@ PB_BIND(wippersnapper_pin_v1_ConfigurePinRequest, wippersnapper_pin_v1_Configure
 PB_BIND(wippersnapper_pin_v1_PinEvent, wippersnapper_pin_v1_PinEvent, AUTO)
 
 
+PB_BIND(wippersnapper_pin_v1_PinCountEvent, wippersnapper_pin_v1_PinCountEvent, AUTO)
+
+
+PB_BIND(wippersnapper_pin_v1_PinEncoderEvent, wippersnapper_pin_v1_PinEncoderEvent, AUTO)
+
+
 PB_BIND(wippersnapper_pin_v1_ConfigureReferenceVoltage, wippersnapper_pin_v1_ConfigureReferenceVoltage, AUTO)
 
 
@@ -33,6 +39,18 @@ PB_BIND(wippersnapper_pin_v1_PWMPinEvent, wippersnapper_pin_v1_PWMPinEvent, AUTO
 PB_BIND(wippersnapper_pin_v1_PWMPinEvents, wippersnapper_pin_v1_PWMPinEvents, AUTO)
 
 
+PB_BIND(wippersnapper_pin_v1_ConfigurePulseCaptureRequest, wippersnapper_pin_v1_ConfigurePulseCaptureRequest, AUTO)
+
+
+PB_BIND(wippersnapper_pin_v1_ConfigurePulseCaptureRequests, wippersnapper_pin_v1_ConfigurePulseCaptureRequests, AUTO)
+
+
+PB_BIND(wippersnapper_pin_v1_LogicCaptureRequest, wippersnapper_pin_v1_LogicCaptureRequest, AUTO)
+
+
+PB_BIND(wippersnapper_pin_v1_LogicCapture, wippersnapper_pin_v1_LogicCapture, AUTO)
+
+
 
 
 
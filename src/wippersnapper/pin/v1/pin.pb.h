@@ -42,6 +42,29 @@ typedef enum _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode {
     wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE = 2
 } wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode;
 
+typedef enum _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode {
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_UNSPECIFIED = 0,
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_LEVEL = 1,
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_PULSE_COUNT = 2,
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE = 3
+} wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode;
+
+typedef enum _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode {
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_UNSPECIFIED = 0,
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_PULSE_HIGH = 1,
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_PULSE_LOW = 2,
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_ECHO = 3,
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22 = 4
+} wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode;
+
+typedef enum _wippersnapper_pin_v1_LogicCaptureRequest_Trigger {
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_UNSPECIFIED = 0,
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_IMMEDIATE = 1,
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_RISING = 2,
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_FALLING = 3,
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_CHANGE = 4
+} wippersnapper_pin_v1_LogicCaptureRequest_Trigger;
+
 /* Struct definitions */
 typedef struct _wippersnapper_pin_v1_ConfigurePWMPinRequests {
     pb_callback_t list;
@@ -51,6 +74,10 @@ typedef struct _wippersnapper_pin_v1_ConfigurePinRequests {
     pb_callback_t list;
 } wippersnapper_pin_v1_ConfigurePinRequests;
 
+typedef struct _wippersnapper_pin_v1_ConfigurePulseCaptureRequests {
+    pb_callback_t list;
+} wippersnapper_pin_v1_ConfigurePulseCaptureRequests;
+
 typedef struct _wippersnapper_pin_v1_PWMPinEvents {
     pb_callback_t list;
 } wippersnapper_pin_v1_PWMPinEvents;
@@ -64,8 +91,18 @@ typedef struct _wippersnapper_pin_v1_ConfigurePWMPinRequest {
     int32_t duty_cycle;
     int32_t frequency;
     bool variable_frequency;
+    uint32_t resolution;
 } wippersnapper_pin_v1_ConfigurePWMPinRequest;
 
+typedef struct _wippersnapper_pin_v1_ConfigurePulseCaptureRequest {
+    char pin_name[5];
+    wippersnapper_pin_v1_ConfigurePinRequest_RequestType request_type;
+    wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode capture_mode;
+    float period;
+    uint32_t trigger_pin;
+    uint32_t timeout_us;
+} wippersnapper_pin_v1_ConfigurePulseCaptureRequest;
+
 typedef struct _wippersnapper_pin_v1_ConfigurePinRequest {
     char pin_name[5];
     wippersnapper_pin_v1_Mode mode;
@@ -75,6 +112,10 @@ typedef struct _wippersnapper_pin_v1_ConfigurePinRequest {
     wippersnapper_pin_v1_ConfigurePinRequest_RequestType request_type;
     float aref;
     wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode analog_read_mode;
+    uint32_t debounce_us;
+    wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode digital_read_mode;
+    uint32_t encoder_pin;
+    uint32_t change_threshold;
 } wippersnapper_pin_v1_ConfigurePinRequest;
 
 typedef struct _wippersnapper_pin_v1_ConfigureReferenceVoltage {
@@ -82,14 +123,56 @@ typedef struct _wippersnapper_pin_v1_ConfigureReferenceVoltage {
 } wippersnapper_pin_v1_ConfigureReferenceVoltage;
 
 typedef struct _wippersnapper_pin_v1_PWMPinEvent {
+    char pin_name[5];
     int32_t duty_cycle;
 } wippersnapper_pin_v1_PWMPinEvent;
 
 typedef struct _wippersnapper_pin_v1_PinEvent {
     char pin_name[5];
     char pin_value[12];
+    uint32_t pin_id;
+    pb_size_t which_numeric_value;
+    union {
+        int32_t pin_value_int;
+        float pin_value_float;
+    } numeric_value;
+    uint32_t sensor_type;
 } wippersnapper_pin_v1_PinEvent;
 
+typedef struct _wippersnapper_pin_v1_PinCountEvent {
+    uint32_t pin_id;
+    uint32_t count;
+    float rate;
+    float frequency;
+} wippersnapper_pin_v1_PinCountEvent;
+
+typedef struct _wippersnapper_pin_v1_PinEncoderEvent {
+    uint32_t pin_id;
+    int32_t position;
+    float velocity;
+} wippersnapper_pin_v1_PinEncoderEvent;
+
+typedef struct _wippersnapper_pin_v1_LogicCaptureRequest {
+    pb_size_t pins_count;
+    uint32_t pins[8];
+    uint32_t sample_rate_hz;
+    wippersnapper_pin_v1_LogicCaptureRequest_Trigger trigger;
+    uint32_t trigger_pin;
+    uint32_t samples;
+    uint32_t pre_trigger_samples;
+    uint32_t timeout_ms;
+} wippersnapper_pin_v1_LogicCaptureRequest;
+
+typedef struct _wippersnapper_pin_v1_LogicCapture {
+    pb_size_t pins_count;
+    uint32_t pins[8];
+    uint32_t sample_rate_hz;
+    uint32_t sample_count;
+    uint32_t trigger_sample;
+    bool triggered;
+    pb_callback_t runs;
+} wippersnapper_pin_v1_LogicCapture;
+
 
 /* Helper constants for enums */
 #define _wippersnapper_pin_v1_Mode_MIN wippersnapper_pin_v1_Mode_MODE_UNSPECIFIED
@@ -112,6 +195,18 @@ typedef struct _wippersnapper_pin_v1_PinEvent {
 #define _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_MAX wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE
 #define _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ARRAYSIZE ((wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode)(wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_ANALOG_READ_MODE_PIN_VOLTAGE+1))
 
+#define _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_MIN wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_UNSPECIFIED
+#define _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_MAX wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE
+#define _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_ARRAYSIZE ((wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode)(wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_DIGITAL_READ_MODE_QUADRATURE+1))
+
+#define _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_MIN wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_UNSPECIFIED
+#define _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_MAX wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22
+#define _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_ARRAYSIZE ((wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode)(wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_CAPTURE_MODE_DHT22+1))
+
+#define _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_MIN wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_UNSPECIFIED
+#define _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_MAX wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_CHANGE
+#define _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_ARRAYSIZE ((wippersnapper_pin_v1_LogicCaptureRequest_Trigger)(wippersnapper_pin_v1_LogicCaptureRequest_Trigger_TRIGGER_CHANGE+1))
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -119,33 +214,53 @@ extern "C" {
 
 /* Initializer values for message structs */
 #define wippersnapper_pin_v1_ConfigurePinRequests_init_default {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_ConfigurePinRequest_init_default {"", _wippersnapper_pin_v1_Mode_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Direction_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Pull_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_MIN}
-#define wippersnapper_pin_v1_PinEvent_init_default {"", ""}
+#define wippersnapper_pin_v1_ConfigurePinRequest_init_default {"", _wippersnapper_pin_v1_Mode_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Direction_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Pull_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_MIN, 0, 0}
+#define wippersnapper_pin_v1_PinEvent_init_default {"", "", 0, 0, {0}, 0}
+#define wippersnapper_pin_v1_PinCountEvent_init_default {0, 0, 0, 0}
+#define wippersnapper_pin_v1_PinEncoderEvent_init_default {0, 0, 0}
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_init_default {0}
 #define wippersnapper_pin_v1_PinEvents_init_default {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_ConfigurePWMPinRequest_init_default {"", 0, 0, 0}
+#define wippersnapper_pin_v1_ConfigurePWMPinRequest_init_default {"", 0, 0, 0, 0}
 #define wippersnapper_pin_v1_ConfigurePWMPinRequests_init_default {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_PWMPinEvent_init_default {0}
+#define wippersnapper_pin_v1_PWMPinEvent_init_default {"", 0}
 #define wippersnapper_pin_v1_PWMPinEvents_init_default {{{NULL}, NULL}}
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_init_default {"", _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_MIN, 0, 0, 0}
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_init_default {{{NULL}, NULL}}
+#define wippersnapper_pin_v1_LogicCaptureRequest_init_default {0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_MIN, 0, 0, 0, 0}
+#define wippersnapper_pin_v1_LogicCapture_init_default {0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, 0, {{NULL}, NULL}}
 #define wippersnapper_pin_v1_ConfigurePinRequests_init_zero {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_ConfigurePinRequest_init_zero {"", _wippersnapper_pin_v1_Mode_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Direction_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Pull_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_MIN}
-#define wippersnapper_pin_v1_PinEvent_init_zero  {"", ""}
+#define wippersnapper_pin_v1_ConfigurePinRequest_init_zero {"", _wippersnapper_pin_v1_Mode_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Direction_MIN, _wippersnapper_pin_v1_ConfigurePinRequest_Pull_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_AnalogReadMode_MIN, 0, _wippersnapper_pin_v1_ConfigurePinRequest_DigitalReadMode_MIN, 0, 0}
+#define wippersnapper_pin_v1_PinEvent_init_zero  {"", "", 0, 0, {0}, 0}
+#define wippersnapper_pin_v1_PinCountEvent_init_zero {0, 0, 0, 0}
+#define wippersnapper_pin_v1_PinEncoderEvent_init_zero {0, 0, 0}
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_init_zero {0}
 #define wippersnapper_pin_v1_PinEvents_init_zero {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_ConfigurePWMPinRequest_init_zero {"", 0, 0, 0}
+#define wippersnapper_pin_v1_ConfigurePWMPinRequest_init_zero {"", 0, 0, 0, 0}
 #define wippersnapper_pin_v1_ConfigurePWMPinRequests_init_zero {{{NULL}, NULL}}
-#define wippersnapper_pin_v1_PWMPinEvent_init_zero {0}
+#define wippersnapper_pin_v1_PWMPinEvent_init_zero {"", 0}
 #define wippersnapper_pin_v1_PWMPinEvents_init_zero {{{NULL}, NULL}}
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_init_zero {"", _wippersnapper_pin_v1_ConfigurePinRequest_RequestType_MIN, _wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CaptureMode_MIN, 0, 0, 0}
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_init_zero {{{NULL}, NULL}}
+#define wippersnapper_pin_v1_LogicCaptureRequest_init_zero {0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, _wippersnapper_pin_v1_LogicCaptureRequest_Trigger_MIN, 0, 0, 0, 0}
+#define wippersnapper_pin_v1_LogicCapture_init_zero {0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, 0, {{NULL}, NULL}}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define wippersnapper_pin_v1_ConfigurePWMPinRequests_list_tag 1
 #define wippersnapper_pin_v1_ConfigurePinRequests_list_tag 1
 #define wippersnapper_pin_v1_PWMPinEvents_list_tag 1
 #define wippersnapper_pin_v1_PinEvents_list_tag  1
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_list_tag 1
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_pin_name_tag 1
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_request_type_tag 2
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_capture_mode_tag 3
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_period_tag 4
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_trigger_pin_tag 5
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_timeout_us_tag 6
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_pin_name_tag 1
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_duty_cycle_tag 2
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_frequency_tag 3
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_variable_frequency_tag 4
+#define wippersnapper_pin_v1_ConfigurePWMPinRequest_resolution_tag 5
 #define wippersnapper_pin_v1_ConfigurePinRequest_pin_name_tag 1
 #define wippersnapper_pin_v1_ConfigurePinRequest_mode_tag 2
 #define wippersnapper_pin_v1_ConfigurePinRequest_direction_tag 3
@@ -154,10 +269,39 @@ extern "C" {
 #define wippersnapper_pin_v1_ConfigurePinRequest_request_type_tag 6
 #define wippersnapper_pin_v1_ConfigurePinRequest_aref_tag 7
 #define wippersnapper_pin_v1_ConfigurePinRequest_analog_read_mode_tag 8
+#define wippersnapper_pin_v1_ConfigurePinRequest_debounce_us_tag 9
+#define wippersnapper_pin_v1_ConfigurePinRequest_digital_read_mode_tag 10
+#define wippersnapper_pin_v1_ConfigurePinRequest_encoder_pin_tag 11
+#define wippersnapper_pin_v1_ConfigurePinRequest_change_threshold_tag 12
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_reference_voltage_tag 1
+#define wippersnapper_pin_v1_PWMPinEvent_pin_name_tag 1
 #define wippersnapper_pin_v1_PWMPinEvent_duty_cycle_tag 2
 #define wippersnapper_pin_v1_PinEvent_pin_name_tag 1
 #define wippersnapper_pin_v1_PinEvent_pin_value_tag 2
+#define wippersnapper_pin_v1_PinEvent_pin_id_tag 3
+#define wippersnapper_pin_v1_PinEvent_pin_value_int_tag 4
+#define wippersnapper_pin_v1_PinEvent_pin_value_float_tag 5
+#define wippersnapper_pin_v1_PinEvent_sensor_type_tag 6
+#define wippersnapper_pin_v1_PinCountEvent_pin_id_tag 1
+#define wippersnapper_pin_v1_PinCountEvent_count_tag 2
+#define wippersnapper_pin_v1_PinCountEvent_rate_tag 3
+#define wippersnapper_pin_v1_PinCountEvent_frequency_tag 4
+#define wippersnapper_pin_v1_PinEncoderEvent_pin_id_tag 1
+#define wippersnapper_pin_v1_PinEncoderEvent_position_tag 2
+#define wippersnapper_pin_v1_PinEncoderEvent_velocity_tag 3
+#define wippersnapper_pin_v1_LogicCaptureRequest_pins_tag 1
+#define wippersnapper_pin_v1_LogicCaptureRequest_sample_rate_hz_tag 2
+#define wippersnapper_pin_v1_LogicCaptureRequest_trigger_tag 3
+#define wippersnapper_pin_v1_LogicCaptureRequest_trigger_pin_tag 4
+#define wippersnapper_pin_v1_LogicCaptureRequest_samples_tag 5
+#define wippersnapper_pin_v1_LogicCaptureRequest_pre_trigger_samples_tag 6
+#define wippersnapper_pin_v1_LogicCaptureRequest_timeout_ms_tag 7
+#define wippersnapper_pin_v1_LogicCapture_pins_tag 1
+#define wippersnapper_pin_v1_LogicCapture_sample_rate_hz_tag 2
+#define wippersnapper_pin_v1_LogicCapture_sample_count_tag 3
+#define wippersnapper_pin_v1_LogicCapture_trigger_sample_tag 4
+#define wippersnapper_pin_v1_LogicCapture_triggered_tag 5
+#define wippersnapper_pin_v1_LogicCapture_runs_tag 6
 
 /* Struct field encoding specification for nanopb */
 #define wippersnapper_pin_v1_ConfigurePinRequests_FIELDLIST(X, a) \
@@ -174,16 +318,39 @@ X(a, STATIC,   SINGULAR, UENUM,    pull,              4) \
 X(a, STATIC,   SINGULAR, FLOAT,    period,            5) \
 X(a, STATIC,   SINGULAR, UENUM,    request_type,      6) \
 X(a, STATIC,   SINGULAR, FLOAT,    aref,              7) \
-X(a, STATIC,   SINGULAR, UENUM,    analog_read_mode,   8)
+X(a, STATIC,   SINGULAR, UENUM,    analog_read_mode,   8) \
+X(a, STATIC,   SINGULAR, UINT32,   debounce_us,       9) \
+X(a, STATIC,   SINGULAR, UENUM,    digital_read_mode,  10) \
+X(a, STATIC,   SINGULAR, UINT32,   encoder_pin,      11) \
+X(a, STATIC,   SINGULAR, UINT32,   change_threshold,  12)
 #define wippersnapper_pin_v1_ConfigurePinRequest_CALLBACK NULL
 #define wippersnapper_pin_v1_ConfigurePinRequest_DEFAULT NULL
 
 #define wippersnapper_pin_v1_PinEvent_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, STRING,   pin_name,          1) \
-X(a, STATIC,   SINGULAR, STRING,   pin_value,         2)
+X(a, STATIC,   SINGULAR, STRING,   pin_value,         2) \
+X(a, STATIC,   SINGULAR, UINT32,   pin_id,            3) \
+X(a, STATIC,   ONEOF,    SINT32,   (numeric_value,pin_value_int,numeric_value.pin_value_int),   4) \
+X(a, STATIC,   ONEOF,    FLOAT,    (numeric_value,pin_value_float,numeric_value.pin_value_float),   5) \
+X(a, STATIC,   SINGULAR, UINT32,   sensor_type,       6)
 #define wippersnapper_pin_v1_PinEvent_CALLBACK NULL
 #define wippersnapper_pin_v1_PinEvent_DEFAULT NULL
 
+#define wippersnapper_pin_v1_PinCountEvent_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   pin_id,            1) \
+X(a, STATIC,   SINGULAR, UINT32,   count,             2) \
+X(a, STATIC,   SINGULAR, FLOAT,    rate,              3) \
+X(a, STATIC,   SINGULAR, FLOAT,    frequency,         4)
+#define wippersnapper_pin_v1_PinCountEvent_CALLBACK NULL
+#define wippersnapper_pin_v1_PinCountEvent_DEFAULT NULL
+
+#define wippersnapper_pin_v1_PinEncoderEvent_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   pin_id,            1) \
+X(a, STATIC,   SINGULAR, SINT32,   position,          2) \
+X(a, STATIC,   SINGULAR, FLOAT,    velocity,          3)
+#define wippersnapper_pin_v1_PinEncoderEvent_CALLBACK NULL
+#define wippersnapper_pin_v1_PinEncoderEvent_DEFAULT NULL
+
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, FLOAT,    reference_voltage,   1)
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_CALLBACK NULL
@@ -199,7 +366,8 @@ X(a, CALLBACK, REPEATED, MESSAGE,  list,              1)
 X(a, STATIC,   SINGULAR, STRING,   pin_name,          1) \
 X(a, STATIC,   SINGULAR, INT32,    duty_cycle,        2) \
 X(a, STATIC,   SINGULAR, INT32,    frequency,         3) \
-X(a, STATIC,   SINGULAR, BOOL,     variable_frequency,   4)
+X(a, STATIC,   SINGULAR, BOOL,     variable_frequency,   4) \
+X(a, STATIC,   SINGULAR, UINT32,   resolution,        5)
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_CALLBACK NULL
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_DEFAULT NULL
 
@@ -210,6 +378,7 @@ X(a, CALLBACK, REPEATED, MESSAGE,  list,              1)
 #define wippersnapper_pin_v1_ConfigurePWMPinRequests_list_MSGTYPE wippersnapper_pin_v1_ConfigurePWMPinRequest
 
 #define wippersnapper_pin_v1_PWMPinEvent_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, STRING,   pin_name,          1) \
 X(a, STATIC,   SINGULAR, INT32,    duty_cycle,        2)
 #define wippersnapper_pin_v1_PWMPinEvent_CALLBACK NULL
 #define wippersnapper_pin_v1_PWMPinEvent_DEFAULT NULL
@@ -220,37 +389,92 @@ X(a, CALLBACK, REPEATED, MESSAGE,  list,              1)
 #define wippersnapper_pin_v1_PWMPinEvents_DEFAULT NULL
 #define wippersnapper_pin_v1_PWMPinEvents_list_MSGTYPE wippersnapper_pin_v1_PWMPinEvent
 
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, STRING,   pin_name,          1) \
+X(a, STATIC,   SINGULAR, UENUM,    request_type,      2) \
+X(a, STATIC,   SINGULAR, UENUM,    capture_mode,      3) \
+X(a, STATIC,   SINGULAR, FLOAT,    period,            4) \
+X(a, STATIC,   SINGULAR, UINT32,   trigger_pin,       5) \
+X(a, STATIC,   SINGULAR, UINT32,   timeout_us,        6)
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_CALLBACK NULL
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_DEFAULT NULL
+
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_FIELDLIST(X, a) \
+X(a, CALLBACK, REPEATED, MESSAGE,  list,              1)
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_CALLBACK pb_default_field_callback
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_DEFAULT NULL
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_list_MSGTYPE wippersnapper_pin_v1_ConfigurePulseCaptureRequest
+
+#define wippersnapper_pin_v1_LogicCaptureRequest_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, UINT32,   pins,              1) \
+X(a, STATIC,   SINGULAR, UINT32,   sample_rate_hz,    2) \
+X(a, STATIC,   SINGULAR, UENUM,    trigger,           3) \
+X(a, STATIC,   SINGULAR, UINT32,   trigger_pin,       4) \
+X(a, STATIC,   SINGULAR, UINT32,   samples,           5) \
+X(a, STATIC,   SINGULAR, UINT32,   pre_trigger_samples,   6) \
+X(a, STATIC,   SINGULAR, UINT32,   timeout_ms,        7)
+#define wippersnapper_pin_v1_LogicCaptureRequest_CALLBACK NULL
+#define wippersnapper_pin_v1_LogicCaptureRequest_DEFAULT NULL
+
+#define wippersnapper_pin_v1_LogicCapture_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, UINT32,   pins,              1) \
+X(a, STATIC,   SINGULAR, UINT32,   sample_rate_hz,    2) \
+X(a, STATIC,   SINGULAR, UINT32,   sample_count,      3) \
+X(a, STATIC,   SINGULAR, UINT32,   trigger_sample,    4) \
+X(a, STATIC,   SINGULAR, BOOL,     triggered,         5) \
+X(a, CALLBACK, SINGULAR, BYTES,    runs,              6)
+#define wippersnapper_pin_v1_LogicCapture_CALLBACK pb_default_field_callback
+#define wippersnapper_pin_v1_LogicCapture_DEFAULT NULL
+
 extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePinRequests_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePinRequest_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_PinEvent_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_PinCountEvent_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_PinEncoderEvent_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigureReferenceVoltage_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_PinEvents_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePWMPinRequest_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePWMPinRequests_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_PWMPinEvent_msg;
 extern const pb_msgdesc_t wippersnapper_pin_v1_PWMPinEvents_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePulseCaptureRequest_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_ConfigurePulseCaptureRequests_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_LogicCaptureRequest_msg;
+extern const pb_msgdesc_t wippersnapper_pin_v1_LogicCapture_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define wippersnapper_pin_v1_ConfigurePinRequests_fields &wippersnapper_pin_v1_ConfigurePinRequests_msg
 #define wippersnapper_pin_v1_ConfigurePinRequest_fields &wippersnapper_pin_v1_ConfigurePinRequest_msg
 #define wippersnapper_pin_v1_PinEvent_fields &wippersnapper_pin_v1_PinEvent_msg
+#define wippersnapper_pin_v1_PinCountEvent_fields &wippersnapper_pin_v1_PinCountEvent_msg
+#define wippersnapper_pin_v1_PinEncoderEvent_fields &wippersnapper_pin_v1_PinEncoderEvent_msg
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_fields &wippersnapper_pin_v1_ConfigureReferenceVoltage_msg
 #define wippersnapper_pin_v1_PinEvents_fields &wippersnapper_pin_v1_PinEvents_msg
 #define wippersnapper_pin_v1_ConfigurePWMPinRequest_fields &wippersnapper_pin_v1_ConfigurePWMPinRequest_msg
 #define wippersnapper_pin_v1_ConfigurePWMPinRequests_fields &wippersnapper_pin_v1_ConfigurePWMPinRequests_msg
 #define wippersnapper_pin_v1_PWMPinEvent_fields &wippersnapper_pin_v1_PWMPinEvent_msg
 #define wippersnapper_pin_v1_PWMPinEvents_fields &wippersnapper_pin_v1_PWMPinEvents_msg
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_fields &wippersnapper_pin_v1_ConfigurePulseCaptureRequest_msg
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequests_fields &wippersnapper_pin_v1_ConfigurePulseCaptureRequests_msg
+#define wippersnapper_pin_v1_LogicCaptureRequest_fields &wippersnapper_pin_v1_LogicCaptureRequest_msg
+#define wippersnapper_pin_v1_LogicCapture_fields &wippersnapper_pin_v1_LogicCapture_msg
 
 /* Maximum encoded size of messages (where known) */
 /* wippersnapper_pin_v1_ConfigurePinRequests_size depends on runtime parameters */
-#define wippersnapper_pin_v1_ConfigurePinRequest_size 26
-#define wippersnapper_pin_v1_PinEvent_size       19
+#define wippersnapper_pin_v1_ConfigurePinRequest_size 46
+#define wippersnapper_pin_v1_PinEvent_size       37
+#define wippersnapper_pin_v1_PinCountEvent_size  22
+#define wippersnapper_pin_v1_PinEncoderEvent_size 17
 #define wippersnapper_pin_v1_ConfigureReferenceVoltage_size 5
 /* wippersnapper_pin_v1_PinEvents_size depends on runtime parameters */
-#define wippersnapper_pin_v1_ConfigurePWMPinRequest_size 30
+#define wippersnapper_pin_v1_ConfigurePWMPinRequest_size 36
 /* wippersnapper_pin_v1_ConfigurePWMPinRequests_size depends on runtime parameters */
-#define wippersnapper_pin_v1_PWMPinEvent_size    11
+#define wippersnapper_pin_v1_PWMPinEvent_size    17
 /* wippersnapper_pin_v1_PWMPinEvents_size depends on runtime parameters */
+#define wippersnapper_pin_v1_ConfigurePulseCaptureRequest_size 27
+/* wippersnapper_pin_v1_ConfigurePulseCaptureRequests_size depends on runtime parameters */
+#define wippersnapper_pin_v1_LogicCaptureRequest_size 82
+/* wippersnapper_pin_v1_LogicCapture_size depends on runtime parameters */
 
 #ifdef __cplusplus
 } /* extern "C" */
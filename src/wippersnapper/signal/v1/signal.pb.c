@@ -18,4 +18,19 @@ PB_BIND(wippersnapper_signal_v1_CreateSignalRequest, wippersnapper_signal_v1_Cre
 PB_BIND(wippersnapper_signal_v1_SignalResponse, wippersnapper_signal_v1_SignalResponse, AUTO)
 
 
+PB_BIND(wippersnapper_signal_v1_ReadValuesRequest, wippersnapper_signal_v1_ReadValuesRequest, AUTO)
+
+
+PB_BIND(wippersnapper_signal_v1_ChannelValue, wippersnapper_signal_v1_ChannelValue, AUTO)
+
+
+PB_BIND(wippersnapper_signal_v1_ReadValuesResponse, wippersnapper_signal_v1_ReadValuesResponse, AUTO)
+
+
+PB_BIND(wippersnapper_signal_v1_TelemetryBatch, wippersnapper_signal_v1_TelemetryBatch, AUTO)
+
+
+PB_BIND(wippersnapper_signal_v1_TimeSeries, wippersnapper_signal_v1_TimeSeries, AUTO)
+
+
 
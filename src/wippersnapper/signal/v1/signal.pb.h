@@ -12,7 +12,45 @@
 #error Regenerate this file with the current version of nanopb generator.
 #endif
 
+/* Enum definitions */
+typedef enum _wippersnapper_signal_v1_ValueQuality {
+    wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_UNSPECIFIED = 0,
+    wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_GOOD = 1,
+    wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_READ_FAILED = 2
+} wippersnapper_signal_v1_ValueQuality;
+
 /* Struct definitions */
+typedef struct _wippersnapper_signal_v1_ReadValuesResponse {
+    pb_callback_t values;
+} wippersnapper_signal_v1_ReadValuesResponse;
+
+typedef struct _wippersnapper_signal_v1_ChannelValue {
+    uint32_t channel;
+    uint32_t sensor_type;
+    float value;
+    uint32_t age_ms;
+    wippersnapper_signal_v1_ValueQuality quality;
+} wippersnapper_signal_v1_ChannelValue;
+
+typedef struct _wippersnapper_signal_v1_ReadValuesRequest {
+    uint32_t max_age_ms;
+    pb_size_t channels_count;
+    uint32_t channels[8];
+} wippersnapper_signal_v1_ReadValuesRequest;
+
+typedef struct _wippersnapper_signal_v1_TelemetryBatch {
+    pb_callback_t series;
+    uint32_t device_time;
+} wippersnapper_signal_v1_TelemetryBatch;
+
+typedef struct _wippersnapper_signal_v1_TimeSeries {
+    char pin_name[5];
+    uint32_t i2c_device_address;
+    wippersnapper_i2c_v1_SensorType sensor_type;
+    uint32_t count;
+    pb_callback_t samples;
+} wippersnapper_signal_v1_TimeSeries;
+
 typedef struct _wippersnapper_signal_v1_CreateSignalRequest {
     pb_callback_t cb_payload;
     pb_size_t which_payload;
@@ -22,6 +60,13 @@ typedef struct _wippersnapper_signal_v1_CreateSignalRequest {
         wippersnapper_pin_v1_ConfigurePWMPinRequests pwm_pin_config;
         wippersnapper_pin_v1_PWMPinEvents pwm_pin_event;
         wippersnapper_pin_v1_PinEvent pin_event;
+        wippersnapper_signal_v1_ReadValuesRequest read_values;
+        wippersnapper_signal_v1_ReadValuesResponse values;
+        wippersnapper_pin_v1_PinCountEvent pin_count_event;
+        wippersnapper_pin_v1_PinEncoderEvent pin_encoder_event;
+        wippersnapper_pin_v1_ConfigurePulseCaptureRequests pulse_capture_config;
+        wippersnapper_pin_v1_LogicCaptureRequest logic_capture_request;
+        wippersnapper_pin_v1_LogicCapture logic_capture;
     } payload;
 } wippersnapper_signal_v1_CreateSignalRequest;
 
@@ -48,6 +93,7 @@ typedef struct _wippersnapper_signal_v1_I2CResponse {
         wippersnapper_i2c_v1_I2CDeviceUpdateResponse resp_i2c_device_update;
         wippersnapper_i2c_v1_I2CDeviceEvent resp_i2c_device_event;
     } payload;
+    uint32_t latency_us;
 } wippersnapper_signal_v1_I2CResponse;
 
 typedef struct _wippersnapper_signal_v1_SignalResponse {
@@ -58,26 +104,64 @@ typedef struct _wippersnapper_signal_v1_SignalResponse {
 } wippersnapper_signal_v1_SignalResponse;
 
 
+/* Helper constants for enums */
+#define _wippersnapper_signal_v1_ValueQuality_MIN wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_UNSPECIFIED
+#define _wippersnapper_signal_v1_ValueQuality_MAX wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_READ_FAILED
+#define _wippersnapper_signal_v1_ValueQuality_ARRAYSIZE ((wippersnapper_signal_v1_ValueQuality)(wippersnapper_signal_v1_ValueQuality_VALUE_QUALITY_READ_FAILED+1))
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* Initializer values for message structs */
 #define wippersnapper_signal_v1_I2CRequest_init_default {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanRequest_init_default}}
-#define wippersnapper_signal_v1_I2CResponse_init_default {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanResponse_init_default}}
+#define wippersnapper_signal_v1_I2CResponse_init_default {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanResponse_init_default}, 0}
 #define wippersnapper_signal_v1_CreateSignalRequest_init_default {{{NULL}, NULL}, 0, {wippersnapper_pin_v1_ConfigurePinRequests_init_default}}
 #define wippersnapper_signal_v1_SignalResponse_init_default {0, {0}}
+#define wippersnapper_signal_v1_ReadValuesRequest_init_default {0, 0, {0, 0, 0, 0, 0, 0, 0, 0}}
+#define wippersnapper_signal_v1_ChannelValue_init_default {0, 0, 0, 0, _wippersnapper_signal_v1_ValueQuality_MIN}
+#define wippersnapper_signal_v1_ReadValuesResponse_init_default {{{NULL}, NULL}}
+#define wippersnapper_signal_v1_TelemetryBatch_init_default {{{NULL}, NULL}, 0}
+#define wippersnapper_signal_v1_TimeSeries_init_default {"", 0, _wippersnapper_i2c_v1_SensorType_MIN, 0, {{NULL}, NULL}}
 #define wippersnapper_signal_v1_I2CRequest_init_zero {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanRequest_init_zero}}
-#define wippersnapper_signal_v1_I2CResponse_init_zero {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanResponse_init_zero}}
+#define wippersnapper_signal_v1_I2CResponse_init_zero {{{NULL}, NULL}, 0, {wippersnapper_i2c_v1_I2CBusScanResponse_init_zero}, 0}
 #define wippersnapper_signal_v1_CreateSignalRequest_init_zero {{{NULL}, NULL}, 0, {wippersnapper_pin_v1_ConfigurePinRequests_init_zero}}
 #define wippersnapper_signal_v1_SignalResponse_init_zero {0, {0}}
+#define wippersnapper_signal_v1_ReadValuesRequest_init_zero {0, 0, {0, 0, 0, 0, 0, 0, 0, 0}}
+#define wippersnapper_signal_v1_ChannelValue_init_zero {0, 0, 0, 0, _wippersnapper_signal_v1_ValueQuality_MIN}
+#define wippersnapper_signal_v1_ReadValuesResponse_init_zero {{{NULL}, NULL}}
+#define wippersnapper_signal_v1_TelemetryBatch_init_zero {{{NULL}, NULL}, 0}
+#define wippersnapper_signal_v1_TimeSeries_init_zero {"", 0, _wippersnapper_i2c_v1_SensorType_MIN, 0, {{NULL}, NULL}}
 
 /* Field tags (for use in manual encoding/decoding) */
+#define wippersnapper_signal_v1_ReadValuesResponse_values_tag 1
+#define wippersnapper_signal_v1_ChannelValue_channel_tag 1
+#define wippersnapper_signal_v1_ChannelValue_sensor_type_tag 2
+#define wippersnapper_signal_v1_ChannelValue_value_tag 3
+#define wippersnapper_signal_v1_ChannelValue_age_ms_tag 4
+#define wippersnapper_signal_v1_ChannelValue_quality_tag 5
+#define wippersnapper_signal_v1_ReadValuesRequest_max_age_ms_tag 1
+#define wippersnapper_signal_v1_ReadValuesRequest_channels_tag 2
+#define wippersnapper_signal_v1_TelemetryBatch_series_tag 1
+#define wippersnapper_signal_v1_TelemetryBatch_device_time_tag 2
+#define wippersnapper_signal_v1_TimeSeries_pin_name_tag 1
+#define wippersnapper_signal_v1_TimeSeries_i2c_device_address_tag 2
+#define wippersnapper_signal_v1_TimeSeries_sensor_type_tag 3
+#define wippersnapper_signal_v1_TimeSeries_count_tag 4
+#define wippersnapper_signal_v1_TimeSeries_samples_tag 5
 #define wippersnapper_signal_v1_CreateSignalRequest_pin_configs_tag 6
 #define wippersnapper_signal_v1_CreateSignalRequest_pin_events_tag 7
 #define wippersnapper_signal_v1_CreateSignalRequest_pwm_pin_config_tag 10
 #define wippersnapper_signal_v1_CreateSignalRequest_pwm_pin_event_tag 12
 #define wippersnapper_signal_v1_CreateSignalRequest_pin_event_tag 15
+#define wippersnapper_signal_v1_CreateSignalRequest_read_values_tag 16
+#define wippersnapper_signal_v1_CreateSignalRequest_values_tag 17
+#define wippersnapper_signal_v1_CreateSignalRequest_pin_count_event_tag 18
+#define wippersnapper_signal_v1_CreateSignalRequest_pin_encoder_event_tag 19
+#define wippersnapper_signal_v1_CreateSignalRequest_pulse_capture_config_tag 20
+#define wippersnapper_signal_v1_CreateSignalRequest_logic_capture_request_tag 21
+#define wippersnapper_signal_v1_CreateSignalRequest_logic_capture_tag 22
 #define wippersnapper_signal_v1_I2CRequest_req_i2c_scan_tag 2
 #define wippersnapper_signal_v1_I2CRequest_req_i2c_set_freq_tag 3
 #define wippersnapper_signal_v1_I2CRequest_req_i2c_device_init_tag 4
@@ -89,6 +173,7 @@ extern "C" {
 #define wippersnapper_signal_v1_I2CResponse_resp_i2c_device_deinit_tag 4
 #define wippersnapper_signal_v1_I2CResponse_resp_i2c_device_update_tag 5
 #define wippersnapper_signal_v1_I2CResponse_resp_i2c_device_event_tag 6
+#define wippersnapper_signal_v1_I2CResponse_latency_us_tag 7
 #define wippersnapper_signal_v1_SignalResponse_configuration_complete_tag 1
 
 /* Struct field encoding specification for nanopb */
@@ -113,7 +198,8 @@ X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_scan,payload.resp_i2c_scan)
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_device_init,payload.resp_i2c_device_init),   3) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_device_deinit,payload.resp_i2c_device_deinit),   4) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_device_update,payload.resp_i2c_device_update),   5) \
-X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_device_event,payload.resp_i2c_device_event),   6)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,resp_i2c_device_event,payload.resp_i2c_device_event),   6) \
+X(a, STATIC,   SINGULAR, UINT32,   latency_us,        7)
 #define wippersnapper_signal_v1_I2CResponse_CALLBACK NULL
 #define wippersnapper_signal_v1_I2CResponse_DEFAULT NULL
 #define wippersnapper_signal_v1_I2CResponse_payload_resp_i2c_scan_MSGTYPE wippersnapper_i2c_v1_I2CBusScanResponse
@@ -127,7 +213,14 @@ X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_configs,payload.pin_configs),
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_events,payload.pin_events),   7) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pwm_pin_config,payload.pwm_pin_config),  10) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pwm_pin_event,payload.pwm_pin_event),  12) \
-X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_event,payload.pin_event),  15)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_event,payload.pin_event),  15) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,read_values,payload.read_values),  16) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,values,payload.values),  17) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_count_event,payload.pin_count_event),  18) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_encoder_event,payload.pin_encoder_event),  19) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pulse_capture_config,payload.pulse_capture_config),  20) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,logic_capture_request,payload.logic_capture_request),  21) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,logic_capture,payload.logic_capture),  22)
 #define wippersnapper_signal_v1_CreateSignalRequest_CALLBACK NULL
 #define wippersnapper_signal_v1_CreateSignalRequest_DEFAULT NULL
 #define wippersnapper_signal_v1_CreateSignalRequest_payload_pin_configs_MSGTYPE wippersnapper_pin_v1_ConfigurePinRequests
@@ -135,34 +228,93 @@ X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,pin_event,payload.pin_event),  15)
 #define wippersnapper_signal_v1_CreateSignalRequest_payload_pwm_pin_config_MSGTYPE wippersnapper_pin_v1_ConfigurePWMPinRequests
 #define wippersnapper_signal_v1_CreateSignalRequest_payload_pwm_pin_event_MSGTYPE wippersnapper_pin_v1_PWMPinEvents
 #define wippersnapper_signal_v1_CreateSignalRequest_payload_pin_event_MSGTYPE wippersnapper_pin_v1_PinEvent
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_read_values_MSGTYPE wippersnapper_signal_v1_ReadValuesRequest
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_values_MSGTYPE wippersnapper_signal_v1_ReadValuesResponse
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_pin_count_event_MSGTYPE wippersnapper_pin_v1_PinCountEvent
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_pin_encoder_event_MSGTYPE wippersnapper_pin_v1_PinEncoderEvent
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_pulse_capture_config_MSGTYPE wippersnapper_pin_v1_ConfigurePulseCaptureRequests
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_logic_capture_request_MSGTYPE wippersnapper_pin_v1_LogicCaptureRequest
+#define wippersnapper_signal_v1_CreateSignalRequest_payload_logic_capture_MSGTYPE wippersnapper_pin_v1_LogicCapture
 
 #define wippersnapper_signal_v1_SignalResponse_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    BOOL,     (payload,configuration_complete,payload.configuration_complete),   1)
 #define wippersnapper_signal_v1_SignalResponse_CALLBACK NULL
 #define wippersnapper_signal_v1_SignalResponse_DEFAULT NULL
 
+#define wippersnapper_signal_v1_ReadValuesRequest_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   max_age_ms,        1) \
+X(a, STATIC,   REPEATED, UINT32,   channels,          2)
+#define wippersnapper_signal_v1_ReadValuesRequest_CALLBACK NULL
+#define wippersnapper_signal_v1_ReadValuesRequest_DEFAULT NULL
+
+#define wippersnapper_signal_v1_ChannelValue_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   channel,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   sensor_type,       2) \
+X(a, STATIC,   SINGULAR, FLOAT,    value,             3) \
+X(a, STATIC,   SINGULAR, UINT32,   age_ms,            4) \
+X(a, STATIC,   SINGULAR, UENUM,    quality,           5)
+#define wippersnapper_signal_v1_ChannelValue_CALLBACK NULL
+#define wippersnapper_signal_v1_ChannelValue_DEFAULT NULL
+
+#define wippersnapper_signal_v1_ReadValuesResponse_FIELDLIST(X, a) \
+X(a, CALLBACK, REPEATED, MESSAGE,  values,            1)
+#define wippersnapper_signal_v1_ReadValuesResponse_CALLBACK pb_default_field_callback
+#define wippersnapper_signal_v1_ReadValuesResponse_DEFAULT NULL
+#define wippersnapper_signal_v1_ReadValuesResponse_values_MSGTYPE wippersnapper_signal_v1_ChannelValue
+
+#define wippersnapper_signal_v1_TelemetryBatch_FIELDLIST(X, a) \
+X(a, CALLBACK, REPEATED, MESSAGE,  series,            1) \
+X(a, STATIC,   SINGULAR, UINT32,   device_time,       2)
+#define wippersnapper_signal_v1_TelemetryBatch_CALLBACK pb_default_field_callback
+#define wippersnapper_signal_v1_TelemetryBatch_DEFAULT NULL
+#define wippersnapper_signal_v1_TelemetryBatch_series_MSGTYPE wippersnapper_signal_v1_TimeSeries
+
+#define wippersnapper_signal_v1_TimeSeries_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, STRING,   pin_name,          1) \
+X(a, STATIC,   SINGULAR, UINT32,   i2c_device_address,   2) \
+X(a, STATIC,   SINGULAR, UENUM,    sensor_type,       3) \
+X(a, STATIC,   SINGULAR, UINT32,   count,             4) \
+X(a, CALLBACK, SINGULAR, BYTES,    samples,           5)
+#define wippersnapper_signal_v1_TimeSeries_CALLBACK pb_default_field_callback
+#define wippersnapper_signal_v1_TimeSeries_DEFAULT NULL
+
 extern const pb_msgdesc_t wippersnapper_signal_v1_I2CRequest_msg;
 extern const pb_msgdesc_t wippersnapper_signal_v1_I2CResponse_msg;
 extern const pb_msgdesc_t wippersnapper_signal_v1_CreateSignalRequest_msg;
 extern const pb_msgdesc_t wippersnapper_signal_v1_SignalResponse_msg;
+extern const pb_msgdesc_t wippersnapper_signal_v1_ReadValuesRequest_msg;
+extern const pb_msgdesc_t wippersnapper_signal_v1_ChannelValue_msg;
+extern const pb_msgdesc_t wippersnapper_signal_v1_ReadValuesResponse_msg;
+extern const pb_msgdesc_t wippersnapper_signal_v1_TelemetryBatch_msg;
+extern const pb_msgdesc_t wippersnapper_signal_v1_TimeSeries_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define wippersnapper_signal_v1_I2CRequest_fields &wippersnapper_signal_v1_I2CRequest_msg
 #define wippersnapper_signal_v1_I2CResponse_fields &wippersnapper_signal_v1_I2CResponse_msg
 #define wippersnapper_signal_v1_CreateSignalRequest_fields &wippersnapper_signal_v1_CreateSignalRequest_msg
 #define wippersnapper_signal_v1_SignalResponse_fields &wippersnapper_signal_v1_SignalResponse_msg
+#define wippersnapper_signal_v1_ReadValuesRequest_fields &wippersnapper_signal_v1_ReadValuesRequest_msg
+#define wippersnapper_signal_v1_ChannelValue_fields &wippersnapper_signal_v1_ChannelValue_msg
+#define wippersnapper_signal_v1_ReadValuesResponse_fields &wippersnapper_signal_v1_ReadValuesResponse_msg
+#define wippersnapper_signal_v1_TelemetryBatch_fields &wippersnapper_signal_v1_TelemetryBatch_msg
+#define wippersnapper_signal_v1_TimeSeries_fields &wippersnapper_signal_v1_TimeSeries_msg
 
 /* Maximum encoded size of messages (where known) */
 #if defined(wippersnapper_i2c_v1_I2CDeviceInitRequests_size)
-union wippersnapper_signal_v1_I2CRequest_payload_size_union {char f7[(6 + wippersnapper_i2c_v1_I2CDeviceInitRequests_size)]; char f0[227];};
+union wippersnapper_signal_v1_I2CRequest_payload_size_union {char f7[(6 + wippersnapper_i2c_v1_I2CDeviceInitRequests_size)]; char f0[467];};
 #define wippersnapper_signal_v1_I2CRequest_size  (0 + sizeof(union wippersnapper_signal_v1_I2CRequest_payload_size_union))
 #endif
-#define wippersnapper_signal_v1_I2CResponse_size 725
-#if defined(wippersnapper_pin_v1_ConfigurePinRequests_size) && defined(wippersnapper_pin_v1_PinEvents_size) && defined(wippersnapper_pin_v1_ConfigurePWMPinRequests_size) && defined(wippersnapper_pin_v1_PWMPinEvents_size)
-union wippersnapper_signal_v1_CreateSignalRequest_payload_size_union {char f6[(6 + wippersnapper_pin_v1_ConfigurePinRequests_size)]; char f7[(6 + wippersnapper_pin_v1_PinEvents_size)]; char f10[(6 + wippersnapper_pin_v1_ConfigurePWMPinRequests_size)]; char f12[(6 + wippersnapper_pin_v1_PWMPinEvents_size)]; char f0[21];};
+#define wippersnapper_signal_v1_I2CResponse_size 731
+#if defined(wippersnapper_pin_v1_ConfigurePinRequests_size) && defined(wippersnapper_pin_v1_PinEvents_size) && defined(wippersnapper_pin_v1_ConfigurePWMPinRequests_size) && defined(wippersnapper_pin_v1_PWMPinEvents_size) && defined(wippersnapper_signal_v1_ReadValuesResponse_size) && defined(wippersnapper_pin_v1_ConfigurePulseCaptureRequests_size) && defined(wippersnapper_pin_v1_LogicCapture_size)
+union wippersnapper_signal_v1_CreateSignalRequest_payload_size_union {char f6[(6 + wippersnapper_pin_v1_ConfigurePinRequests_size)]; char f7[(6 + wippersnapper_pin_v1_PinEvents_size)]; char f10[(6 + wippersnapper_pin_v1_ConfigurePWMPinRequests_size)]; char f12[(6 + wippersnapper_pin_v1_PWMPinEvents_size)]; char f17[(7 + wippersnapper_signal_v1_ReadValuesResponse_size)]; char f20[(7 + wippersnapper_pin_v1_ConfigurePulseCaptureRequests_size)]; char f22[(7 + wippersnapper_pin_v1_LogicCapture_size)]; char f0[85];};
 #define wippersnapper_signal_v1_CreateSignalRequest_size (0 + sizeof(union wippersnapper_signal_v1_CreateSignalRequest_payload_size_union))
 #endif
 #define wippersnapper_signal_v1_SignalResponse_size 2
+#define wippersnapper_signal_v1_ReadValuesRequest_size 54
+#define wippersnapper_signal_v1_ChannelValue_size 25
+/* wippersnapper_signal_v1_ReadValuesResponse_size depends on runtime parameters */
+/* wippersnapper_signal_v1_TelemetryBatch_size depends on runtime parameters */
+/* wippersnapper_signal_v1_TimeSeries_size depends on runtime parameters */
 
 #ifdef __cplusplus
 } /* extern "C" */